@@ -0,0 +1,11 @@
+#ifndef ALIGNED_TYPE_H
+#define ALIGNED_TYPE_H
+
+// alignedTypeCount.cpp is built with -gstrict-dwarf, its Aligned has no DW_AT_alignment, the layout is the same
+struct alignas(16) Aligned {
+  int value;
+  char flag;
+};
+
+int countOf(Aligned const &aligned);
+#endif
@@ -0,0 +1,5 @@
+#include "alignedType.h"
+
+int countOf(Aligned const &aligned) {
+  return aligned.value + aligned.flag;
+}
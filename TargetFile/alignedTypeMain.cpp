@@ -0,0 +1,6 @@
+#include "alignedType.h"
+
+int main() {
+  Aligned aligned{1, 2};
+  return countOf(aligned);
+}
@@ -0,0 +1,21 @@
+// C linkage, so that the inlined functions have no DW_AT_linkage_name
+extern "C" {
+static volatile int sink;
+
+static inline __attribute__((always_inline)) void leaf(int v) {
+  sink = v;
+}
+
+static inline __attribute__((always_inline)) void mid(int v) {
+  leaf(v + 1);
+}
+
+__attribute__((noinline)) void top(int v) {
+  mid(v * 2);
+}
+}
+
+int main() {
+  top(3);
+  return 0;
+}
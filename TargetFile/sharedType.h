@@ -0,0 +1,13 @@
+#ifndef SHARED_TYPE_H
+#define SHARED_TYPE_H
+
+// Only sharedTypeMain.cpp defines Pointee, the other unit sees the forward declaration
+struct Pointee;
+
+struct Holder {
+  Pointee *pointee;
+  int count;
+};
+
+int countOf(Holder const &holder);
+#endif
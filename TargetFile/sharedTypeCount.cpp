@@ -0,0 +1,5 @@
+#include "sharedType.h"
+
+int countOf(Holder const &holder) {
+  return (holder.pointee != nullptr) ? holder.count : 0;
+}
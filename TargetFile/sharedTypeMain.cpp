@@ -0,0 +1,11 @@
+#include "sharedType.h"
+
+struct Pointee {
+  long value;
+};
+
+int main() {
+  Pointee pointee{1};
+  Holder holder{&pointee, 2};
+  return countOf(holder) + static_cast<int>(pointee.value);
+}
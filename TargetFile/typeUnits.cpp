@@ -0,0 +1,20 @@
+struct Shape {
+  int w;
+  int h;
+  int area() const {
+    return w * h;
+  }
+};
+
+namespace geo {
+struct Point {
+  double x;
+  double y;
+};
+} // namespace geo
+
+int main() {
+  Shape s{2, 3};
+  geo::Point p{1.0, 2.0};
+  return s.area() + static_cast<int>(p.x);
+}
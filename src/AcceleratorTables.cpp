@@ -0,0 +1,450 @@
+#include "AcceleratorTables.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include "ByteReader.hpp"
+#include "DIEIndex.hpp"
+#include "DebugAbbrev.hpp"
+#include "QualifiedNames.hpp"
+
+namespace {
+// index attributes of .debug_names abbreviations
+enum class IndexAttribute : uint16_t {
+  DW_IDX_compile_unit = 1,
+  DW_IDX_type_unit = 2,
+  DW_IDX_die_offset = 3,
+  DW_IDX_parent = 4,
+  DW_IDX_type_hash = 5,
+};
+
+struct IndexAbbrev {
+  uint64_t code;
+  uint64_t tag;
+  std::vector<std::pair<IndexAttribute, DebugAbbrev::Form>> attributes;
+};
+
+template <typename T>
+T readAt(uint8_t const *const base, size_t const index) noexcept {
+  T value;
+  memcpy(&value, base + (index * sizeof(T)), sizeof(T));
+  return value;
+}
+
+uint64_t readIndexValue(ByteReader &reader, DebugAbbrev::Form const form) {
+  switch (form) {
+  case (DebugAbbrev::Form::DW_FORM_data1):
+  case (DebugAbbrev::Form::DW_FORM_ref1): {
+    return reader.getNumber<uint8_t>();
+  }
+  case (DebugAbbrev::Form::DW_FORM_data2):
+  case (DebugAbbrev::Form::DW_FORM_ref2): {
+    return reader.getNumber<uint16_t>();
+  }
+  case (DebugAbbrev::Form::DW_FORM_data4):
+  case (DebugAbbrev::Form::DW_FORM_ref4):
+  case (DebugAbbrev::Form::DW_FORM_sec_offset): {
+    return reader.getNumber<uint32_t>();
+  }
+  case (DebugAbbrev::Form::DW_FORM_data8):
+  case (DebugAbbrev::Form::DW_FORM_ref8): {
+    return reader.getNumber<uint64_t>();
+  }
+  case (DebugAbbrev::Form::DW_FORM_udata):
+  case (DebugAbbrev::Form::DW_FORM_ref_udata): {
+    return reader.readLEB128(false);
+  }
+  case (DebugAbbrev::Form::DW_FORM_flag_present): {
+    return 1U;
+  }
+  default: {
+    throw std::runtime_error("unsupported form in .debug_names");
+  }
+  }
+}
+
+// Last component of a qualified name, "ns::C<a::b>::f" -> "f"; .debug_names only hashes the plain DW_AT_name
+std::string_view baseName(std::string_view const name) noexcept {
+  size_t start = 0U;
+  int32_t depth = 0;
+  for (size_t i = 0U; i < name.size(); i++) {
+    char const c = name[i];
+    if ((c == '<') || (c == '(')) {
+      depth++;
+    } else if ((c == '>') || (c == ')')) {
+      depth--;
+    } else if ((c == ':') && (depth == 0) && (i + 1U < name.size()) && (name[i + 1U] == ':')) {
+      start = i + 2U;
+      i++;
+    }
+  }
+  return name.substr(start);
+}
+
+// tags of the entities the tables name; call sites and inlined instances reach a name through their origin
+bool isNamedEntity(DebugAbbrev::Tag const tag) noexcept {
+  switch (tag) {
+  case (DebugAbbrev::Tag::DW_TAG_subprogram):
+  case (DebugAbbrev::Tag::DW_TAG_variable):
+  case (DebugAbbrev::Tag::DW_TAG_constant):
+  case (DebugAbbrev::Tag::DW_TAG_enumerator):
+  case (DebugAbbrev::Tag::DW_TAG_namespace):
+  case (DebugAbbrev::Tag::DW_TAG_base_type):
+  case (DebugAbbrev::Tag::DW_TAG_structure_type):
+  case (DebugAbbrev::Tag::DW_TAG_class_type):
+  case (DebugAbbrev::Tag::DW_TAG_union_type):
+  case (DebugAbbrev::Tag::DW_TAG_enumeration_type):
+  case (DebugAbbrev::Tag::DW_TAG_typedef): {
+    return true;
+  }
+  default: {
+    return false;
+  }
+  }
+}
+} // namespace
+
+void AcceleratorTables::setDebugNames(std::span<uint8_t const> const section, char const *const debugStr) noexcept {
+  if (debugStr != nullptr) {
+    debugNames_ = section;
+    debugStr_ = debugStr;
+  }
+}
+
+void AcceleratorTables::setGdbIndex(std::span<uint8_t const> const section) noexcept {
+  // versions before 5 used a different hash function, gdb itself ignores them
+  if (section.size() >= (7U * sizeof(uint32_t))) {
+    uint32_t const version = readAt<uint32_t>(section.data(), 0U);
+    if ((version >= 5U) && (version <= 9U)) {
+      gdbIndex_ = section;
+    }
+  }
+}
+
+void AcceleratorTables::setPubnames(std::span<uint8_t const> const section) noexcept {
+  pubnames_ = section;
+}
+
+void AcceleratorTables::setPubtypes(std::span<uint8_t const> const section) noexcept {
+  pubtypes_ = section;
+}
+
+char const *AcceleratorTables::source() const noexcept {
+  if (!debugNames_.empty()) {
+    return ".debug_names";
+  }
+  if (!gdbIndex_.empty()) {
+    return ".gdb_index";
+  }
+  if (!pubnames_.empty() || !pubtypes_.empty()) {
+    return ".debug_pubnames";
+  }
+  return nullptr;
+}
+
+uint32_t AcceleratorTables::debugNamesHash(std::string_view const name) noexcept {
+  // DJB over the case folded name
+  uint32_t hashValue = 5381U;
+  for (char const c : name) {
+    hashValue = (hashValue * 33U) + static_cast<uint8_t>(tolower(static_cast<uint8_t>(c)));
+  }
+  return hashValue;
+}
+
+uint32_t AcceleratorTables::gdbIndexHash(std::string_view const name) noexcept {
+  uint32_t hashValue = 0U;
+  for (char const c : name) {
+    hashValue = (hashValue * 67U) + static_cast<uint8_t>(tolower(static_cast<uint8_t>(c))) - 113U;
+  }
+  return hashValue;
+}
+
+std::vector<AcceleratorTables::Match> AcceleratorTables::lookup(std::string_view const name) const {
+  std::vector<Match> matches;
+  if (!debugNames_.empty()) {
+    lookupDebugNames(name, matches);
+  } else if (!gdbIndex_.empty()) {
+    lookupGdbIndex(name, matches);
+  } else {
+    lookupPubnames(pubnames_, name, matches);
+    lookupPubnames(pubtypes_, name, matches);
+  }
+  std::sort(matches.begin(), matches.end(), [](Match const &lhs, Match const &rhs) {
+    return (lhs.unitOffset != rhs.unitOffset) ? (lhs.unitOffset < rhs.unitOffset) : (lhs.dieOffset < rhs.dieOffset);
+  });
+  matches.erase(std::unique(matches.begin(), matches.end(),
+                            [](Match const &lhs, Match const &rhs) {
+                              return (lhs.unitOffset == rhs.unitOffset) && (lhs.dieOffset == rhs.dieOffset);
+                            }),
+                matches.end());
+  return matches;
+}
+
+void AcceleratorTables::lookupDebugNames(std::string_view const name, std::vector<Match> &matches) const {
+  std::string_view const plainName = baseName(name);
+  uint32_t const hashValue = debugNamesHash(plainName);
+
+  // the section is a sequence of name indexes, usually one per linked object
+  size_t indexOffset = 0U;
+  while (indexOffset < debugNames_.size()) {
+    ByteReader reader(debugNames_.data() + indexOffset, debugNames_.size() - indexOffset);
+    uint32_t const unitLength = reader.getNumber<uint32_t>();
+    if (unitLength >= 0xFFFF'FFF0U) {
+      throw std::runtime_error("64-bit DWARF is not supported");
+    }
+    if (unitLength > static_cast<size_t>(reader.end_ - reader.cursor_)) {
+      throw std::runtime_error("wrong .debug_names unit_length");
+    }
+    uint8_t const *const indexEnd = reader.cursor_ + unitLength;
+    indexOffset += sizeof(uint32_t) + unitLength;
+
+    uint16_t const version = reader.getNumber<uint16_t>();
+    if (version != 5U) {
+      throw std::runtime_error("unsupported .debug_names version");
+    }
+    static_cast<void>(reader.getNumber<uint16_t>()); // padding
+    uint32_t const compUnitCount = reader.getNumber<uint32_t>();
+    uint32_t const localTypeUnitCount = reader.getNumber<uint32_t>();
+    uint32_t const foreignTypeUnitCount = reader.getNumber<uint32_t>();
+    uint32_t const bucketCount = reader.getNumber<uint32_t>();
+    uint32_t const nameCount = reader.getNumber<uint32_t>();
+    uint32_t const abbrevTableSize = reader.getNumber<uint32_t>();
+    uint32_t const augmentationStringSize = reader.getNumber<uint32_t>();
+    reader.step((static_cast<size_t>(augmentationStringSize) + 3U) & ~static_cast<size_t>(3U));
+
+    uint8_t const *const compUnits = reader.cursor_;
+    reader.step((static_cast<size_t>(compUnitCount) + localTypeUnitCount) * sizeof(uint32_t) + static_cast<size_t>(foreignTypeUnitCount) * sizeof(uint64_t));
+    uint8_t const *const buckets = reader.cursor_;
+    reader.step(static_cast<size_t>(bucketCount) * sizeof(uint32_t));
+    uint8_t const *const hashes = reader.cursor_;
+    reader.step((bucketCount != 0U) ? (static_cast<size_t>(nameCount) * sizeof(uint32_t)) : 0U);
+    uint8_t const *const stringOffsets = reader.cursor_;
+    reader.step(static_cast<size_t>(nameCount) * sizeof(uint32_t));
+    uint8_t const *const entryOffsets = reader.cursor_;
+    reader.step(static_cast<size_t>(nameCount) * sizeof(uint32_t));
+    uint8_t const *const abbrevTable = reader.cursor_;
+    reader.step(abbrevTableSize);
+    uint8_t const *const entryPool = reader.cursor_;
+    if (entryPool > indexEnd) {
+      throw std::runtime_error("wrong .debug_names header");
+    }
+
+    // candidate names: one bucket, or every name if the producer left out the hash table
+    std::vector<uint32_t> nameIndices;
+    if (bucketCount != 0U) {
+      uint32_t const bucket = hashValue % bucketCount;
+      uint32_t const first = readAt<uint32_t>(buckets, bucket);
+      for (uint32_t i = (first == 0U) ? nameCount : (first - 1U); i < nameCount; i++) {
+        uint32_t const nameHash = readAt<uint32_t>(hashes, i);
+        if ((nameHash % bucketCount) != bucket) {
+          break;
+        }
+        if (nameHash == hashValue) {
+          nameIndices.push_back(i);
+        }
+      }
+    } else {
+      for (uint32_t i = 0U; i < nameCount; i++) {
+        nameIndices.push_back(i);
+      }
+    }
+
+    std::vector<IndexAbbrev> abbrevs;
+    bool abbrevsParsed = false;
+    for (uint32_t const nameIndex : nameIndices) {
+      if (std::string_view(debugStr_ + readAt<uint32_t>(stringOffsets, nameIndex)) != plainName) {
+        continue;
+      }
+
+      if (!abbrevsParsed) {
+        ByteReader abbrevReader(abbrevTable, abbrevTableSize);
+        for (uint64_t code = abbrevReader.readLEB128(false); code != 0U; code = abbrevReader.readLEB128(false)) {
+          IndexAbbrev abbrev{code, abbrevReader.readLEB128(false), {}};
+          for (uint64_t attribute = abbrevReader.readLEB128(false); attribute != 0U; attribute = abbrevReader.readLEB128(false)) {
+            abbrev.attributes.emplace_back(static_cast<IndexAttribute>(attribute), static_cast<DebugAbbrev::Form>(abbrevReader.readLEB128(false)));
+          }
+          static_cast<void>(abbrevReader.readLEB128(false)); // form 0 which ends the attributes
+          abbrevs.push_back(std::move(abbrev));
+        }
+        abbrevsParsed = true;
+      }
+
+      uint32_t const entryOffset = readAt<uint32_t>(entryOffsets, nameIndex);
+      ByteReader entryReader(entryPool, static_cast<size_t>(indexEnd - entryPool));
+      entryReader.step(entryOffset);
+      for (uint64_t code = entryReader.readLEB128(false); code != 0U; code = entryReader.readLEB128(false)) {
+        std::vector<IndexAbbrev>::const_iterator const abbrev = std::find_if(abbrevs.begin(), abbrevs.end(), [code](IndexAbbrev const &candidate) {
+          return candidate.code == code;
+        });
+        if (abbrev == abbrevs.end()) {
+          throw std::runtime_error("unknown .debug_names abbreviation");
+        }
+        // a single compile unit may be implied
+        std::optional<uint64_t> unitIndex = (compUnitCount == 1U) ? std::optional<uint64_t>(0U) : std::nullopt;
+        std::optional<uint64_t> dieOffset;
+        std::optional<uint64_t> typeUnitIndex;
+        for (std::pair<IndexAttribute, DebugAbbrev::Form> const &attribute : abbrev->attributes) {
+          uint64_t const value = readIndexValue(entryReader, attribute.second);
+          switch (attribute.first) {
+          case (IndexAttribute::DW_IDX_compile_unit): {
+            unitIndex = value;
+            break;
+          }
+          case (IndexAttribute::DW_IDX_type_unit): {
+            typeUnitIndex = value;
+            break;
+          }
+          case (IndexAttribute::DW_IDX_die_offset): {
+            dieOffset = value;
+            break;
+          }
+          default: {
+            break;
+          }
+          }
+        }
+        // the local type units follow the compile units in the unit list, foreign ones live in a .dwo file
+        std::optional<size_t> listIndex;
+        if (typeUnitIndex.has_value()) {
+          if (*typeUnitIndex < localTypeUnitCount) {
+            listIndex = static_cast<size_t>(compUnitCount + *typeUnitIndex);
+          }
+        } else if (unitIndex.has_value() && (*unitIndex < compUnitCount)) {
+          listIndex = static_cast<size_t>(*unitIndex);
+        }
+        if (listIndex.has_value() && dieOffset.has_value()) {
+          uint32_t const unitOffset = readAt<uint32_t>(compUnits, *listIndex);
+          matches.push_back(Match{unitOffset, unitOffset + static_cast<uint32_t>(*dieOffset)});
+        }
+      }
+    }
+  }
+}
+
+void AcceleratorTables::lookupGdbIndex(std::string_view const name, std::vector<Match> &matches) const {
+  uint8_t const *const index = gdbIndex_.data();
+  uint32_t const version = readAt<uint32_t>(index, 0U);
+  uint32_t const compUnitListOffset = readAt<uint32_t>(index, 1U);
+  uint32_t const typeUnitListOffset = readAt<uint32_t>(index, 2U);
+  uint32_t const symbolTableOffset = readAt<uint32_t>(index, 4U);
+  // version 9 put the shortcut table between the symbol table and the constant pool
+  uint32_t const symbolTableEnd = readAt<uint32_t>(index, 5U);
+  uint32_t const constantPoolOffset = readAt<uint32_t>(index, (version >= 9U) ? 6U : 5U);
+  if ((compUnitListOffset > typeUnitListOffset) || (symbolTableOffset > symbolTableEnd) || (constantPoolOffset > gdbIndex_.size()) ||
+      (symbolTableEnd > gdbIndex_.size())) {
+    throw std::runtime_error("wrong .gdb_index header");
+  }
+
+  size_t const compUnitCount = (typeUnitListOffset - compUnitListOffset) / (2U * sizeof(uint64_t));
+  size_t const slotCount = (symbolTableEnd - symbolTableOffset) / (2U * sizeof(uint32_t));
+  if (slotCount == 0U) {
+    return;
+  }
+  uint8_t const *const slots = index + symbolTableOffset;
+  uint8_t const *const constantPool = index + constantPoolOffset;
+  size_t const constantPoolSize = gdbIndex_.size() - constantPoolOffset;
+
+  // open addressing with a second hash as the probe step, an empty slot is all zero
+  uint32_t const hashValue = gdbIndexHash(name);
+  size_t const mask = slotCount - 1U;
+  size_t const step = ((hashValue * 17U) & mask) | 1U;
+  size_t slot = hashValue & mask;
+  for (size_t probe = 0U; probe < slotCount; probe++) {
+    uint32_t const nameOffset = readAt<uint32_t>(slots, slot * 2U);
+    uint32_t const vectorOffset = readAt<uint32_t>(slots, (slot * 2U) + 1U);
+    if ((nameOffset == 0U) && (vectorOffset == 0U)) {
+      return;
+    }
+    if ((nameOffset >= constantPoolSize) || (vectorOffset >= constantPoolSize)) {
+      throw std::runtime_error("wrong .gdb_index symbol");
+    }
+    char const *const slotName = reinterpret_cast<char const *>(constantPool + nameOffset);
+    if (std::string_view(slotName, strnlen(slotName, constantPoolSize - nameOffset)) == name) {
+      ByteReader vectorReader(constantPool + vectorOffset, constantPoolSize - vectorOffset);
+      uint32_t const count = vectorReader.getNumber<uint32_t>();
+      for (uint32_t i = 0U; i < count; i++) {
+        uint32_t const value = vectorReader.getNumber<uint32_t>();
+        // since version 7 the upper byte holds symbol kind and static flag
+        uint32_t const unitIndex = (version >= 7U) ? (value & 0x00FF'FFFFU) : value;
+        if (unitIndex < compUnitCount) {
+          uint64_t const unitOffset = readAt<uint64_t>(index + compUnitListOffset, static_cast<size_t>(unitIndex) * 2U);
+          matches.push_back(Match{static_cast<uint32_t>(unitOffset), 0U});
+        }
+      }
+      return;
+    }
+    slot = (slot + step) & mask;
+  }
+}
+
+void AcceleratorTables::lookupPubnames(std::span<uint8_t const> const section, std::string_view const name, std::vector<Match> &matches) {
+  size_t setOffset = 0U;
+  while (setOffset < section.size()) {
+    uint32_t const unitLength = ByteReader(section.data() + setOffset, section.size() - setOffset).getNumber<uint32_t>();
+    if (unitLength >= 0xFFFF'FFF0U) {
+      throw std::runtime_error("64-bit DWARF is not supported");
+    }
+    if (unitLength > section.size() - setOffset - sizeof(uint32_t)) {
+      throw std::runtime_error("wrong .debug_pubnames unit_length");
+    }
+    ByteReader reader(section.data() + setOffset + sizeof(uint32_t), unitLength);
+    setOffset += sizeof(uint32_t) + unitLength;
+
+    static_cast<void>(reader.getNumber<uint16_t>()); // version
+    uint32_t const unitOffset = reader.getNumber<uint32_t>();
+    static_cast<void>(reader.getNumber<uint32_t>()); // unit length in .debug_info
+    for (uint32_t dieOffset = reader.getNumber<uint32_t>(); dieOffset != 0U; dieOffset = reader.getNumber<uint32_t>()) {
+      char const *const entryName = reinterpret_cast<char const *>(reader.cursor_);
+      size_t const length = strnlen(entryName, static_cast<size_t>(reader.end_ - reader.cursor_));
+      reader.step(length + 1U);
+      if (std::string_view(entryName, length) == name) {
+        matches.push_back(Match{unitOffset, unitOffset + dieOffset});
+      }
+    }
+  }
+}
+
+std::vector<uint32_t> AcceleratorTables::definitions(DIEIndex const &dieIndex, std::span<Match const> const matches, std::string_view const name) {
+  std::string_view const plainName = baseName(name);
+  std::vector<uint32_t> result;
+  auto const consider = [&](uint32_t const index) {
+    DIEIndex::DIEInfo const &die = dieIndex.at(index);
+    if (!isNamedEntity(die.tag)) {
+      return;
+    }
+    // out-of-line definitions are named by their declaration
+    std::string_view const dieName = dieIndex.name((die.name == StringPool::noString) ? QualifiedNames::declaration(dieIndex, index) : index);
+    if (dieName != plainName) {
+      return;
+    }
+    std::optional<FormValue> const declaration = dieIndex.attribute(index, DebugAbbrev::AttributeName::DW_AT_declaration);
+    if (declaration.has_value() && (declaration->value != 0U)) {
+      return;
+    }
+    if ((dieName == name) || (dieIndex.qualifiedName(index) == name)) {
+      result.push_back(index);
+    }
+  };
+
+  for (Match const &match : matches) {
+    if (match.dieOffset != 0U) {
+      uint32_t const index = dieIndex.findIndex(match.dieOffset);
+      if (index != DIEIndex::invalidIndex) {
+        consider(index);
+      }
+      continue;
+    }
+    uint32_t const unitIndex = dieIndex.findUnit(match.unitOffset);
+    if (unitIndex == DIEIndex::invalidIndex) {
+      continue;
+    }
+    DIEIndex::UnitInfo const &unit = dieIndex.units()[unitIndex];
+    for (uint32_t i = unit.firstDIE; i < unit.endDIE; i++) {
+      consider(i);
+    }
+  }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
@@ -0,0 +1,59 @@
+#ifndef ACCELERATOR_TABLES_HPP
+#define ACCELERATOR_TABLES_HPP
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+class DIEIndex;
+
+// Name lookup through the accelerator tables a producer or linker left in the binary, so that only the units which
+// define a name have to be parsed. The tables are used in the order .debug_names, .gdb_index, .debug_pubnames and
+// .debug_pubtypes; the first one present answers the lookup alone.
+//  - .debug_names hashes plain names and points at the DIE.
+//  - .gdb_index hashes qualified names and only points at the unit, which then has to be searched.
+//  - .debug_pubnames/.debug_pubtypes have no hash table, the qualified names are compared one by one.
+// The section contents must outlive the object.
+class AcceleratorTables {
+public:
+  struct Match {
+    uint32_t unitOffset; // section offset of the unit header in .debug_info
+    uint32_t dieOffset;  // section offset of the DIE, 0 if the table only knows the unit
+  };
+
+  void setDebugNames(std::span<uint8_t const> const section, char const *const debugStr) noexcept;
+  void setGdbIndex(std::span<uint8_t const> const section) noexcept;
+  void setPubnames(std::span<uint8_t const> const section) noexcept;
+  void setPubtypes(std::span<uint8_t const> const section) noexcept;
+
+  inline bool empty() const noexcept {
+    return debugNames_.empty() && gdbIndex_.empty() && pubnames_.empty() && pubtypes_.empty();
+  }
+
+  // Name of the section lookup() uses, nullptr if there is none
+  char const *source() const noexcept;
+
+  // Candidates sorted by unit, .debug_names may return DIEs which only share the last name component
+  std::vector<Match> lookup(std::string_view const name) const;
+
+  // Indices of the defining DIEs of name among the candidates, dieIndex must contain the units of the candidates
+  static std::vector<uint32_t> definitions(DIEIndex const &dieIndex, std::span<Match const> const matches, std::string_view const name);
+
+  // Hash functions of the tables
+  static uint32_t debugNamesHash(std::string_view const name) noexcept;
+  static uint32_t gdbIndexHash(std::string_view const name) noexcept;
+
+private:
+  void lookupDebugNames(std::string_view const name, std::vector<Match> &matches) const;
+  void lookupGdbIndex(std::string_view const name, std::vector<Match> &matches) const;
+  static void lookupPubnames(std::span<uint8_t const> const section, std::string_view const name, std::vector<Match> &matches);
+
+  std::span<uint8_t const> debugNames_;
+  char const *debugStr_ = nullptr;
+  std::span<uint8_t const> gdbIndex_;
+  std::span<uint8_t const> pubnames_;
+  std::span<uint8_t const> pubtypes_;
+};
+
+#endif
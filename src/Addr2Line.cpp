@@ -0,0 +1,173 @@
+#include "Addr2Line.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <stdexcept>
+#include <unistd.h>
+
+Addr2Line::Addr2Line(Symbolizer &symbolizer, SymbolTable const &symbols, Options const &options, unsigned const addressDigits, BufferedWriter &out)
+    : symbolizer_(symbolizer), symbols_(symbols), options_(options), addressDigits_(addressDigits), out_(out) {
+}
+
+uint64_t Addr2Line::parseAddress(std::string_view const line) noexcept {
+  size_t position = 0U;
+  while ((position < line.size()) && ((line[position] == ' ') || (line[position] == '\t'))) {
+    position++;
+  }
+  if (((position + 1U) < line.size()) && (line[position] == '0') && ((line[position + 1U] == 'x') || (line[position + 1U] == 'X'))) {
+    position += 2U;
+  }
+  uint64_t address = 0U;
+  for (; position < line.size(); position++) {
+    char const c = line[position];
+    uint64_t digit = 0U;
+    if ((c >= '0') && (c <= '9')) {
+      digit = static_cast<uint64_t>(c - '0');
+    } else if ((c >= 'a') && (c <= 'f')) {
+      digit = static_cast<uint64_t>(c - 'a') + 10U;
+    } else if ((c >= 'A') && (c <= 'F')) {
+      digit = static_cast<uint64_t>(c - 'A') + 10U;
+    } else {
+      break;
+    }
+    address = (address << 4U) | digit;
+  }
+  return address;
+}
+
+std::string_view Addr2Line::demangle(std::string_view const name) {
+  if (!options_.demangle || name.empty()) {
+    return name;
+  }
+  std::unordered_map<std::string_view, std::string>::iterator cached = demangled_.find(name);
+  if (cached == demangled_.end()) {
+    std::string const mangled(name);
+    int status = 0;
+    char *const demangled = abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status);
+    cached = demangled_.emplace(name, (status == 0) ? std::string(demangled) : mangled).first;
+    free(demangled);
+  }
+  return cached->second;
+}
+
+std::string_view Addr2Line::functionName(Symbolizer::Frame const &frame, bool const outermost) {
+  // addr2line prints the linkage name. Without one, an ELF symbol starting where the function starts takes its place,
+  // and only then the unqualified DW_AT_name is used. An inlined instance may start at the entry of the function it was
+  // inlined into, the symbol there names that function, not the inlined one.
+  if (!frame.linkageName.empty()) {
+    return demangle(frame.linkageName);
+  }
+  if (outermost && (frame.lowPc != 0U)) {
+    SymbolTable::Symbol const *const symbol = symbols_.find(frame.lowPc);
+    if ((symbol != nullptr) && (symbol->address == frame.lowPc)) {
+      return demangle(symbol->name);
+    }
+  }
+  return frame.name;
+}
+
+void Addr2Line::printLocation(std::string_view const function, std::string_view file, uint32_t const line, uint32_t const discriminator) {
+  if (options_.functions) {
+    out_.append(function.empty() ? std::string_view("??") : function);
+    out_.append(options_.pretty ? std::string_view(" at ") : std::string_view("\n"));
+  }
+  if (options_.basenames) {
+    size_t const slash = file.rfind('/');
+    if (slash != std::string_view::npos) {
+      file.remove_prefix(slash + 1U);
+    }
+  }
+  out_.append(file.empty() ? std::string_view("??") : file);
+  out_.append(':');
+  if (line == 0U) {
+    out_.append('?');
+  } else {
+    out_.appendDecimal(line);
+    if (discriminator != 0U) {
+      out_.append(" (discriminator ");
+      out_.appendDecimal(discriminator);
+      out_.append(')');
+    }
+  }
+  out_.append('\n');
+}
+
+void Addr2Line::resolve(std::span<uint64_t const> const addresses) {
+  symbolizer_.symbolize(addresses, batch_);
+  for (size_t i = 0U; i < addresses.size(); i++) {
+    if (options_.addresses) {
+      out_.append("0x");
+      out_.appendHex(addresses[i], addressDigits_);
+      out_.append(options_.pretty ? std::string_view(": ") : std::string_view("\n"));
+    }
+    Symbolizer::Location const &location = batch_.location(i);
+    std::span<Symbolizer::Frame const> const frames = batch_.framesOf(i);
+    SymbolTable::Symbol const *const symbol = symbols_.find(addresses[i]);
+    std::string_view function = frames.empty() ? ((symbol != nullptr) ? demangle(symbol->name) : std::string_view()) : functionName(frames[0], frames.size() == 1U);
+
+    if (frames.empty()) {
+      if ((location.unitOffset == UnitRanges::noUnit) && (symbol == nullptr)) {
+        if (options_.functions) {
+          out_.append(options_.pretty ? std::string_view("?? ") : std::string_view("??\n"));
+        }
+        out_.append("??:0\n");
+      } else if (location.unitOffset == UnitRanges::noUnit) {
+        printLocation(function, symbol->file, 0U, 0U);
+      } else {
+        printLocation(function, location.file, location.line, location.discriminator);
+      }
+      continue;
+    }
+    // like addr2line, the discriminator of the address is repeated on the call site lines
+    for (size_t j = 0U; j < frames.size(); j++) {
+      if (j > 0U) {
+        if (!options_.inlines) {
+          break;
+        }
+        if (options_.pretty) {
+          out_.append(" (inlined by) ");
+        }
+        function = functionName(frames[j], (j + 1U) == frames.size());
+      }
+      printLocation(function, frames[j].file, frames[j].line, frames[0].discriminator);
+    }
+  }
+}
+
+void Addr2Line::run(int const fd) {
+  std::vector<char> block(static_cast<size_t>(1U) << 20U);
+  std::vector<uint64_t> addresses;
+  size_t filled = 0U;
+  bool atEnd = false;
+  while (!atEnd) {
+    ssize_t const result = read(fd, block.data() + filled, block.size() - filled);
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::runtime_error(std::string("read failed: ") + strerror(errno));
+    }
+    atEnd = (result == 0);
+    filled += static_cast<size_t>(result);
+
+    // complete lines only, a partial last line waits for the next read unless the input ended or it fills the block
+    std::string_view const text(block.data(), filled);
+    size_t end = text.rfind('\n');
+    end = (end == std::string_view::npos) ? 0U : (end + 1U);
+    if ((atEnd || (filled == block.size())) && (end < filled)) {
+      end = filled;
+    }
+    addresses.clear();
+    for (size_t lineStart = 0U; lineStart < end;) {
+      size_t lineEnd = text.find('\n', lineStart);
+      lineEnd = ((lineEnd == std::string_view::npos) || (lineEnd > end)) ? end : lineEnd;
+      addresses.push_back(parseAddress(text.substr(lineStart, lineEnd - lineStart)));
+      lineStart = lineEnd + 1U;
+    }
+    resolve(addresses);
+    out_.flush();
+    memmove(block.data(), block.data() + end, filled - end);
+    filled -= end;
+  }
+}
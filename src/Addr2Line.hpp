@@ -0,0 +1,56 @@
+#ifndef ADDR2LINE_HPP
+#define ADDR2LINE_HPP
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "BufferedWriter.hpp"
+#include "SymbolTable.hpp"
+#include "Symbolizer.hpp"
+
+// Front end with the output format of binutils addr2line, so that scripts written for `addr2line -e bin -f -i -C` can
+// use this instead. Addresses are read one per line. Input is consumed in large blocks and every block is symbolized as
+// one batch; output goes through a BufferedWriter which is flushed once per block, not per line. A process feeding
+// one address at a time over a pipe still gets every answer immediately, because a read then returns a single line.
+class Addr2Line {
+public:
+  struct Options {
+    bool addresses = false; // -a: print the address before its location
+    bool functions = false; // -f: print function names
+    bool inlines = false;   // -i: print the callers an address was inlined into
+    bool demangle = false;  // -C: demangle C++ linkage names
+    bool basenames = false; // -s: strip directories from file names
+    bool pretty = false;    // -p: one line per address
+  };
+
+  // addressDigits is the width of the addresses -a prints, 16 for ELF64 and 8 for ELF32
+  Addr2Line(Symbolizer &symbolizer, SymbolTable const &symbols, Options const &options, unsigned const addressDigits, BufferedWriter &out);
+
+  // Prints the locations of the addresses in order
+  void resolve(std::span<uint64_t const> const addresses);
+
+  // Reads addresses from fd until end of file
+  void run(int const fd);
+
+  // Address as addr2line parses it: hex digits with an optional 0x prefix, anything behind them ignored
+  static uint64_t parseAddress(std::string_view const line) noexcept;
+
+private:
+  void printLocation(std::string_view const function, std::string_view file, uint32_t const line, uint32_t const discriminator);
+  // outermost is the subprogram at the end of an inline chain, the other frames are inlined instances
+  std::string_view functionName(Symbolizer::Frame const &frame, bool const outermost);
+  // Mangled name as -C asks for it
+  std::string_view demangle(std::string_view const name);
+
+  Symbolizer &symbolizer_;
+  SymbolTable const &symbols_;
+  Options options_;
+  unsigned addressDigits_;
+  BufferedWriter &out_;
+  Symbolizer::Batch batch_;
+  std::unordered_map<std::string_view, std::string> demangled_; // by linkage name, which points into .debug_str
+};
+
+#endif
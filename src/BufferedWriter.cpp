@@ -0,0 +1,61 @@
+#include "BufferedWriter.hpp"
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+BufferedWriter::BufferedWriter(int const fd, size_t const capacity) : fd_(fd), buffer_(capacity) {
+}
+
+BufferedWriter::~BufferedWriter() {
+  try {
+    flush();
+  } catch (std::exception const &) {
+  }
+}
+
+void BufferedWriter::append(std::string_view const text) {
+  if (text.size() > (buffer_.size() - size_)) {
+    flush();
+    if (text.size() > buffer_.size()) {
+      buffer_.resize(text.size());
+    }
+  }
+  memcpy(buffer_.data() + size_, text.data(), text.size());
+  size_ += text.size();
+}
+
+void BufferedWriter::appendDecimal(uint64_t const value) {
+  std::array<char, 20> digits;
+  std::to_chars_result const result = std::to_chars(digits.data(), digits.data() + digits.size(), value);
+  append(std::string_view(digits.data(), static_cast<size_t>(result.ptr - digits.data())));
+}
+
+void BufferedWriter::appendHex(uint64_t const value, unsigned const digits) {
+  std::array<char, 16> hex;
+  std::to_chars_result const result = std::to_chars(hex.data(), hex.data() + hex.size(), value, 16);
+  size_t const length = static_cast<size_t>(result.ptr - hex.data());
+  for (size_t i = length; i < digits; i++) {
+    append('0');
+  }
+  append(std::string_view(hex.data(), length));
+}
+
+void BufferedWriter::flush() {
+  size_t written = 0U;
+  while (written < size_) {
+    ssize_t const result = write(fd_, buffer_.data() + written, size_ - written);
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      size_ = 0U;
+      throw std::runtime_error(std::string("write failed: ") + strerror(errno));
+    }
+    written += static_cast<size_t>(result);
+  }
+  size_ = 0U;
+}
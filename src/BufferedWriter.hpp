@@ -0,0 +1,37 @@
+#ifndef BUFFERED_WRITER_HPP
+#define BUFFERED_WRITER_HPP
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Output to a file descriptor through one large buffer, which is written with a single write() when it fills up or
+// when flush() is called. For printing many short lines, where a stream flushed per line costs a system call each.
+class BufferedWriter {
+public:
+  explicit BufferedWriter(int const fd, size_t const capacity = static_cast<size_t>(1U) << 16U);
+  ~BufferedWriter(); // flushes, a failing write can not be reported any more at this point
+  BufferedWriter(BufferedWriter const &) = delete;
+  BufferedWriter &operator=(BufferedWriter const &) = delete;
+
+  inline void append(char const c) {
+    if (size_ == buffer_.size()) {
+      flush();
+    }
+    buffer_[size_++] = c;
+  }
+
+  void append(std::string_view const text);
+  void appendDecimal(uint64_t const value);
+  // Lower case hex digits, zero padded to at least digits characters
+  void appendHex(uint64_t const value, unsigned const digits);
+
+  void flush();
+
+private:
+  int fd_;
+  std::vector<char> buffer_;
+  size_t size_ = 0U;
+};
+
+#endif
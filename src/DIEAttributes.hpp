@@ -0,0 +1,112 @@
+#ifndef DIE_ATTRIBUTES_HPP
+#define DIE_ATTRIBUTES_HPP
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include "ByteReader.hpp"
+#include "DebugAbbrev.hpp"
+#include "FormValue.hpp"
+#include "UnitInfo.hpp"
+
+// The attributes of one DIE as DebugInfo::walkUnit hands them to a visitor. Nothing is decoded up front and nothing is
+// allocated: iterating steps over the values with FormValue::skip, Attribute::value() decodes one of them into a
+// FormValue, which points into the section. Once the attributes have been iterated to the end, the walker continues
+// behind them without skipping them a second time.
+class DIEAttributes {
+public:
+  class Attribute {
+  public:
+    Attribute(DebugAbbrev::AttributeSpecification const &specification, ByteReader const &reader, UnitInfo const &unit) noexcept
+        : specification_(&specification), reader_(reader), unit_(&unit) {
+    }
+
+    inline DebugAbbrev::AttributeName name() const noexcept {
+      return specification_->attributeName;
+    }
+
+    inline DebugAbbrev::Form form() const noexcept {
+      return specification_->form;
+    }
+
+    inline FormValue value() const {
+      ByteReader reader = reader_;
+      return FormValue::read(reader, *specification_, *unit_);
+    }
+
+  private:
+    DebugAbbrev::AttributeSpecification const *specification_;
+    ByteReader reader_; // at the value
+    UnitInfo const *unit_;
+  };
+
+  class Iterator {
+  public:
+    Iterator(DIEAttributes const &attributes, size_t const index, ByteReader const &reader) noexcept : attributes_(&attributes), index_(index), reader_(reader) {
+    }
+
+    inline Attribute operator*() const noexcept {
+      return Attribute(attributes_->specifications_[index_], reader_, *attributes_->unit_);
+    }
+
+    Iterator &operator++() {
+      FormValue::skip(reader_, attributes_->specifications_[index_].form, *attributes_->unit_);
+      index_++;
+      if (index_ == attributes_->specifications_.size()) {
+        attributes_->end_ = reader_.cursor_;
+      }
+      return *this;
+    }
+
+    inline bool operator==(Iterator const &other) const noexcept {
+      return index_ == other.index_;
+    }
+
+  private:
+    DIEAttributes const *attributes_;
+    size_t index_;
+    ByteReader reader_;
+  };
+
+  // reader is at the first value of a DIE of abbreviation abbrev
+  DIEAttributes(ByteReader const &reader, DebugAbbrev::AbbrevEntry const &abbrev, UnitInfo const &unit) noexcept
+      : specifications_(abbrev.attributeSpecifications), reader_(reader), unit_(&unit), end_(specifications_.empty() ? reader.cursor_ : nullptr) {
+  }
+
+  inline Iterator begin() const noexcept {
+    return Iterator(*this, 0U, reader_);
+  }
+
+  inline Iterator end() const noexcept {
+    return Iterator(*this, specifications_.size(), reader_);
+  }
+
+  // Value of the first attribute named attributeName, std::nullopt if the DIE has none
+  std::optional<FormValue> find(DebugAbbrev::AttributeName const attributeName) const {
+    for (Attribute const attribute : *this) {
+      if (attribute.name() == attributeName) {
+        return attribute.value();
+      }
+    }
+    return std::nullopt;
+  }
+
+  // Moves reader, which is where the attributes start, behind them
+  void skip(ByteReader &reader) const {
+    if (end_ != nullptr) {
+      reader.cursor_ = end_;
+      return;
+    }
+    for (DebugAbbrev::AttributeSpecification const &specification : specifications_) {
+      FormValue::skip(reader, specification.form, *unit_);
+    }
+  }
+
+private:
+  std::span<DebugAbbrev::AttributeSpecification const> specifications_;
+  ByteReader reader_; // at the first value
+  UnitInfo const *unit_;
+  mutable uint8_t const *end_; // behind the last value once it is known
+};
+
+#endif
@@ -0,0 +1,125 @@
+#include "DIEFilter.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include "ByteReader.hpp"
+#include "FormValue.hpp"
+#include "Parallel.hpp"
+
+namespace {
+bool isUnitDIE(DebugAbbrev::Tag const tag) noexcept {
+  return (tag == DebugAbbrev::Tag::DW_TAG_compile_unit) || (tag == DebugAbbrev::Tag::DW_TAG_partial_unit) || (tag == DebugAbbrev::Tag::DW_TAG_type_unit) ||
+         (tag == DebugAbbrev::Tag::DW_TAG_skeleton_unit);
+}
+
+DebugAbbrev::AbbrevEntry const &entry(DebugAbbrev::AbbrevTable const &abbrevTable, uint64_t const abbrevIndex) {
+  DebugAbbrev::AbbrevTable::const_iterator const it = abbrevTable.find(abbrevIndex);
+  if (it == abbrevTable.end()) {
+    throw std::runtime_error("abbrevIndex not found in debugAbbrevTable");
+  }
+  return it->second;
+}
+} // namespace
+
+DIEFilter::Plans DIEFilter::plan(DebugAbbrev::AbbrevTable const &abbrevTable) const {
+  Plans plans;
+  plans.reserve(abbrevTable.size());
+  for (std::pair<uint64_t const, DebugAbbrev::AbbrevEntry> const &abbrev : abbrevTable) {
+    DebugAbbrev::AbbrevEntry const &abbrevEntry = abbrev.second;
+    auto const hasAttribute = [&abbrevEntry](DebugAbbrev::AttributeName const attributeName) {
+      return std::any_of(abbrevEntry.attributeSpecifications.begin(), abbrevEntry.attributeSpecifications.end(),
+                         [attributeName](DebugAbbrev::AttributeSpecification const &specification) {
+                           return specification.attributeName == attributeName;
+                         });
+    };
+    bool const tagMatches = tags.empty() || (std::find(tags.begin(), tags.end(), abbrevEntry.tag) != tags.end());
+    bool const candidate = tagMatches && std::all_of(attributes.begin(), attributes.end(), hasAttribute) && (!name || hasAttribute(DebugAbbrev::AttributeName::DW_AT_name));
+    bool const inScope = scopes.empty() || isUnitDIE(abbrevEntry.tag) || (std::find(scopes.begin(), scopes.end(), abbrevEntry.tag) != scopes.end());
+    plans.emplace(abbrev.first, Plan{candidate, abbrevEntry.hasChildren && inScope});
+  }
+  return plans;
+}
+
+std::vector<DIEFilter::Match> DIEFilter::apply(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections,
+                                               std::vector<UnitInfo> const &units) const {
+  // units sharing an abbreviation table share its plans
+  std::unordered_map<ptrdiff_t, Plans> plans;
+  for (UnitInfo const &unit : units) {
+    if (plans.find(unit.abbrevOffset) == plans.end()) {
+      plans.emplace(unit.abbrevOffset, plan(debugAbbrevSections.at(unit.abbrevOffset)));
+    }
+  }
+
+  std::vector<std::vector<Match>> matches(units.size());
+  Parallel::forEach(units.size(), [&](size_t const unitIndex, size_t) {
+    UnitInfo const &unit = units[unitIndex];
+    applyToUnit(sections, unit, debugAbbrevSections.at(unit.abbrevOffset), plans.at(unit.abbrevOffset), matches[unitIndex]);
+  });
+
+  std::vector<Match> result;
+  for (std::vector<Match> const &unitMatches : matches) {
+    result.insert(result.end(), unitMatches.begin(), unitMatches.end());
+  }
+  return result;
+}
+
+void DIEFilter::applyToUnit(DwarfSections const &sections, UnitInfo const &unit, DebugAbbrev::AbbrevTable const &abbrevTable, Plans const &plans,
+                            std::vector<Match> &matches) const {
+  DwarfSections::UnitSection const section = sections.unitSection(unit.offset);
+  ByteReader reader(section.data.data(), section.data.size());
+  reader.step((unit.offset - section.base) + unit.headerSize);
+  uint32_t const end = unit.end - section.base;
+
+  // Skips the children of a DIE whose attributes have been read, up to and including their terminating entry
+  auto const skipChildren = [&]() {
+    for (uint32_t depth = 1U; depth > 0U;) {
+      uint64_t const abbrevIndex = reader.readLEB128(false);
+      if (abbrevIndex == 0U) {
+        depth--;
+        continue;
+      }
+      DebugAbbrev::AbbrevEntry const &abbrevEntry = entry(abbrevTable, abbrevIndex);
+      for (DebugAbbrev::AttributeSpecification const &attributeSpec : abbrevEntry.attributeSpecifications) {
+        FormValue::skip(reader, attributeSpec.form, unit);
+      }
+      if (abbrevEntry.hasChildren) {
+        depth++;
+      }
+    }
+  };
+
+  while (static_cast<uint32_t>(reader.getOffset()) < end) {
+    uint32_t const dieOffset = section.base + static_cast<uint32_t>(reader.getOffset());
+    uint64_t const abbrevIndex = reader.readLEB128(false);
+    if (abbrevIndex == 0U) {
+      continue; // end of the children of a visited DIE, or padding
+    }
+    DebugAbbrev::AbbrevEntry const &abbrevEntry = entry(abbrevTable, abbrevIndex);
+    Plan const &diePlan = plans.at(abbrevIndex);
+    bool const skipsChildren = abbrevEntry.hasChildren && !diePlan.descend;
+
+    std::string_view dieName;
+    uint32_t sibling = 0U;
+    for (DebugAbbrev::AttributeSpecification const &attributeSpec : abbrevEntry.attributeSpecifications) {
+      if (diePlan.candidate && (attributeSpec.attributeName == DebugAbbrev::AttributeName::DW_AT_name)) {
+        dieName = sections.string(FormValue::read(reader, attributeSpec, unit));
+      } else if (skipsChildren && (attributeSpec.attributeName == DebugAbbrev::AttributeName::DW_AT_sibling)) {
+        FormValue const formValue = FormValue::read(reader, attributeSpec, unit);
+        sibling = formValue.isReference() ? static_cast<uint32_t>(formValue.value) : 0U;
+      } else {
+        FormValue::skip(reader, attributeSpec.form, unit);
+      }
+    }
+
+    if (diePlan.candidate && (!name || name(dieName))) {
+      matches.push_back(Match{dieOffset, unit.offset, abbrevEntry.tag, dieName});
+    }
+    if (skipsChildren) {
+      // a sibling must lie behind the DIE and inside the unit to be trusted
+      if ((sibling > (section.base + static_cast<uint32_t>(reader.getOffset()))) && (sibling < unit.end)) {
+        reader.cursor_ = reader.start_ + (sibling - section.base);
+      } else {
+        skipChildren();
+      }
+    }
+  }
+}
@@ -0,0 +1,50 @@
+#ifndef DIE_FILTER_HPP
+#define DIE_FILTER_HPP
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "DebugAbbrev.hpp"
+#include "DwarfSections.hpp"
+#include "UnitInfo.hpp"
+
+// Finds the DIEs a query asks for without decoding the rest. The tag set and the required attributes are properties of
+// the abbreviation, so they are checked once per abbreviation code, not per DIE; a DIE which cannot match has its
+// attributes skipped undecoded. Subtrees nothing can match in are not entered: the DW_AT_sibling of their root jumps
+// over them when the producer emitted one, otherwise their DIEs are skipped attribute by attribute.
+class DIEFilter {
+public:
+  struct Match {
+    uint32_t offset;     // DIE offset
+    uint32_t unitOffset;
+    DebugAbbrev::Tag tag;
+    std::string_view name; // empty if the DIE has no DW_AT_name
+  };
+
+  std::vector<DebugAbbrev::Tag> tags;                      // tags a match may have, empty for any
+  std::vector<DebugAbbrev::AttributeName> attributes;     // attributes a match must have
+  std::function<bool(std::string_view const name)> name; // called with DW_AT_name, unset accepts any DIE
+  std::vector<DebugAbbrev::Tag> scopes; // only the children of these (and of the unit DIE) are visited, empty for all
+
+  // The matches of all units, in the order of units and within each unit in section order. Units are filtered in
+  // parallel, name is called from several threads at once.
+  std::vector<Match> apply(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections,
+                           std::vector<UnitInfo> const &units) const;
+
+private:
+  // What the filter does with the DIEs of one abbreviation
+  struct Plan {
+    bool candidate; // tag and attributes fit, only the name is left to check
+    bool descend;   // has children which may match
+  };
+
+  using Plans = std::unordered_map<uint64_t, Plan>; // by abbreviation code
+
+  Plans plan(DebugAbbrev::AbbrevTable const &abbrevTable) const;
+  void applyToUnit(DwarfSections const &sections, UnitInfo const &unit, DebugAbbrev::AbbrevTable const &abbrevTable, Plans const &plans,
+                   std::vector<Match> &matches) const;
+};
+
+#endif
@@ -0,0 +1,175 @@
+#include "DIEIndex.hpp"
+#include <algorithm>
+#include <cassert>
+#include "QualifiedNames.hpp"
+#include "TypeNames.hpp"
+
+DIEIndex::DIEIndex(DwarfSections const &sections)
+    : sections_(sections), strings_(sections.debugStr), typeNames_(std::make_unique<TypeNames>()), qualifiedNames_(std::make_unique<QualifiedNames>()) {
+}
+
+DIEIndex::~DIEIndex() = default;
+DIEIndex::DIEIndex(DIEIndex &&other) noexcept = default;
+DIEIndex &DIEIndex::operator=(DIEIndex &&other) noexcept = default;
+
+uint32_t DIEIndex::beginUnit(UnitInfo const &unit) {
+  uint32_t const unitIndex = static_cast<uint32_t>(units_.size());
+  std::vector<uint32_t>::iterator const position = std::upper_bound(unitOrder_.begin(), unitOrder_.end(), unit.offset, [this](uint32_t const offset, uint32_t const index) {
+    return offset < units_[index].offset;
+  });
+  assert(((position == unitOrder_.begin()) || (units_[*(position - 1)].end <= unit.offset)) && "units must not overlap");
+  assert(((position == unitOrder_.end()) || (unit.end <= units_[*position].offset)) && "units must not overlap");
+  ordered_ = ordered_ && (position == unitOrder_.end());
+  unitOrder_.insert(position, unitIndex);
+  units_.push_back(unit);
+  UnitInfo &added = units_.back();
+  added.firstDIE = static_cast<uint32_t>(dies_.size());
+  added.endDIE = added.firstDIE;
+  return unitIndex;
+}
+
+void DIEIndex::endUnit() noexcept {
+  assert(!units_.empty());
+  UnitInfo &unit = units_.back();
+  unit.endDIE = static_cast<uint32_t>(dies_.size());
+
+  // link every DIE to the next child of the same parent
+  std::vector<uint32_t> lastChild(unit.endDIE - unit.firstDIE, invalidIndex);
+  for (uint32_t i = unit.firstDIE; i < unit.endDIE; i++) {
+    DIEInfo &die = dies_[i];
+    die.sibling = invalidIndex;
+    if (die.parent != invalidIndex) {
+      uint32_t &previous = lastChild[die.parent - unit.firstDIE];
+      if (previous != invalidIndex) {
+        dies_[previous].sibling = i;
+      }
+      previous = i;
+    }
+  }
+}
+
+uint32_t DIEIndex::addDIE(DIEInfo &&die) {
+  assert(((offsets_.size() == units_.back().firstDIE) || (offsets_.back() < die.offset)) && "DIEs must be added in section order");
+  offsets_.push_back(die.offset);
+  dies_.push_back(std::move(die));
+  return static_cast<uint32_t>(dies_.size() - 1U);
+}
+
+uint32_t DIEIndex::appendUnit(UnitInfo const &unit, std::vector<DIEInfo> &&dies) {
+  uint32_t const unitIndex = beginUnit(unit);
+  uint32_t const base = static_cast<uint32_t>(dies_.size());
+  offsets_.reserve(offsets_.size() + dies.size());
+  dies_.reserve(dies_.size() + dies.size());
+  for (DIEInfo &die : dies) {
+    if (die.parent != invalidIndex) {
+      die.parent += base;
+    }
+    die.unit = unitIndex;
+    addDIE(std::move(die));
+  }
+  endUnit();
+  return unitIndex;
+}
+
+uint32_t DIEIndex::findIndex(uint32_t const offset) const noexcept {
+  std::vector<uint32_t>::const_iterator first = offsets_.begin();
+  std::vector<uint32_t>::const_iterator last = offsets_.end();
+  if (!ordered_) {
+    // the offsets are only sorted within each unit
+    uint32_t const unitIndex = findUnit(offset);
+    if (unitIndex == invalidIndex) {
+      return invalidIndex;
+    }
+    first = offsets_.begin() + units_[unitIndex].firstDIE;
+    last = offsets_.begin() + units_[unitIndex].endDIE;
+  }
+  std::vector<uint32_t>::const_iterator const it = std::lower_bound(first, last, offset);
+  if ((it == last) || (*it != offset)) {
+    return invalidIndex;
+  }
+  return static_cast<uint32_t>(it - offsets_.begin());
+}
+
+DIEIndex::DIEInfo const *DIEIndex::find(uint32_t const offset) const noexcept {
+  uint32_t const index = findIndex(offset);
+  if (index == invalidIndex) {
+    return nullptr;
+  }
+  return &dies_[index];
+}
+
+uint32_t DIEIndex::findUnit(uint32_t const offset) const noexcept {
+  // first unit which ends behind offset
+  std::vector<uint32_t>::const_iterator const it = std::upper_bound(unitOrder_.begin(), unitOrder_.end(), offset, [this](uint32_t const value, uint32_t const index) {
+    return value < units_[index].end;
+  });
+  if ((it == unitOrder_.end()) || (offset < units_[*it].offset)) {
+    return invalidIndex;
+  }
+  return *it;
+}
+
+std::span<DIEIndex::UnitInfo const> DIEIndex::debugInfoUnits() const noexcept {
+  assert(ordered_);
+  std::vector<UnitInfo>::const_iterator const it = std::partition_point(units_.begin(), units_.end(), [this](UnitInfo const &unit) {
+    return sections_.inDebugInfo(unit.offset);
+  });
+  return std::span<UnitInfo const>(units_.data(), static_cast<size_t>(it - units_.begin()));
+}
+
+bool DIEIndex::addTypeSignature(UnitInfo const &unit) {
+  assert(unit.isTypeUnit());
+  return typeSignatures_.emplace(unit.signature, unit.offset + unit.typeOffset).second;
+}
+
+uint32_t DIEIndex::signatureOffset(uint64_t const signature) const noexcept {
+  TypeSignatures::const_iterator const it = typeSignatures_.find(signature);
+  return (it == typeSignatures_.end()) ? 0U : it->second;
+}
+
+std::optional<FormValue> DIEIndex::attribute(uint32_t const index, DebugAbbrev::AttributeName const attributeName) const {
+  DIEInfo const &die = dies_[index];
+  UnitInfo const &unit = units_[die.unit];
+  DwarfSections::UnitSection const section = sections_.unitSection(die.offset);
+  ByteReader reader(section.data.data(), section.data.size());
+  reader.step(die.offset - section.base);
+  static_cast<void>(reader.readLEB128(false)); // abbrev code
+  for (DebugAbbrev::AttributeSpecification const &attributeSpec : die.abbrev->attributeSpecifications) {
+    if (attributeSpec.attributeName == attributeName) {
+      return FormValue::read(reader, attributeSpec, unit);
+    }
+    FormValue::skip(reader, attributeSpec.form, unit);
+  }
+  return std::nullopt;
+}
+
+std::vector<std::pair<DebugAbbrev::AttributeName, FormValue>> DIEIndex::attributes(uint32_t const index) const {
+  DIEInfo const &die = dies_[index];
+  UnitInfo const &unit = units_[die.unit];
+  DwarfSections::UnitSection const section = sections_.unitSection(die.offset);
+  ByteReader reader(section.data.data(), section.data.size());
+  reader.step(die.offset - section.base);
+  static_cast<void>(reader.readLEB128(false)); // abbrev code
+  std::vector<std::pair<DebugAbbrev::AttributeName, FormValue>> result;
+  result.reserve(die.abbrev->attributeSpecifications.size());
+  for (DebugAbbrev::AttributeSpecification const &attributeSpec : die.abbrev->attributeSpecifications) {
+    result.emplace_back(attributeSpec.attributeName, FormValue::read(reader, attributeSpec, unit));
+  }
+  return result;
+}
+
+std::string_view DIEIndex::string(FormValue const &formValue) const noexcept {
+  return sections_.string(formValue);
+}
+
+std::string_view DIEIndex::typeName(uint32_t const offset) const {
+  return typeNames_->name(*this, offset);
+}
+
+std::string_view DIEIndex::qualifiedName(uint32_t const index) const {
+  return qualifiedNames_->name(*this, index);
+}
+
+bool DIEIndex::qualifiedName(uint32_t const index, std::string_view &name) const {
+  return qualifiedNames_->name(*this, index, name);
+}
@@ -0,0 +1,140 @@
+#ifndef DIE_INDEX_HPP
+#define DIE_INDEX_HPP
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "DebugAbbrev.hpp"
+#include "DwarfSections.hpp"
+#include "FormValue.hpp"
+#include "StringPool.hpp"
+#include "UnitInfo.hpp"
+
+class QualifiedNames;
+class TypeNames;
+
+// Global store of all DIEs of a .debug_info section and, behind them, of .debug_types and the supplementary file.
+// DIEs are appended in section order, so the offset array is sorted by construction and every section offset
+// (CU relative references after rebasing, DW_FORM_ref_addr into another CU) resolves by a binary search over a flat
+// uint32_t array. Units may also be appended in any order, as the symbolizer does when it decodes them on demand; then
+// an offset is looked up in its unit. Once building has finished the index is never modified, so const members are safe
+// to call from any number of threads at the same time.
+class DIEIndex {
+public:
+  static uint32_t constexpr invalidIndex = UINT32_MAX;
+
+  using UnitInfo = ::UnitInfo;
+  using TypeSignatures = std::unordered_map<uint64_t, uint32_t>; // type signature -> DIE offset of the type DIE
+
+  struct DIEInfo {
+    uint32_t offset;
+    DebugAbbrev::Tag tag;
+    StringPool::Handle name; // DW_AT_name, see name()
+    uint32_t parent;      // index of the parent DIE, invalidIndex for the unit DIE
+    uint32_t unit;        // index into units()
+    uint32_t typeOffset;  // section offset of the DW_AT_type target, 0 if there is none
+    uint32_t sibling;     // index of the next DIE with the same parent, invalidIndex for the last child
+    DebugAbbrev::AbbrevEntry const *abbrev; // attributes are decoded on demand with attribute()
+  };
+
+  // The section data must outlive the index, attribute values point into it
+  explicit DIEIndex(DwarfSections const &sections);
+  ~DIEIndex();
+  DIEIndex(DIEIndex &&other) noexcept;
+  DIEIndex &operator=(DIEIndex &&other) noexcept;
+  DIEIndex(DIEIndex const &) = delete;
+  DIEIndex &operator=(DIEIndex const &) = delete;
+
+  uint32_t beginUnit(UnitInfo const &unit);
+  void endUnit() noexcept;
+  uint32_t addDIE(DIEInfo &&die);
+  // Adds a unit decoded on its own; parent indices in dies are relative to the unit DIE
+  uint32_t appendUnit(UnitInfo const &unit, std::vector<DIEInfo> &&dies);
+
+  uint32_t findIndex(uint32_t const offset) const noexcept;
+  DIEInfo const *find(uint32_t const offset) const noexcept;
+  uint32_t findUnit(uint32_t const offset) const noexcept;
+
+  inline DIEInfo const &at(uint32_t const index) const noexcept {
+    return dies_[index];
+  }
+
+  inline uint32_t firstChild(uint32_t const index) const noexcept {
+    uint32_t const next = index + 1U;
+    return ((next < dies_.size()) && (dies_[next].parent == index)) ? next : invalidIndex;
+  }
+
+  inline size_t size() const noexcept {
+    return dies_.size();
+  }
+
+  inline std::vector<UnitInfo> const &units() const noexcept {
+    return units_;
+  }
+
+  // The units of .debug_info, which come first in units() of an index built in section order
+  std::span<UnitInfo const> debugInfoUnits() const noexcept;
+
+  // Registers the type DIE of a type unit under its signature. Returns false if another unit already provides that
+  // signature; such a duplicate must not be added, so that every type is decoded once however many units carry it.
+  bool addTypeSignature(UnitInfo const &unit);
+
+  // DIE offset of the type a DW_FORM_ref_sig8 names, 0 if no type unit provides the signature
+  uint32_t signatureOffset(uint64_t const signature) const noexcept;
+
+  inline TypeSignatures const &typeSignatures() const noexcept {
+    return typeSignatures_;
+  }
+
+  // Decodes the attributes of the DIE up to the requested one
+  std::optional<FormValue> attribute(uint32_t const index, DebugAbbrev::AttributeName const attributeName) const;
+  // All attributes of the DIE, in abbreviation order
+  std::vector<std::pair<DebugAbbrev::AttributeName, FormValue>> attributes(uint32_t const index) const;
+  std::string_view string(FormValue const &formValue) const noexcept;
+
+  // DW_AT_name of the DIE, a view into the section data which stays valid as long as the index
+  inline std::string_view name(uint32_t const index) const noexcept {
+    return strings_.view(dies_[index].name);
+  }
+
+  inline StringPool const &strings() const noexcept {
+    return strings_;
+  }
+
+  // For the builders, which intern the names of the units they decode in parallel
+  inline StringPool &strings() noexcept {
+    return strings_;
+  }
+
+  inline DwarfSections const &sections() const noexcept {
+    return sections_;
+  }
+
+  // Fully rendered C++ name of the type DIE at offset, memoized and shared by every user of this index
+  std::string_view typeName(uint32_t const offset) const;
+
+  // Scope qualified name such as ns::Class::method, memoized like typeName
+  std::string_view qualifiedName(uint32_t const index) const;
+  // Like qualifiedName, returns false if the name needs a DIE which is not indexed yet
+  bool qualifiedName(uint32_t const index, std::string_view &name) const;
+
+private:
+  DwarfSections sections_;
+  std::vector<uint32_t> offsets_; // kept apart from dies_ so that a lookup only touches the keys
+  std::vector<DIEInfo> dies_;
+  std::vector<UnitInfo> units_;
+  std::vector<uint32_t> unitOrder_; // indices into units_ by unit offset
+  bool ordered_ = true;             // every unit was appended behind the previous ones
+  TypeSignatures typeSignatures_;
+  StringPool strings_;
+  std::unique_ptr<TypeNames> typeNames_;
+  std::unique_ptr<QualifiedNames> qualifiedNames_;
+};
+
+#endif
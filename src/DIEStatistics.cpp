@@ -0,0 +1,49 @@
+#include "DIEStatistics.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+void DIEStatistics::onUnitBegin(UnitInfo const &unit) {
+  units_++;
+  if (unit.isTypeUnit()) {
+    typeUnits_++;
+  }
+  unitBytes_ += unit.end - unit.offset;
+  depth_ = 0U;
+}
+
+void DIEStatistics::onDIE(uint32_t, DebugAbbrev::Tag const tag, DebugAbbrev::AbbrevEntry const &abbrev, DIEAttributes const &attributes) {
+  dies_++;
+  maxDepth_ = std::max(maxDepth_, depth_);
+  tags_[tag]++;
+  if (abbrev.hasChildren) {
+    depth_++;
+  }
+  std::optional<FormValue> const name = attributes.find(DebugAbbrev::AttributeName::DW_AT_name);
+  if (name.has_value()) {
+    std::string_view const text = sections_.string(*name);
+    if (!text.empty()) {
+      namedDIEs_++;
+    }
+    if (text.size() > longestName_.size()) {
+      longestName_ = text;
+    }
+  }
+}
+
+void DIEStatistics::print(std::ostream &out, size_t const topTags) const {
+  out << units_ << " units (" << typeUnits_ << " type units), " << unitBytes_ << " bytes\n";
+  out << dies_ << " DIEs, " << namedDIEs_ << " named, nested " << maxDepth_ << " deep\n";
+  out << "longest name: " << longestName_.size() << " characters\n";
+  std::vector<std::pair<DebugAbbrev::Tag, size_t>> tags(tags_.begin(), tags_.end());
+  size_t const shown = std::min(tags.size(), topTags);
+  std::partial_sort(tags.begin(), tags.begin() + static_cast<ptrdiff_t>(shown), tags.end(), [](auto const &lhs, auto const &rhs) {
+    return (lhs.second != rhs.second) ? (lhs.second > rhs.second) : (lhs.first < rhs.first);
+  });
+  for (size_t i = 0U; i < shown; i++) {
+    out << std::setw(10) << tags[i].second << " " << DebugAbbrev::tagToString(tags[i].first) << "\n";
+  }
+}
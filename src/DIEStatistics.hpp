@@ -0,0 +1,46 @@
+#ifndef DIE_STATISTICS_HPP
+#define DIE_STATISTICS_HPP
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include "DIEAttributes.hpp"
+#include "DebugAbbrev.hpp"
+#include "DwarfSections.hpp"
+#include "UnitInfo.hpp"
+
+// Counts over the DIEs of all units, collected in one pass from the events of DebugInfo::walkUnit. No DIE is stored,
+// only DW_AT_name is decoded; the longest name is copied.
+class DIEStatistics {
+public:
+  explicit DIEStatistics(DwarfSections const &sections) noexcept : sections_(sections) {
+  }
+
+  void onUnitBegin(UnitInfo const &unit);
+  void onDIE(uint32_t const offset, DebugAbbrev::Tag const tag, DebugAbbrev::AbbrevEntry const &abbrev, DIEAttributes const &attributes);
+
+  inline void onChildrenEnd() noexcept {
+    depth_--;
+  }
+
+  inline void onUnitEnd(UnitInfo const &) noexcept {
+  }
+
+  // The totals and the topTags most frequent tags
+  void print(std::ostream &out, size_t const topTags) const;
+
+private:
+  DwarfSections const &sections_;
+  size_t units_ = 0U;
+  size_t typeUnits_ = 0U;
+  uint64_t unitBytes_ = 0U;
+  size_t dies_ = 0U;
+  size_t namedDIEs_ = 0U;
+  uint32_t depth_ = 0U;    // of the DIEs being read, the unit DIE is at depth 0
+  uint32_t maxDepth_ = 0U;
+  std::string longestName_;
+  std::map<DebugAbbrev::Tag, size_t> tags_;
+};
+
+#endif
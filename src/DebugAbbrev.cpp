@@ -1,4 +1,13 @@
 #include "DebugAbbrev.hpp"
+#include <sstream>
+
+namespace {
+std::string toHexString(uint32_t const value) {
+  std::stringstream ss;
+  ss << "0x" << std::hex << value;
+  return ss.str();
+}
+} // namespace
 
 const std::string DebugAbbrev::attributeNameToString(AttributeName const attributeName) {
   switch (attributeName) {
@@ -203,9 +212,168 @@ const std::string DebugAbbrev::attributeNameToString(AttributeName const attribu
   case (AttributeName::DW_AT_ranges): {
     return "DW_AT_ranges ";
   }
+  case (AttributeName::DW_AT_trampoline): {
+    return "DW_AT_trampoline";
+  }
+  case (AttributeName::DW_AT_call_column): {
+    return "DW_AT_call_column";
+  }
+  case (AttributeName::DW_AT_call_file): {
+    return "DW_AT_call_file";
+  }
+  case (AttributeName::DW_AT_call_line): {
+    return "DW_AT_call_line";
+  }
+  case (AttributeName::DW_AT_description): {
+    return "DW_AT_description";
+  }
+  case (AttributeName::DW_AT_binary_scale): {
+    return "DW_AT_binary_scale";
+  }
+  case (AttributeName::DW_AT_decimal_scale): {
+    return "DW_AT_decimal_scale";
+  }
+  case (AttributeName::DW_AT_small): {
+    return "DW_AT_small";
+  }
+  case (AttributeName::DW_AT_decimal_sign): {
+    return "DW_AT_decimal_sign";
+  }
+  case (AttributeName::DW_AT_digit_count): {
+    return "DW_AT_digit_count";
+  }
+  case (AttributeName::DW_AT_picture_string): {
+    return "DW_AT_picture_string";
+  }
+  case (AttributeName::DW_AT_mutable): {
+    return "DW_AT_mutable";
+  }
+  case (AttributeName::DW_AT_threads_scaled): {
+    return "DW_AT_threads_scaled";
+  }
+  case (AttributeName::DW_AT_explicit): {
+    return "DW_AT_explicit";
+  }
+  case (AttributeName::DW_AT_object_pointer): {
+    return "DW_AT_object_pointer";
+  }
+  case (AttributeName::DW_AT_endianity): {
+    return "DW_AT_endianity";
+  }
+  case (AttributeName::DW_AT_elemental): {
+    return "DW_AT_elemental";
+  }
+  case (AttributeName::DW_AT_pure): {
+    return "DW_AT_pure";
+  }
   case (AttributeName::DW_AT_recursive): {
     return "DW_AT_recursive ";
   }
+  case (AttributeName::DW_AT_signature): {
+    return "DW_AT_signature";
+  }
+  case (AttributeName::DW_AT_main_subprogram): {
+    return "DW_AT_main_subprogram";
+  }
+  case (AttributeName::DW_AT_data_bit_offset): {
+    return "DW_AT_data_bit_offset";
+  }
+  case (AttributeName::DW_AT_const_expr): {
+    return "DW_AT_const_expr";
+  }
+  case (AttributeName::DW_AT_enum_class): {
+    return "DW_AT_enum_class";
+  }
+  case (AttributeName::DW_AT_linkage_name): {
+    return "DW_AT_linkage_name";
+  }
+  case (AttributeName::DW_AT_string_length_bit_size): {
+    return "DW_AT_string_length_bit_size";
+  }
+  case (AttributeName::DW_AT_string_length_byte_size): {
+    return "DW_AT_string_length_byte_size";
+  }
+  case (AttributeName::DW_AT_rank): {
+    return "DW_AT_rank";
+  }
+  case (AttributeName::DW_AT_str_offsets_base): {
+    return "DW_AT_str_offsets_base";
+  }
+  case (AttributeName::DW_AT_addr_base): {
+    return "DW_AT_addr_base";
+  }
+  case (AttributeName::DW_AT_rnglists_base): {
+    return "DW_AT_rnglists_base";
+  }
+  case (AttributeName::DW_AT_dwo_name): {
+    return "DW_AT_dwo_name";
+  }
+  case (AttributeName::DW_AT_reference): {
+    return "DW_AT_reference";
+  }
+  case (AttributeName::DW_AT_rvalue_reference): {
+    return "DW_AT_rvalue_reference";
+  }
+  case (AttributeName::DW_AT_macros): {
+    return "DW_AT_macros";
+  }
+  case (AttributeName::DW_AT_call_all_calls): {
+    return "DW_AT_call_all_calls";
+  }
+  case (AttributeName::DW_AT_call_all_source_calls): {
+    return "DW_AT_call_all_source_calls";
+  }
+  case (AttributeName::DW_AT_call_all_tail_calls): {
+    return "DW_AT_call_all_tail_calls";
+  }
+  case (AttributeName::DW_AT_call_return_pc): {
+    return "DW_AT_call_return_pc";
+  }
+  case (AttributeName::DW_AT_call_value): {
+    return "DW_AT_call_value";
+  }
+  case (AttributeName::DW_AT_call_origin): {
+    return "DW_AT_call_origin";
+  }
+  case (AttributeName::DW_AT_call_parameter): {
+    return "DW_AT_call_parameter";
+  }
+  case (AttributeName::DW_AT_call_pc): {
+    return "DW_AT_call_pc";
+  }
+  case (AttributeName::DW_AT_call_tail_call): {
+    return "DW_AT_call_tail_call";
+  }
+  case (AttributeName::DW_AT_call_target): {
+    return "DW_AT_call_target";
+  }
+  case (AttributeName::DW_AT_call_target_clobbered): {
+    return "DW_AT_call_target_clobbered";
+  }
+  case (AttributeName::DW_AT_call_data_location): {
+    return "DW_AT_call_data_location";
+  }
+  case (AttributeName::DW_AT_call_data_value): {
+    return "DW_AT_call_data_value";
+  }
+  case (AttributeName::DW_AT_noreturn): {
+    return "DW_AT_noreturn";
+  }
+  case (AttributeName::DW_AT_alignment): {
+    return "DW_AT_alignment";
+  }
+  case (AttributeName::DW_AT_export_symbols): {
+    return "DW_AT_export_symbols";
+  }
+  case (AttributeName::DW_AT_deleted): {
+    return "DW_AT_deleted";
+  }
+  case (AttributeName::DW_AT_defaulted): {
+    return "DW_AT_defaulted";
+  }
+  case (AttributeName::DW_AT_loclists_base): {
+    return "DW_AT_loclists_base";
+  }
   case (AttributeName::DW_AT_lo_user): {
     return "DW_AT_lo_user";
   }
@@ -215,17 +383,54 @@ const std::string DebugAbbrev::attributeNameToString(AttributeName const attribu
   case (AttributeName::DW_AT_GNU_call_site_value): {
     return "DW_AT_GNU_call_site_value";
   }
+  case (AttributeName::DW_AT_GNU_call_site_data_value): {
+    return "DW_AT_GNU_call_site_data_value";
+  }
+  case (AttributeName::DW_AT_GNU_call_site_target): {
+    return "DW_AT_GNU_call_site_target";
+  }
+  case (AttributeName::DW_AT_GNU_tail_call): {
+    return "DW_AT_GNU_tail_call";
+  }
+  case (AttributeName::DW_AT_GNU_all_tail_call_sites): {
+    return "DW_AT_GNU_all_tail_call_sites";
+  }
+  case (AttributeName::DW_AT_GNU_macros): {
+    return "DW_AT_GNU_macros";
+  }
+  case (AttributeName::DW_AT_GNU_dwo_name): {
+    return "DW_AT_GNU_dwo_name";
+  }
+  case (AttributeName::DW_AT_GNU_dwo_id): {
+    return "DW_AT_GNU_dwo_id";
+  }
+  case (AttributeName::DW_AT_GNU_ranges_base): {
+    return "DW_AT_GNU_ranges_base";
+  }
+  case (AttributeName::DW_AT_GNU_addr_base): {
+    return "DW_AT_GNU_addr_base";
+  }
+  case (AttributeName::DW_AT_GNU_pubnames): {
+    return "DW_AT_GNU_pubnames";
+  }
   case (AttributeName::DW_AT_GNU_all_call_sites): {
     return "DW_AT_GNU_all_call_sites";
   }
   case (AttributeName::DW_AT_GNU_locviews): {
     return "DW_AT_GNU_locviews";
   }
+  case (AttributeName::DW_AT_GNU_entry_view): {
+    return "DW_AT_GNU_entry_view";
+  }
   case (AttributeName::DW_AT_hi_user): {
     return "DW_AT_hi_user";
   }
 
   default: {
+    // producers keep adding vendor attributes, the value still decodes through its form
+    if ((attributeName > AttributeName::DW_AT_lo_user) && (attributeName < AttributeName::DW_AT_hi_user)) {
+      return "DW_AT_user_" + toHexString(static_cast<uint32_t>(attributeName));
+    }
     throw std::runtime_error("unknown attribute name");
   }
   }
@@ -404,9 +609,51 @@ const std::string DebugAbbrev::tagToString(Tag const tag) {
   case (Tag::DW_TAG_shared_type): {
     return "DW_TAG_shared_type";
   }
+  case (Tag::DW_TAG_type_unit): {
+    return "DW_TAG_type_unit";
+  }
+  case (Tag::DW_TAG_rvalue_reference_type): {
+    return "DW_TAG_rvalue_reference_type";
+  }
+  case (Tag::DW_TAG_template_alias): {
+    return "DW_TAG_template_alias";
+  }
+  case (Tag::DW_TAG_coarray_type): {
+    return "DW_TAG_coarray_type";
+  }
+  case (Tag::DW_TAG_generic_subrange): {
+    return "DW_TAG_generic_subrange";
+  }
+  case (Tag::DW_TAG_dynamic_type): {
+    return "DW_TAG_dynamic_type";
+  }
+  case (Tag::DW_TAG_atomic_type): {
+    return "DW_TAG_atomic_type";
+  }
+  case (Tag::DW_TAG_call_site): {
+    return "DW_TAG_call_site";
+  }
+  case (Tag::DW_TAG_call_site_parameter): {
+    return "DW_TAG_call_site_parameter";
+  }
+  case (Tag::DW_TAG_skeleton_unit): {
+    return "DW_TAG_skeleton_unit";
+  }
+  case (Tag::DW_TAG_immutable_type): {
+    return "DW_TAG_immutable_type";
+  }
   case (Tag::DW_TAG_lo_user): {
     return "DW_TAG_lo_user";
   }
+  case (Tag::DW_TAG_GNU_template_template_param): {
+    return "DW_TAG_GNU_template_template_param";
+  }
+  case (Tag::DW_TAG_GNU_template_parameter_pack): {
+    return "DW_TAG_GNU_template_parameter_pack";
+  }
+  case (Tag::DW_TAG_GNU_formal_parameter_pack): {
+    return "DW_TAG_GNU_formal_parameter_pack";
+  }
   case (Tag::DW_TAG_GNU_call_site): {
     return "DW_TAG_GNU_call_site";
   }
@@ -417,11 +664,25 @@ const std::string DebugAbbrev::tagToString(Tag const tag) {
     return "DW_TAG_hi_user";
   }
   default: {
+    if ((tag > Tag::DW_TAG_lo_user) && (tag < Tag::DW_TAG_hi_user)) {
+      return "DW_TAG_user_" + toHexString(static_cast<uint32_t>(tag));
+    }
     throw std::runtime_error("unknown tag");
   }
   }
 }
 
+std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> DebugAbbrev::parseDebugAbbrev(std::span<uint8_t const> const debugAbbrev) {
+  ByteReader debugAbbrevReader(debugAbbrev.data(), debugAbbrev.size());
+  std::unordered_map<ptrdiff_t, AbbrevTable> abbrevSection;
+  while (!debugAbbrevReader.reachedEnd()) {
+    ptrdiff_t const offset = debugAbbrevReader.getOffset();
+    AbbrevTable abbrevTable = parseAbbrevTable(debugAbbrevReader);
+    abbrevSection[offset] = std::move(abbrevTable);
+  }
+  return abbrevSection;
+}
+
 DebugAbbrev::AbbrevTable DebugAbbrev::parseAbbrevTable(ByteReader &debugAbbrevReader) {
   AbbrevTable abbrevTable;
 
@@ -451,7 +712,8 @@ DebugAbbrev::AbbrevTable DebugAbbrev::parseAbbrevTable(ByteReader &debugAbbrevRe
         uint64_t const form = debugAbbrevReader.readLEB128(false);
 
         if (!((attributeName == 0) && (form == 0))) {
-          abbrevEntry.attributeSpecifications.emplace_back(AttributeSpecification{static_cast<AttributeName>(attributeName), static_cast<Form>(form)});
+          int64_t const implicitConst = (static_cast<Form>(form) == Form::DW_FORM_implicit_const) ? static_cast<int64_t>(debugAbbrevReader.readLEB128(true)) : 0;
+          abbrevEntry.attributeSpecifications.emplace_back(AttributeSpecification{static_cast<AttributeName>(attributeName), static_cast<Form>(form), implicitConst});
         } else {
           break;
         }
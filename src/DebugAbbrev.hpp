@@ -2,6 +2,7 @@
 #define DEBUG_ABBREV_HPP
 #include <cassert>
 #include <cstdint>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
@@ -83,12 +84,76 @@ public:
     DW_AT_use_UTF8 = 0x53,
     DW_AT_extension = 0x54,
     DW_AT_ranges = 0x55,
+    DW_AT_trampoline = 0x56,
+    DW_AT_call_column = 0x57,
+    DW_AT_call_file = 0x58,
+    DW_AT_call_line = 0x59,
+    DW_AT_description = 0x5a,
+    DW_AT_binary_scale = 0x5b,
+    DW_AT_decimal_scale = 0x5c,
+    DW_AT_small = 0x5d,
+    DW_AT_decimal_sign = 0x5e,
+    DW_AT_digit_count = 0x5f,
+    DW_AT_picture_string = 0x60,
+    DW_AT_mutable = 0x61,
+    DW_AT_threads_scaled = 0x62,
+    DW_AT_explicit = 0x63,
+    DW_AT_object_pointer = 0x64,
+    DW_AT_endianity = 0x65,
+    DW_AT_elemental = 0x66,
+    DW_AT_pure = 0x67,
     DW_AT_recursive = 0x68,
+    DW_AT_signature = 0x69,
+    DW_AT_main_subprogram = 0x6a,
+    DW_AT_data_bit_offset = 0x6b,
+    DW_AT_const_expr = 0x6c,
+    DW_AT_enum_class = 0x6d,
+    DW_AT_linkage_name = 0x6e,
+    DW_AT_string_length_bit_size = 0x6f,
+    DW_AT_string_length_byte_size = 0x70,
+    DW_AT_rank = 0x71,
+    DW_AT_str_offsets_base = 0x72,
+    DW_AT_addr_base = 0x73,
+    DW_AT_rnglists_base = 0x74,
+    DW_AT_dwo_name = 0x76,
+    DW_AT_reference = 0x77,
+    DW_AT_rvalue_reference = 0x78,
+    DW_AT_macros = 0x79,
+    DW_AT_call_all_calls = 0x7a,
+    DW_AT_call_all_source_calls = 0x7b,
+    DW_AT_call_all_tail_calls = 0x7c,
+    DW_AT_call_return_pc = 0x7d,
+    DW_AT_call_value = 0x7e,
+    DW_AT_call_origin = 0x7f,
+    DW_AT_call_parameter = 0x80,
+    DW_AT_call_pc = 0x81,
+    DW_AT_call_tail_call = 0x82,
+    DW_AT_call_target = 0x83,
+    DW_AT_call_target_clobbered = 0x84,
+    DW_AT_call_data_location = 0x85,
+    DW_AT_call_data_value = 0x86,
+    DW_AT_noreturn = 0x87,
+    DW_AT_alignment = 0x88,
+    DW_AT_export_symbols = 0x89,
+    DW_AT_deleted = 0x8a,
+    DW_AT_defaulted = 0x8b,
+    DW_AT_loclists_base = 0x8c,
     DW_AT_lo_user = 0x2000,
     DW_AT_MIPS_linkage_name = 0x2007,
     DW_AT_GNU_call_site_value = 0x2111,
+    DW_AT_GNU_call_site_data_value = 0x2112,
+    DW_AT_GNU_call_site_target = 0x2113,
+    DW_AT_GNU_tail_call = 0x2115,
+    DW_AT_GNU_all_tail_call_sites = 0x2116,
     DW_AT_GNU_all_call_sites = 0x2117,
+    DW_AT_GNU_macros = 0x2119,
+    DW_AT_GNU_dwo_name = 0x2130,    // split DWARF before DWARF 5
+    DW_AT_GNU_dwo_id = 0x2131,
+    DW_AT_GNU_ranges_base = 0x2132,
+    DW_AT_GNU_addr_base = 0x2133,
+    DW_AT_GNU_pubnames = 0x2134,
     DW_AT_GNU_locviews = 0x2137,
+    DW_AT_GNU_entry_view = 0x2138,
     DW_AT_hi_user = 0x3fff,
 
   };
@@ -115,11 +180,38 @@ public:
     DW_FORM_ref8 = 0x14,
     DW_FORM_ref_udata = 0x15,
     DW_FORM_indirect = 0x16,
+    DW_FORM_sec_offset = 0x17,
+    DW_FORM_exprloc = 0x18,
+    DW_FORM_flag_present = 0x19,
+    DW_FORM_strx = 0x1a,
+    DW_FORM_addrx = 0x1b,
+    DW_FORM_ref_sup4 = 0x1c,
+    DW_FORM_strp_sup = 0x1d,
+    DW_FORM_data16 = 0x1e,
+    DW_FORM_line_strp = 0x1f,
+    DW_FORM_ref_sig8 = 0x20,
+    DW_FORM_implicit_const = 0x21,
+    DW_FORM_loclistx = 0x22,
+    DW_FORM_rnglistx = 0x23,
+    DW_FORM_ref_sup8 = 0x24,
+    DW_FORM_strx1 = 0x25,
+    DW_FORM_strx2 = 0x26,
+    DW_FORM_strx3 = 0x27,
+    DW_FORM_strx4 = 0x28,
+    DW_FORM_addrx1 = 0x29,
+    DW_FORM_addrx2 = 0x2a,
+    DW_FORM_addrx3 = 0x2b,
+    DW_FORM_addrx4 = 0x2c,
+    DW_FORM_GNU_addr_index = 0x1f01, // split DWARF before DWARF 5, DW_FORM_addrx
+    DW_FORM_GNU_str_index = 0x1f02,  // DW_FORM_strx
+    DW_FORM_GNU_ref_alt = 0x1f20,    // dwz supplementary file, DW_FORM_ref_sup4
+    DW_FORM_GNU_strp_alt = 0x1f21,   // DW_FORM_strp_sup
   };
 
   struct AttributeSpecification {
     AttributeName attributeName;
     Form form;
+    int64_t implicitConst; // value of a DW_FORM_implicit_const attribute, which is stored in the abbreviation
   };
 
   enum class Tag : uint16_t {
@@ -180,7 +272,21 @@ public:
     DW_TAG_imported_unit = 0x3d,
     DW_TAG_condition = 0x3f,
     DW_TAG_shared_type = 0x40,
+    DW_TAG_type_unit = 0x41,
+    DW_TAG_rvalue_reference_type = 0x42,
+    DW_TAG_template_alias = 0x43,
+    DW_TAG_coarray_type = 0x44,
+    DW_TAG_generic_subrange = 0x45,
+    DW_TAG_dynamic_type = 0x46,
+    DW_TAG_atomic_type = 0x47,
+    DW_TAG_call_site = 0x48,
+    DW_TAG_call_site_parameter = 0x49,
+    DW_TAG_skeleton_unit = 0x4a,
+    DW_TAG_immutable_type = 0x4b,
     DW_TAG_lo_user = 0x4080,
+    DW_TAG_GNU_template_template_param = 0x4106,
+    DW_TAG_GNU_template_parameter_pack = 0x4107,
+    DW_TAG_GNU_formal_parameter_pack = 0x4108,
     DW_TAG_GNU_call_site = 0x4109,
     DW_TAG_GNU_call_site_parameter = 0x410a,
     DW_TAG_hi_user = 0xffff
@@ -199,18 +305,14 @@ public:
 
   // Template function to support both ELF32 and ELF64
   template <typename ShdrType>
-  static const std::unordered_map<ptrdiff_t, AbbrevTable> parseDebugAbbrev(std::vector<uint8_t> const &elfFile, const ShdrType *const debugAbbrevSection) {
+  static const std::unordered_map<ptrdiff_t, AbbrevTable> parseDebugAbbrev(std::span<uint8_t const> const elfFile, const ShdrType *const debugAbbrevSection) {
     uint8_t const *const debugAbbrevData = elfFile.data() + debugAbbrevSection->sh_offset;
-    ByteReader debugAbbrevReader(debugAbbrevData, static_cast<size_t>(debugAbbrevSection->sh_size));
-    std::unordered_map<ptrdiff_t, AbbrevTable> abbrevSection;
-    while (!debugAbbrevReader.reachedEnd()) {
-      ptrdiff_t const offset = debugAbbrevReader.getOffset();
-      AbbrevTable abbrevTable = parseAbbrevTable(debugAbbrevReader);
-      abbrevSection[offset] = std::move(abbrevTable);
-    }
-    return abbrevSection;
+    return parseDebugAbbrev(std::span<uint8_t const>(debugAbbrevData, static_cast<size_t>(debugAbbrevSection->sh_size)));
   }
 
+  // Tables of a section or, in a .dwp package, of one contribution; keys are offsets relative to its start
+  static std::unordered_map<ptrdiff_t, AbbrevTable> parseDebugAbbrev(std::span<uint8_t const> const debugAbbrev);
+
   static AbbrevTable parseAbbrevTable(ByteReader &debugAbbrevReader);
 };
 
@@ -1,6 +1,131 @@
 #include "DebugInfo.hpp"
+#include <algorithm>
+#include <deque>
+#include <optional>
+#include <span>
+#include "Parallel.hpp"
 #include "VariableLocation.hpp"
 
+namespace {
+// The dump of one unit, waiting for the DIEs its DW_AT_type references point to
+struct UnitDump {
+  std::string text;
+  std::vector<DebugInfo::PendingReference> references; // outputPosition is a position in text
+};
+
+// Writes the dump with the name of each referenced type behind its DW_AT_type value
+void writeUnitDump(UnitDump &dump, DIEIndex &dieIndex) {
+  DebugInfo::resolvePendingReferences(dump.references, dieIndex);
+  size_t written = 0U;
+  for (DebugInfo::PendingReference const &pending : dump.references) {
+    std::cout.write(dump.text.data() + written, static_cast<std::streamsize>(pending.outputPosition - written));
+    if (!pending.typeName.empty()) {
+      std::cout << " (" << pending.typeName << ")";
+    }
+    written = pending.outputPosition;
+  }
+  std::cout.write(dump.text.data() + written, static_cast<std::streamsize>(dump.text.size() - written));
+}
+
+// Contribution of one unit to .debug_str_offsets or .debug_addr. base points behind the header of the contribution,
+// whose unit_length bounds the table.
+std::span<uint8_t const> contribution(std::span<uint8_t const> const section, uint64_t const base, uint32_t const headerSize, char const *const sectionName) {
+  if ((base < headerSize) || (base > section.size())) {
+    throw std::runtime_error(std::string("base out of ") + sectionName);
+  }
+  ByteReader reader(section.data() + (base - headerSize), headerSize);
+  uint64_t const end = (base - headerSize) + sizeof(uint32_t) + reader.getNumber<uint32_t>();
+  return section.subspan(static_cast<size_t>(base), static_cast<size_t>(std::min<uint64_t>(end, section.size()) - base));
+}
+
+// Offset array of a .debug_rnglists or .debug_loclists contribution; base points behind the header, whose last field
+// is the number of offsets
+std::span<uint8_t const> offsetTable(std::span<uint8_t const> const section, uint64_t const base, char const *const sectionName) {
+  if ((base < 12U) || (base > section.size())) {
+    throw std::runtime_error(std::string("base out of ") + sectionName);
+  }
+  ByteReader reader(section.data() + (base - 4U), sizeof(uint32_t));
+  uint64_t const size = static_cast<uint64_t>(reader.getNumber<uint32_t>()) * sizeof(uint32_t);
+  return section.subspan(static_cast<size_t>(base), static_cast<size_t>(std::min<uint64_t>(size, section.size() - base)));
+}
+
+char const *unitTypeToString(DIEIndex::UnitInfo::UnitType const unitType) noexcept {
+  switch (unitType) {
+  case (DIEIndex::UnitInfo::UnitType::DW_UT_compile): {
+    return "DW_UT_compile";
+  }
+  case (DIEIndex::UnitInfo::UnitType::DW_UT_type): {
+    return "DW_UT_type";
+  }
+  case (DIEIndex::UnitInfo::UnitType::DW_UT_partial): {
+    return "DW_UT_partial";
+  }
+  case (DIEIndex::UnitInfo::UnitType::DW_UT_skeleton): {
+    return "DW_UT_skeleton";
+  }
+  case (DIEIndex::UnitInfo::UnitType::DW_UT_split_compile): {
+    return "DW_UT_split_compile";
+  }
+  case (DIEIndex::UnitInfo::UnitType::DW_UT_split_type): {
+    return "DW_UT_split_type";
+  }
+  default: {
+    return "unknown";
+  }
+  }
+}
+
+// The visitor behind decodeUnit: one DIEInfo per DIE, with DW_AT_name and DW_AT_type decoded
+class DIECollector {
+public:
+  DIECollector(DwarfSections const &sections, DIEIndex::TypeSignatures const &typeSignatures, StringPool &strings) noexcept
+      : sections_(sections), typeSignatures_(typeSignatures), strings_(strings) {
+  }
+
+  inline void onUnitBegin(DIEIndex::UnitInfo const &) noexcept {
+  }
+
+  void onDIE(uint32_t const offset, DebugAbbrev::Tag const tag, DebugAbbrev::AbbrevEntry const &abbrev, DIEAttributes const &attributes) {
+    DIEIndex::DIEInfo die{offset, tag, StringPool::noString, parents_.empty() ? DIEIndex::invalidIndex : parents_.back(), 0U, 0U, DIEIndex::invalidIndex, &abbrev};
+    for (DIEAttributes::Attribute const attribute : attributes) {
+      if (attribute.name() == DebugAbbrev::AttributeName::DW_AT_name) {
+        die.name = strings_.handle(sections_, attribute.value());
+      } else if (attribute.name() == DebugAbbrev::AttributeName::DW_AT_type) {
+        FormValue const formValue = attribute.value();
+        if (formValue.isReference()) {
+          die.typeOffset = static_cast<uint32_t>(formValue.value);
+        } else if (formValue.form == DebugAbbrev::Form::DW_FORM_ref_sig8) {
+          DIEIndex::TypeSignatures::const_iterator const type = typeSignatures_.find(formValue.value);
+          die.typeOffset = (type == typeSignatures_.end()) ? 0U : type->second;
+        }
+      }
+    }
+    dies_.push_back(die);
+    if (abbrev.hasChildren) {
+      parents_.push_back(static_cast<uint32_t>(dies_.size() - 1U));
+    }
+  }
+
+  inline void onChildrenEnd() noexcept {
+    parents_.pop_back();
+  }
+
+  inline void onUnitEnd(DIEIndex::UnitInfo const &) noexcept {
+  }
+
+  inline std::vector<DIEIndex::DIEInfo> takeDIEs() noexcept {
+    return std::move(dies_);
+  }
+
+private:
+  DwarfSections const &sections_;
+  DIEIndex::TypeSignatures const &typeSignatures_;
+  StringPool &strings_;
+  std::vector<DIEIndex::DIEInfo> dies_;
+  std::vector<uint32_t> parents_; // DIEs whose children are being read
+};
+} // namespace
+
 const std::string DebugInfo::vectorToStr(std::vector<uint8_t> const &vec) {
   std::stringstream ss;
   ss << " ";
@@ -10,28 +135,304 @@ const std::string DebugInfo::vectorToStr(std::vector<uint8_t> const &vec) {
   return ss.str();
 }
 
-Tree<uint32_t> DebugInfo::parseDebugInfoTree(ByteReader &debugInfoReader, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections, char const *const debugStr,
-                                             uint32_t const unitLength, bool const is32, DebugLoc const &debugLoc) {
-  uint8_t const *start = debugInfoReader.cursor_;
+DIEIndex::UnitInfo DebugInfo::readUnitHeader(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections,
+                                             uint32_t const unitOffset) {
+  if (unitOffset >= sections.unitsEnd()) {
+    throw std::runtime_error("unit offset out of .debug_info");
+  }
+  DwarfSections::UnitSection const section = sections.unitSection(unitOffset);
+  uint32_t const sectionOffset = unitOffset - section.base;
+  ByteReader reader(section.data.data() + sectionOffset, section.data.size() - sectionOffset);
+  uint32_t const unitLength = reader.getNumber<uint32_t>();
+  if (unitLength >= 0xFFFF'FFF0U) {
+    throw std::runtime_error("64-bit DWARF is not supported");
+  }
+  if (unitLength > static_cast<size_t>(reader.end_ - reader.cursor_)) {
+    throw std::runtime_error("wrong unit_length");
+  }
+  DIEIndex::UnitInfo unit{};
+  unit.offset = unitOffset;
+  unit.end = unitOffset + static_cast<uint32_t>(sizeof(uint32_t)) + unitLength;
+  unit.version = reader.getNumber<uint16_t>();
+  unit.unitType = DIEIndex::UnitInfo::UnitType::DW_UT_compile;
+  if (unit.version < 5U) {
+    unit.abbrevOffset = reader.getNumber<uint32_t>();
+    unit.addressSize = reader.getNumber<uint8_t>();
+    if (sections.inDebugTypes(unitOffset)) {
+      // the header of a .debug_types unit ends with the fields DWARF 5 gave to DW_UT_type
+      unit.unitType = DIEIndex::UnitInfo::UnitType::DW_UT_type;
+      unit.signature = reader.getNumber<uint64_t>();
+      unit.typeOffset = reader.getNumber<uint32_t>();
+    }
+  } else if (unit.version == 5U) {
+    // DWARF 5 moved the address size in front of the abbreviation offset and added the unit type
+    unit.unitType = static_cast<DIEIndex::UnitInfo::UnitType>(reader.getNumber<uint8_t>());
+    unit.addressSize = reader.getNumber<uint8_t>();
+    unit.abbrevOffset = reader.getNumber<uint32_t>();
+    switch (unit.unitType) {
+    case (DIEIndex::UnitInfo::UnitType::DW_UT_compile):
+    case (DIEIndex::UnitInfo::UnitType::DW_UT_partial): {
+      break;
+    }
+    case (DIEIndex::UnitInfo::UnitType::DW_UT_skeleton):
+    case (DIEIndex::UnitInfo::UnitType::DW_UT_split_compile): {
+      unit.signature = reader.getNumber<uint64_t>(); // dwo_id
+      break;
+    }
+    case (DIEIndex::UnitInfo::UnitType::DW_UT_type):
+    case (DIEIndex::UnitInfo::UnitType::DW_UT_split_type): {
+      unit.signature = reader.getNumber<uint64_t>();
+      unit.typeOffset = reader.getNumber<uint32_t>();
+      break;
+    }
+    default: {
+      throw std::runtime_error("unknown unit type");
+    }
+    }
+  } else {
+    throw std::runtime_error("unsupported DWARF version " + std::to_string(unit.version));
+  }
+  unit.headerSize = static_cast<uint8_t>(reader.getOffset());
+  unit.altBase = sections.altBase();
+  unit.inAltFile = sections.inAltFile(unitOffset);
+  if (unit.inAltFile) {
+    unit.abbrevOffset += sections.altAbbrevBase;
+  }
+  if (unit.version < 5U) {
+    return unit;
+  }
+  if ((unit.unitType == DIEIndex::UnitInfo::UnitType::DW_UT_split_compile) || (unit.unitType == DIEIndex::UnitInfo::UnitType::DW_UT_split_type)) {
+    // A split unit names no bases. The .dwo sections, or the contributions of the unit to those of a package, hold one
+    // table each, which starts behind the header.
+    if (sections.debugStrOffsets.size() >= 8U) {
+      unit.strOffsets = contribution(sections.debugStrOffsets, 8U, 8U, ".debug_str_offsets.dwo");
+    }
+    if (sections.debugRnglists.size() >= 12U) {
+      unit.rangeListOffsets = offsetTable(sections.debugRnglists, 12U, ".debug_rnglists.dwo");
+      unit.rangeListsBase = 12U;
+    }
+    if (sections.debugLoclists.size() >= 12U) {
+      unit.locationListOffsets = offsetTable(sections.debugLoclists, 12U, ".debug_loclists.dwo");
+      unit.locationListsBase = 12U;
+    }
+  }
+
+  // The indirection tables of the unit start at the bases given by the unit DIE. Those attributes may come after
+  // attributes which already use the tables, so the DIE is skipped over once to find them.
+  ByteReader dieReader(section.data.data(), unit.end - section.base);
+  dieReader.step(sectionOffset + unit.headerSize);
+  uint64_t const abbrevIndex = dieReader.readLEB128(false);
+  if (abbrevIndex == 0U) {
+    return unit;
+  }
+  DebugAbbrev::AbbrevTable const &abbrevTable = debugAbbrevSections.at(unit.abbrevOffset);
+  DebugAbbrev::AbbrevTable::const_iterator const it = abbrevTable.find(abbrevIndex);
+  if (it == abbrevTable.end()) {
+    throw std::runtime_error("abbrevIndex not found in debugAbbrevTable");
+  }
+  for (DebugAbbrev::AttributeSpecification const &attributeSpec : it->second.attributeSpecifications) {
+    switch (attributeSpec.attributeName) {
+    case (DebugAbbrev::AttributeName::DW_AT_str_offsets_base): {
+      uint64_t const base = FormValue::read(dieReader, attributeSpec, unit).value;
+      unit.strOffsets = contribution(sections.debugStrOffsets, base, 8U, ".debug_str_offsets");
+      break;
+    }
+    case (DebugAbbrev::AttributeName::DW_AT_addr_base): {
+      uint64_t const base = FormValue::read(dieReader, attributeSpec, unit).value;
+      unit.addresses = contribution(sections.debugAddr, base, 8U, ".debug_addr");
+      break;
+    }
+    case (DebugAbbrev::AttributeName::DW_AT_rnglists_base): {
+      uint64_t const base = FormValue::read(dieReader, attributeSpec, unit).value;
+      unit.rangeListOffsets = offsetTable(sections.debugRnglists, base, ".debug_rnglists");
+      unit.rangeListsBase = static_cast<uint32_t>(base);
+      break;
+    }
+    case (DebugAbbrev::AttributeName::DW_AT_loclists_base): {
+      uint64_t const base = FormValue::read(dieReader, attributeSpec, unit).value;
+      unit.locationListOffsets = offsetTable(sections.debugLoclists, base, ".debug_loclists");
+      unit.locationListsBase = static_cast<uint32_t>(base);
+      break;
+    }
+    default: {
+      FormValue::skip(dieReader, attributeSpec.form, unit);
+      break;
+    }
+    }
+  }
+  return unit;
+}
+
+std::vector<DIEIndex::UnitInfo> DebugInfo::readUnitHeaders(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections) {
+  std::vector<DIEIndex::UnitInfo> units;
+  uint32_t unitOffset = 0U;
+  while (unitOffset < sections.unitsEnd()) {
+    units.push_back(readUnitHeader(sections, debugAbbrevSections, unitOffset));
+    unitOffset = units.back().end;
+  }
+  return units;
+}
+
+std::vector<uint32_t> DebugInfo::readUnitOffsets(DwarfSections const &sections) {
+  std::vector<uint32_t> offsets;
+  uint32_t unitOffset = 0U;
+  while (unitOffset < sections.unitsEnd()) {
+    DwarfSections::UnitSection const section = sections.unitSection(unitOffset);
+    uint32_t const sectionOffset = unitOffset - section.base;
+    ByteReader reader(section.data.data() + sectionOffset, section.data.size() - sectionOffset);
+    uint32_t const unitLength = reader.getNumber<uint32_t>();
+    if ((unitLength >= 0xFFFF'FFF0U) || (unitLength > static_cast<size_t>(reader.end_ - reader.cursor_))) {
+      throw std::runtime_error("wrong unit_length");
+    }
+    offsets.push_back(unitOffset);
+    unitOffset += static_cast<uint32_t>(sizeof(uint32_t)) + unitLength;
+  }
+  return offsets;
+}
+
+std::vector<std::pair<DebugAbbrev::AttributeName, FormValue>> DebugInfo::readUnitDIE(DwarfSections const &sections, DIEIndex::UnitInfo const &unit,
+                                                                                       DebugAbbrev::AbbrevTable const &abbrevTable) {
+  DwarfSections::UnitSection const section = sections.unitSection(unit.offset);
+  ByteReader reader(section.data.data(), section.data.size());
+  reader.step((unit.offset - section.base) + unit.headerSize);
+  std::vector<std::pair<DebugAbbrev::AttributeName, FormValue>> attributes;
+  uint64_t const abbrevIndex = reader.readLEB128(false);
+  if (abbrevIndex == 0U) {
+    return attributes; // empty unit
+  }
+  DebugAbbrev::AbbrevTable::const_iterator const it = abbrevTable.find(abbrevIndex);
+  if (it == abbrevTable.end()) {
+    throw std::runtime_error("abbrevIndex not found in debugAbbrevTable");
+  }
+  for (DebugAbbrev::AttributeSpecification const &attributeSpec : it->second.attributeSpecifications) {
+    attributes.emplace_back(attributeSpec.attributeName, FormValue::read(reader, attributeSpec, unit));
+  }
+  return attributes;
+}
+
+std::vector<DebugInfo::DIEInfo> DebugInfo::decodeUnit(DwarfSections const &sections, DIEIndex::UnitInfo const &unit, DebugAbbrev::AbbrevTable const &abbrevTable,
+                                                      DIEIndex::TypeSignatures const &typeSignatures, StringPool &strings) {
+  DIECollector collector(sections, typeSignatures, strings);
+  walkUnit(sections, unit, abbrevTable, collector);
+  return collector.takeDIEs();
+}
+
+DIEIndex DebugInfo::buildDIEIndex(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections) {
+  return decodeUnits(sections, debugAbbrevSections, readUnitHeaders(sections, debugAbbrevSections));
+}
+
+DIEIndex DebugInfo::buildDIEIndex(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections,
+                                  std::vector<uint32_t> unitOffsets) {
+  std::sort(unitOffsets.begin(), unitOffsets.end());
+  unitOffsets.erase(std::unique(unitOffsets.begin(), unitOffsets.end()), unitOffsets.end());
+  std::vector<DIEIndex::UnitInfo> units;
+  units.reserve(unitOffsets.size());
+  for (uint32_t const unitOffset : unitOffsets) {
+    units.push_back(readUnitHeader(sections, debugAbbrevSections, unitOffset));
+  }
+  return decodeUnits(sections, debugAbbrevSections, units);
+}
+
+DIEIndex DebugInfo::decodeUnits(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections,
+                                std::vector<DIEIndex::UnitInfo> const &units) {
+  // The signatures are registered up front, so that DW_FORM_ref_sig8 resolves while the units are decoded in parallel.
+  // A type unit repeating a known signature is left out.
+  DIEIndex dieIndex(sections);
+  std::vector<DIEIndex::UnitInfo> unique;
+  unique.reserve(units.size());
+  for (DIEIndex::UnitInfo const &unit : units) {
+    if (!unit.isTypeUnit() || dieIndex.addTypeSignature(unit)) {
+      unique.push_back(unit);
+    }
+  }
+
+  std::vector<std::vector<DIEInfo>> decoded(unique.size());
+  Parallel::forEach(unique.size(), [&](size_t const unitIndex, size_t) {
+    DIEIndex::UnitInfo const &unit = unique[unitIndex];
+    decoded[unitIndex] = decodeUnit(sections, unit, debugAbbrevSections.at(unit.abbrevOffset), dieIndex.typeSignatures(), dieIndex.strings());
+  });
+
+  for (size_t i = 0U; i < unique.size(); i++) {
+    dieIndex.appendUnit(unique[i], std::move(decoded[i]));
+  }
+  return dieIndex;
+}
+
+DIEIndex DebugInfo::parseDebugInfo(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections, DebugLoc const &debugLoc) {
+  DIEIndex dieIndex(sections);
+  // signatures come from the unit headers, so a type unit behind the unit referencing it resolves as well
+  std::vector<DIEIndex::UnitInfo> const units = readUnitHeaders(sections, debugAbbrevSections);
+  std::vector<bool> duplicate(units.size(), false);
+  for (size_t i = 0U; i < units.size(); i++) {
+    duplicate[i] = units[i].isTypeUnit() && !dieIndex.addTypeSignature(units[i]);
+  }
+  // A unit is written once the DIEs all its DW_AT_type references point to are indexed, so that a forward reference
+  // into a later unit is named on its own line as well. Until then its dump waits, and so do those behind it.
+  std::deque<UnitDump> waiting;
+  for (size_t i = 0U; i < units.size(); i++) {
+    DIEIndex::UnitInfo const &unit = units[i];
+    UnitDump &dump = waiting.emplace_back();
+    if (duplicate[i]) {
+      dump.text = "type unit at " + numToHexString(unit.offset) + " repeats type_signature " + numToHexString(unit.signature) + ", skipped\n";
+    } else {
+      DwarfSections::UnitSection const section = sections.unitSection(unit.offset);
+      ByteReader debugInfoReader(section.data.data(), section.data.size());
+      debugInfoReader.step(unit.offset - section.base);
+      std::ostringstream unitOutput;
+      parseDebugInfoTree(debugInfoReader, debugAbbrevSections.at(unit.abbrevOffset), unit, debugLoc, dieIndex, unitOutput, dump.references);
+      dump.text = std::move(unitOutput).str();
+    }
+    // units are read in offset order, everything before the end of this one is indexed
+    uint32_t const indexedEnd = unit.end;
+    while (!waiting.empty() && std::all_of(waiting.front().references.begin(), waiting.front().references.end(), [indexedEnd](PendingReference const &pending) {
+             return pending.targetOffset < indexedEnd;
+           })) {
+      writeUnitDump(waiting.front(), dieIndex);
+      waiting.pop_front();
+    }
+  }
+  // references to offsets no unit covers are printed without a name
+  for (UnitDump &dump : waiting) {
+    writeUnitDump(dump, dieIndex);
+  }
+  return dieIndex;
+}
+
+Tree<uint32_t> DebugInfo::parseDebugInfoTree(ByteReader &debugInfoReader, DebugAbbrev::AbbrevTable const &debugAbbrevTable, DIEIndex::UnitInfo const &unit, DebugLoc const &debugLoc,
+                                             DIEIndex &dieIndex, std::ostream &out, std::vector<PendingReference> &pendingReferences) {
 
-  uint16_t const version = debugInfoReader.getNumber<uint16_t>();
-  uint32_t const debug_abbrev_offset = debugInfoReader.getNumber<uint32_t>();
-  uint8_t const address_size = debugInfoReader.getNumber<uint8_t>();
+  uint32_t const unitOffset = unit.offset;
+  uint32_t const sectionBase = unitOffset - static_cast<uint32_t>(debugInfoReader.getOffset()); // DIE offset of the section start
+  uint8_t const address_size = unit.addressSize;
+  debugInfoReader.step(unit.headerSize);
 
-  std::cout << "dump Debug Info:" << std::endl;
+  if (dieIndex.sections().inDebugInfo(unitOffset)) {
+    out << "dump Debug Info:" << "\n";
+  } else {
+    out << (unit.inAltFile ? "dump Debug Info of the supplementary file:" : "dump Debug Types:") << "\n";
+  }
 
-  std::cout << "unit_length: " << unitLength << ", version: " << version << ", debug_abbrev_offset: " << debug_abbrev_offset << ", address_size: " << static_cast<uint32_t>(address_size) << std::endl;
-  DebugAbbrev::AbbrevTable const &debugAbbrevTable = debugAbbrevSections.at(debug_abbrev_offset);
+  out << "unit_length: " << (unit.end - unit.offset - static_cast<uint32_t>(sizeof(uint32_t))) << ", version: " << unit.version;
+  if (unit.version >= 5U) {
+    out << ", unit_type: " << unitTypeToString(unit.unitType);
+  }
+  out << ", debug_abbrev_offset: " << (unit.inAltFile ? (unit.abbrevOffset - dieIndex.sections().altAbbrevBase) : unit.abbrevOffset) << ", address_size: " << static_cast<uint32_t>(address_size);
+  if ((unit.unitType == DIEIndex::UnitInfo::UnitType::DW_UT_type) || (unit.unitType == DIEIndex::UnitInfo::UnitType::DW_UT_split_type)) {
+    out << ", type_signature: " << numToHexString(unit.signature) << ", type_offset: " << numToHexString(unit.typeOffset);
+  } else if (unit.signature != 0U) {
+    out << ", dwo_id: " << numToHexString(unit.signature);
+  }
+  out << "\n";
 
   Tree<uint32_t> debugInfoTree;
   std::vector<TreeNode<uint32_t> *> treeNodeStack;
-  std::unordered_map<uint32_t, DIEInfo> dieStorage; // Store DIE information for type resolution
+  std::vector<uint32_t> parentStack; // global DIE index of every open DIE with children
 
-  uint32_t debugInfoIndex = 0;
+  uint32_t const unitIndex = dieIndex.beginUnit(unit);
 
-  while (debugInfoReader.cursor_ - start < unitLength) {
+  while ((sectionBase + static_cast<uint32_t>(debugInfoReader.getOffset())) < unit.end) {
     // Store the offset before reading the abbrev index, as DWARF references point here
-    uint32_t const dieStartOffset = static_cast<uint32_t>(debugInfoReader.getOffset());
+    uint32_t const dieStartOffset = sectionBase + static_cast<uint32_t>(debugInfoReader.getOffset());
 
     uint64_t const abbrevIndex = debugInfoReader.readLEB128(false);
     if (abbrevIndex != 0) {
@@ -43,110 +444,117 @@ Tree<uint32_t> DebugInfo::parseDebugInfoTree(ByteReader &debugInfoReader, std::u
       DIEInfo currentDIE;
       currentDIE.offset = dieStartOffset;
       currentDIE.tag = abbrevEntry.tag;
+      currentDIE.name = StringPool::noString;
+      currentDIE.parent = parentStack.empty() ? DIEIndex::invalidIndex : parentStack.back();
+      currentDIE.unit = unitIndex;
+      currentDIE.typeOffset = 0U;
+      currentDIE.sibling = DIEIndex::invalidIndex;
+      currentDIE.abbrev = &abbrevEntry;
+
+      std::optional<uint64_t> lowPc; // a DW_AT_high_pc of constant class is relative to it
 
-      std::cout << std::hex << "0x" << debugInfoReader.getOffset() << std::dec << ": section abbrevIndex " << abbrevIndex << "------------------" << std::endl;
-      std::cout << "abbrev tag " << DebugAbbrev::tagToString(abbrevEntry.tag) << std::endl;
+      out << std::hex << "0x" << (sectionBase + static_cast<uint32_t>(debugInfoReader.getOffset())) << std::dec << ": section abbrevIndex " << abbrevIndex << "------------------" << "\n";
+      out << "abbrev tag " << DebugAbbrev::tagToString(abbrevEntry.tag) << "\n";
       for (DebugAbbrev::AttributeSpecification const &attributeSpec : abbrevEntry.attributeSpecifications) {
         const std::string attributeNameStr = DebugAbbrev::attributeNameToString(attributeSpec.attributeName);
-        std::cout << attributeNameStr << ": ";
+        out << attributeNameStr << ": ";
         std::string formStr;
-        switch (attributeSpec.form) {
-        case (DebugAbbrev::Form::DW_FORM_strp): {
-          uint32_t const offset = debugInfoReader.getNumber<uint32_t>();
-          char const *const indirectStr = debugStr + offset;
-          formStr = indirectStr;
-          // Store name for type resolution
-          if (attributeSpec.attributeName == DebugAbbrev::AttributeName::DW_AT_name) {
-            currentDIE.name = indirectStr;
-          }
-          break;
-        }
+        uint64_t constantValue = 0U; // value of the data forms
+        FormValue const formValue = FormValue::read(debugInfoReader, attributeSpec, unit);
+        switch (formValue.form) {
+        case (DebugAbbrev::Form::DW_FORM_strp):
+        case (DebugAbbrev::Form::DW_FORM_line_strp):
+        case (DebugAbbrev::Form::DW_FORM_GNU_strp_alt):
+        case (DebugAbbrev::Form::DW_FORM_strp_sup):
         case (DebugAbbrev::Form::DW_FORM_string): {
-          const std::string str = debugInfoReader.getString();
-          formStr = str;
+          formStr = dieIndex.string(formValue);
           // Store name for type resolution
           if (attributeSpec.attributeName == DebugAbbrev::AttributeName::DW_AT_name) {
-            currentDIE.name = str;
+            currentDIE.name = dieIndex.strings().handle(dieIndex.sections(), formValue);
+          }
+          if ((dieIndex.sections().altDebugStr == nullptr) && ((formValue.form == DebugAbbrev::Form::DW_FORM_GNU_strp_alt) || (formValue.form == DebugAbbrev::Form::DW_FORM_strp_sup))) {
+            formStr = "supplementary " + numToHexString(formValue.value);
           }
           break;
         }
-        case (DebugAbbrev::Form::DW_FORM_data1): {
-          uint8_t const num = debugInfoReader.getNumber<uint8_t>();
-          formStr = numToHexString(num);
-          break;
-        }
-
-        case (DebugAbbrev::Form::DW_FORM_data2): {
-          uint16_t const num = debugInfoReader.getNumber<uint16_t>();
-          formStr = numToHexString(num);
+        case (DebugAbbrev::Form::DW_FORM_data1):
+        case (DebugAbbrev::Form::DW_FORM_data2):
+        case (DebugAbbrev::Form::DW_FORM_data4):
+        case (DebugAbbrev::Form::DW_FORM_data8):
+        case (DebugAbbrev::Form::DW_FORM_udata):
+        case (DebugAbbrev::Form::DW_FORM_sec_offset): {
+          formStr = numToHexString(formValue.value);
+          constantValue = formValue.value;
+          // a location list is referenced by data4 up to DWARF3 and by sec_offset since DWARF4
+          bool const locationList = (formValue.form == DebugAbbrev::Form::DW_FORM_sec_offset) || ((formValue.form == DebugAbbrev::Form::DW_FORM_data4) && (unit.version < 4U));
+          if ((attributeSpec.attributeName == DebugAbbrev::AttributeName::DW_AT_location) && locationList) {
+            debugLoc.decodeAt(out, static_cast<size_t>(formValue.value), unit);
+          }
           break;
         }
-
-        case (DebugAbbrev::Form::DW_FORM_data4): {
-          uint32_t const num = debugInfoReader.getNumber<uint32_t>();
-          formStr = numToHexString(num);
-          if (attributeSpec.attributeName == DebugAbbrev::AttributeName::DW_AT_location) {
-            debugLoc.decodeAt(num);
-          }
+        case (DebugAbbrev::Form::DW_FORM_sdata):
+        case (DebugAbbrev::Form::DW_FORM_implicit_const): {
+          formStr = std::to_string(static_cast<int64_t>(formValue.value));
+          constantValue = formValue.value;
           break;
         }
-
         case (DebugAbbrev::Form::DW_FORM_addr): {
-          // Handle both 32-bit and 64-bit addresses
-          if (is32) {
-            uint32_t const addr = debugInfoReader.getNumber<uint32_t>();
-            formStr = numToHexString(addr);
-          } else {
-            uint64_t const addr = debugInfoReader.getNumber<uint64_t>();
-            formStr = numToHexString(addr);
+          formStr = numToHexString(formValue.value);
+          if (attributeSpec.attributeName == DebugAbbrev::AttributeName::DW_AT_low_pc) {
+            lowPc = formValue.value;
           }
           break;
         }
-        case (DebugAbbrev::Form::DW_FORM_flag): {
-          uint8_t const flag = debugInfoReader.getNumber<uint8_t>();
-          formStr = numToHexString(flag);
+        case (DebugAbbrev::Form::DW_FORM_flag):
+        case (DebugAbbrev::Form::DW_FORM_flag_present): {
+          formStr = numToHexString(formValue.value);
           break;
         }
-        case (DebugAbbrev::Form::DW_FORM_ref1): {
-          uint8_t const reference = debugInfoReader.getNumber<uint8_t>();
-          formStr = numToHexString(reference);
+        case (DebugAbbrev::Form::DW_FORM_ref1):
+        case (DebugAbbrev::Form::DW_FORM_ref2):
+        case (DebugAbbrev::Form::DW_FORM_ref4):
+        case (DebugAbbrev::Form::DW_FORM_ref8):
+        case (DebugAbbrev::Form::DW_FORM_ref_udata): {
+          // printed relative to the unit header like it is encoded
+          formStr = numToHexString(formValue.value - unitOffset);
+          // Special handling for DW_AT_type: resolve to type name after the unit is indexed
+          if (attributeSpec.attributeName == DebugAbbrev::AttributeName::DW_AT_type) {
+            currentDIE.typeOffset = static_cast<uint32_t>(formValue.value);
+          }
           break;
         }
-        case (DebugAbbrev::Form::DW_FORM_ref2): {
-          uint16_t const reference = debugInfoReader.getNumber<uint16_t>();
-          formStr = numToHexString(reference);
+        case (DebugAbbrev::Form::DW_FORM_ref_addr):
+        case (DebugAbbrev::Form::DW_FORM_GNU_ref_alt):
+        case (DebugAbbrev::Form::DW_FORM_ref_sup4):
+        case (DebugAbbrev::Form::DW_FORM_ref_sup8): {
+          // references into the supplementary file are rebased like the DIE offsets of its units
+          formStr = numToHexString(formValue.value);
+          if (attributeSpec.attributeName == DebugAbbrev::AttributeName::DW_AT_type) {
+            currentDIE.typeOffset = static_cast<uint32_t>(formValue.value);
+          }
           break;
         }
-        case (DebugAbbrev::Form::DW_FORM_ref4): {
-          uint32_t const reference = debugInfoReader.getNumber<uint32_t>();
-          formStr = numToHexString(reference);
-          // Special handling for DW_AT_type: resolve to type name
+        case (DebugAbbrev::Form::DW_FORM_ref_sig8): {
+          formStr = "signature " + numToHexString(formValue.value);
           if (attributeSpec.attributeName == DebugAbbrev::AttributeName::DW_AT_type) {
-            std::string typeName = resolveTypeName(reference, dieStorage);
-            if (!typeName.empty()) {
-              formStr += " (" + typeName + ")";
-            }
+            currentDIE.typeOffset = dieIndex.signatureOffset(formValue.value);
           }
           break;
         }
+        case (DebugAbbrev::Form::DW_FORM_data16): {
+          formStr = vectorToStr(std::vector<uint8_t>(formValue.data, formValue.data + formValue.size));
+          break;
+        }
         case (DebugAbbrev::Form::DW_FORM_block1):
         case (DebugAbbrev::Form::DW_FORM_block2):
-        case (DebugAbbrev::Form::DW_FORM_block4): {
-          uint32_t blockLength;
-          if (attributeSpec.form == DebugAbbrev::Form::DW_FORM_block1) {
-            blockLength = debugInfoReader.getNumber<uint8_t>();
-          } else if (attributeSpec.form == DebugAbbrev::Form::DW_FORM_block2) {
-            blockLength = debugInfoReader.getNumber<uint16_t>();
-          } else {
-            blockLength = debugInfoReader.getNumber<uint32_t>();
-          }
-
-          const std::vector<uint8_t> blockData = debugInfoReader.getArray(blockLength);
-          std::string const dataString = vectorToStr(blockData);
-          formStr = numToHexString(blockLength) + dataString;
+        case (DebugAbbrev::Form::DW_FORM_block4):
+        case (DebugAbbrev::Form::DW_FORM_block):
+        case (DebugAbbrev::Form::DW_FORM_exprloc): {
+          std::span<uint8_t const> const blockData(formValue.data, static_cast<size_t>(formValue.size));
+          formStr = numToHexString(formValue.size) + vectorToStr(std::vector<uint8_t>(blockData.begin(), blockData.end()));
 
           if (attributeSpec.attributeName == DebugAbbrev::AttributeName::DW_AT_location) {
-            VariableLocation::handleVariableLocation(blockData);
+            VariableLocation::handleVariableLocation(out, blockData, unit);
           }
 
           break;
@@ -156,11 +564,19 @@ Tree<uint32_t> DebugInfo::parseDebugInfoTree(ByteReader &debugInfoReader, std::u
           throw std::runtime_error("not implemented yet");
         }
         }
-        std::cout << formStr << std::endl;
+        if ((attributeSpec.attributeName == DebugAbbrev::AttributeName::DW_AT_high_pc) && (formValue.form != DebugAbbrev::Form::DW_FORM_addr) && lowPc.has_value()) {
+          // since DWARF4 high_pc may be the size of the range
+          formStr += " (end " + numToHexString(*lowPc + constantValue) + ")";
+        }
+        out << formStr;
+        if ((attributeSpec.attributeName == DebugAbbrev::AttributeName::DW_AT_type) && (currentDIE.typeOffset != 0U)) {
+          pendingReferences.push_back(PendingReference{currentDIE.typeOffset, static_cast<uint32_t>(dieIndex.size()), static_cast<size_t>(out.tellp()), std::string()});
+        }
+        out << "\n";
       }
 
       // Store the DIE information for later type resolution
-      dieStorage[dieStartOffset] = currentDIE;
+      uint32_t const debugInfoIndex = dieIndex.addDIE(std::move(currentDIE));
 
       if (debugInfoTree.hasRoot()) {
         TreeNode<uint32_t> *const currentParent = treeNodeStack.back();
@@ -168,59 +584,43 @@ Tree<uint32_t> DebugInfo::parseDebugInfoTree(ByteReader &debugInfoReader, std::u
 
         if (abbrevEntry.hasChildren) {
           treeNodeStack.push_back(&child);
+          parentStack.push_back(debugInfoIndex);
         }
 
       } else {
         TreeNode<uint32_t> &root = debugInfoTree.setRoot(debugInfoIndex);
         treeNodeStack.push_back(&root);
+        parentStack.push_back(debugInfoIndex);
       }
-
-      debugInfoIndex++;
     } else {
       assert(treeNodeStack.size() > 0U);
       treeNodeStack.pop_back();
+      parentStack.pop_back();
     }
   }
+  dieIndex.endUnit();
 
   return debugInfoTree;
 }
 
-std::string DebugInfo::resolveTypeName(uint32_t typeOffset, const std::unordered_map<uint32_t, DIEInfo> &dieStorage) {
-  auto it = dieStorage.find(typeOffset);
-  if (it != dieStorage.end()) {
-    const DIEInfo &typeInfo = it->second;
-
-    // For base types and typedef, return the name directly
-    if (typeInfo.tag == DebugAbbrev::Tag::DW_TAG_base_type || typeInfo.tag == DebugAbbrev::Tag::DW_TAG_typedef) {
-      return typeInfo.name;
-    }
-
-    // For pointer types, we might want to show "pointer to <type>"
-    if (typeInfo.tag == DebugAbbrev::Tag::DW_TAG_pointer_type) {
-      // This could be enhanced to follow the pointer's type reference
-      return "pointer";
-    }
-
-    // For const types
-    if (typeInfo.tag == DebugAbbrev::Tag::DW_TAG_const_type) {
-      return "const";
-    }
-
-    // For structure/class types
-    if (typeInfo.tag == DebugAbbrev::Tag::DW_TAG_structure_type || typeInfo.tag == DebugAbbrev::Tag::DW_TAG_class_type) {
-      return typeInfo.name.empty() ? "struct" : typeInfo.name;
-    }
-
-    // For array types
-    if (typeInfo.tag == DebugAbbrev::Tag::DW_TAG_array_type) {
-      return "array";
-    }
-
-    // Return the name if available, otherwise the tag type
-    if (!typeInfo.name.empty()) {
-      return typeInfo.name;
+void DebugInfo::resolvePendingReferences(std::vector<PendingReference> &pending, DIEIndex &dieIndex) {
+  std::sort(pending.begin(), pending.end(), [](PendingReference const &lhs, PendingReference const &rhs) {
+    return lhs.targetOffset < rhs.targetOffset;
+  });
+  for (size_t i = 0U; i < pending.size(); i++) {
+    // consecutive references to the same type share one lookup
+    if ((i > 0U) && (pending[i - 1U].targetOffset == pending[i].targetOffset)) {
+      pending[i].typeName = pending[i - 1U].typeName;
+    } else {
+      pending[i].typeName = resolveTypeName(pending[i].targetOffset, dieIndex);
     }
   }
+  std::sort(pending.begin(), pending.end(), [](PendingReference const &lhs, PendingReference const &rhs) {
+    return lhs.outputPosition < rhs.outputPosition;
+  });
+}
 
-  return ""; // Type not found or not resolved
-}
\ No newline at end of file
+std::string DebugInfo::resolveTypeName(uint32_t typeOffset, DIEIndex const &dieIndex) {
+  // Empty if the type is not found
+  return std::string(dieIndex.typeName(typeOffset));
+}
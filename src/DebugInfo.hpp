@@ -3,42 +3,102 @@
 #include <cassert>
 #include <cstdint>
 #include <iostream>
+#include <ostream>
 #include <sstream>
 #include <stdexcept>
 #include <string>
-#include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include "ByteReader.hpp"
+#include "DIEAttributes.hpp"
+#include "DIEIndex.hpp"
 #include "DebugAbbrev.hpp"
 #include "DebugLoc.hpp"
+#include "DwarfSections.hpp"
 #include "Tree.hpp"
 
-#include "elf.h"
-
 class DebugInfo {
 public:
-  struct DIEInfo {
-    uint32_t offset;
-    DebugAbbrev::Tag tag;
-    std::string name;
-    std::string typeName; // For base types, this stores the type name
+  using DIEInfo = DIEIndex::DIEInfo;
+
+  // A DW_AT_type reference whose name is filled in once its target has been indexed.
+  struct PendingReference {
+    uint32_t targetOffset; // section offset of the referenced DIE
+    uint32_t dieIndex;     // DIE which owns the DW_AT_type attribute
+    size_t outputPosition; // where the resolved name is inserted into the buffered unit dump
+    std::string typeName;
   };
 
 public:
-  // Template function to support both ELF32 and ELF64
-  template <typename ShdrType>
-  static void parseDebugInfo(std::vector<uint8_t> const &elfFile, const ShdrType *const debugInfoSection, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections,
-                             char const *const debugStr, DebugLoc const &debugLoc) {
-    {
-      uint8_t const *const debugInfoData = elfFile.data() + debugInfoSection->sh_offset;
-      ByteReader debugInfoReader(debugInfoData, static_cast<size_t>(debugInfoSection->sh_size));
-
-      while (!debugInfoReader.reachedEnd()) {
-        uint32_t const unit_length = debugInfoReader.getNumber<uint32_t>();
-
-        parseDebugInfoTree(debugInfoReader, debugAbbrevSections, debugStr, unit_length, std::is_same_v<ShdrType, Elf32_Shdr>, debugLoc);
+  // Dumps every unit and returns the index built on the way
+  static DIEIndex parseDebugInfo(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections, DebugLoc const &debugLoc);
+
+  // Builds the same index as parseDebugInfo without dumping anything. Units are decoded in parallel, each type signature
+  // once.
+  static DIEIndex buildDIEIndex(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections);
+
+  // Index of the given units only, e.g. the units an accelerator table pointed to
+  static DIEIndex buildDIEIndex(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections, std::vector<uint32_t> unitOffsets);
+
+  // Walks the unit headers only; firstDIE and endDIE of the result are not set. For DWARF 5 the unit DIE is scanned
+  // for the bases of the indirection tables, so that the attributes of the unit can be decoded afterwards.
+  static std::vector<DIEIndex::UnitInfo> readUnitHeaders(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections);
+  // Offsets of all units, from their unit_length alone
+  static std::vector<uint32_t> readUnitOffsets(DwarfSections const &sections);
+  static DIEIndex::UnitInfo readUnitHeader(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections, uint32_t const unitOffset);
+
+  // Attributes of the unit DIE alone, the rest of the unit is not decoded
+  static std::vector<std::pair<DebugAbbrev::AttributeName, FormValue>> readUnitDIE(DwarfSections const &sections, DIEIndex::UnitInfo const &unit, DebugAbbrev::AbbrevTable const &abbrevTable);
+
+  // Decodes the DIEs of one unit; parent indices are relative to the unit DIE. A DW_AT_type given as DW_FORM_ref_sig8
+  // is resolved through typeSignatures, names are handles of strings, the pool of the index the unit is added to.
+  static std::vector<DIEInfo> decodeUnit(DwarfSections const &sections, DIEIndex::UnitInfo const &unit, DebugAbbrev::AbbrevTable const &abbrevTable,
+                                         DIEIndex::TypeSignatures const &typeSignatures, StringPool &strings);
+
+  // Reports the DIEs of one unit to visitor as they are read, for one pass analyses which need no DIE after it has
+  // been seen. Nothing is stored, attributes are decoded only if the visitor asks for them. The events are
+  //   visitor.onUnitBegin(unit)
+  //   visitor.onDIE(offset, tag, abbrev, attributes) for every DIE in section order; a DIE with children is followed
+  //     by them and then by visitor.onChildrenEnd()
+  //   visitor.onUnitEnd(unit)
+  // attributes is a DIEAttributes, valid during the call only. The visitor is a template parameter, so that the events
+  // are inlined into the decode loop.
+  template <typename Visitor>
+  static void walkUnit(DwarfSections const &sections, DIEIndex::UnitInfo const &unit, DebugAbbrev::AbbrevTable const &abbrevTable, Visitor &visitor) {
+    DwarfSections::UnitSection const section = sections.unitSection(unit.offset);
+    ByteReader reader(section.data.data(), section.data.size());
+    reader.step((unit.offset - section.base) + unit.headerSize);
+    size_t openParents = 0U;
+    visitor.onUnitBegin(unit);
+    while ((section.base + static_cast<uint32_t>(reader.getOffset())) < unit.end) {
+      uint32_t const dieStartOffset = section.base + static_cast<uint32_t>(reader.getOffset());
+      uint64_t const abbrevIndex = reader.readLEB128(false);
+      if (abbrevIndex == 0U) {
+        // trailing padding after the unit DIE has been closed is allowed
+        if (openParents > 0U) {
+          openParents--;
+          visitor.onChildrenEnd();
+        }
+        continue;
+      }
+      DebugAbbrev::AbbrevTable::const_iterator const it = abbrevTable.find(abbrevIndex);
+      if (it == abbrevTable.end()) {
+        throw std::runtime_error("abbrevIndex not found in debugAbbrevTable");
       }
+      DebugAbbrev::AbbrevEntry const &abbrevEntry = it->second;
+      DIEAttributes const attributes(reader, abbrevEntry, unit);
+      visitor.onDIE(dieStartOffset, abbrevEntry.tag, abbrevEntry, attributes);
+      attributes.skip(reader);
+      if (abbrevEntry.hasChildren) {
+        openParents++;
+      }
+    }
+    // a unit cut short still closes every DIE it opened
+    for (; openParents > 0U; openParents--) {
+      visitor.onChildrenEnd();
     }
+    visitor.onUnitEnd(unit);
   }
 
   static const std::string vectorToStr(std::vector<uint8_t> const &vec);
@@ -55,12 +115,22 @@ public:
     return ss.str();
   }
 
-  static Tree<uint32_t> parseDebugInfoTree(ByteReader &debugInfoReader, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections, char const *const debugStr,
-                                           uint32_t const unitLength, bool const is32, DebugLoc const &debugLoc);
+  // Dumps the unit whose header has been read already into out; the reader is moved behind the unit. Every DW_AT_type
+  // is added to pendingReferences with its position in out, where the caller inserts the type name once the target is
+  // indexed.
+  static Tree<uint32_t> parseDebugInfoTree(ByteReader &debugInfoReader, DebugAbbrev::AbbrevTable const &debugAbbrevTable, DIEIndex::UnitInfo const &unit, DebugLoc const &debugLoc,
+                                           DIEIndex &dieIndex, std::ostream &out, std::vector<PendingReference> &pendingReferences);
+
+  // Resolves all references in one batch, visiting the targets in offset order. Afterwards pending is sorted by
+  // outputPosition again.
+  static void resolvePendingReferences(std::vector<PendingReference> &pending, DIEIndex &dieIndex);
 
-  static std::string resolveTypeName(uint32_t typeOffset, const std::unordered_map<uint32_t, DIEInfo> &dieStorage);
+  // typeOffset is a DIE offset, so it may point into any unit already in dieIndex
+  static std::string resolveTypeName(uint32_t typeOffset, DIEIndex const &dieIndex);
 
-private:
+  // Index of units whose headers have been read already, e.g. split units whose tables the skeleton completed
+  static DIEIndex decodeUnits(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections,
+                              std::vector<DIEIndex::UnitInfo> const &units);
 };
 
 #endif
\ No newline at end of file
@@ -4,19 +4,22 @@
 #include <cstdint>
 #include <iostream>
 #include <map>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
 #include <vector>
 #include "ByteReader.hpp"
+#include "DwarfSections.hpp"
+#include "LineTable.hpp"
 #include "elf.h"
 
 class DebugLine {
 
 public:
-  // Template function to support both ELF32 and ELF64
+  // Template function to support both ELF32 and ELF64. sections resolves the strings of DWARF 5 headers.
   template <typename ShdrType>
-  static void parseDebugLine(std::vector<uint8_t> const &elfFile, std::map<uint32_t, ShdrType> const &debugLines) {
+  static void parseDebugLine(std::span<uint8_t const> const elfFile, std::map<uint32_t, ShdrType> const &debugLines, DwarfSections const &sections) {
     for (std::pair<const unsigned int, ShdrType> const &pair : debugLines) {
       const ShdrType &hdr = pair.second;
       const uint8_t *const debugLineSectionData = elfFile.data() + hdr.sh_offset;
@@ -26,17 +29,24 @@ public:
         if (unit_length >= hdr.sh_size) {
           throw std::runtime_error("wrong unit_length");
         }
-        parseUnit(byteReader, unit_length, std::is_same_v<ShdrType, Elf32_Shdr>);
+        parseUnit(byteReader, unit_length, std::is_same_v<ShdrType, Elf32_Shdr>, sections);
       }
     }
   }
 
-  static void parseUnit(ByteReader &byteReader, uint32_t const unit_length, const bool isElf32) {
+  static void parseUnit(ByteReader &byteReader, uint32_t const unit_length, const bool isElf32, DwarfSections const &sections) {
     uint8_t const *unitStart = byteReader.cursor_;
     uint16_t const version = byteReader.getNumber<uint16_t>();
 
-    if (version != 3U) {
-      throw std::runtime_error("currently only support dwarf3");
+    if ((version < 2U) || (version > 5U)) {
+      throw std::runtime_error("currently only support dwarf2 to dwarf5");
+    }
+
+    uint8_t address_size = isElf32 ? 4U : 8U;
+    if (version >= 5U) {
+      address_size = byteReader.getNumber<uint8_t>();
+      uint8_t const segment_selector_size = byteReader.getNumber<uint8_t>();
+      static_cast<void>(segment_selector_size);
     }
 
     uint32_t const header_length = byteReader.getNumber<uint32_t>();
@@ -47,6 +57,11 @@ public:
 
     uint8_t const minimum_instruction_length = byteReader.getNumber<uint8_t>();
 
+    if (version >= 4U) {
+      uint8_t const maximum_operations_per_instruction = byteReader.getNumber<uint8_t>();
+      static_cast<void>(maximum_operations_per_instruction); // only VLIW targets use more than one
+    }
+
     uint8_t const default_is_stmt = byteReader.getNumber<uint8_t>();
     static_cast<void>(default_is_stmt);
 
@@ -66,39 +81,70 @@ public:
       standard_opcode_lengths.push_back(opCodeArgumentLength);
     }
 
-    std::vector<std::string> const include_directories = byteReader.getStringTable();
-
-    std::cout << "Include Directories:" << std::endl;
-    for (std::string const &includeDir : include_directories) {
-      std::cout << includeDir << std::endl;
-    }
-
     std::vector<std::string> fileNameTable;
+    // DWARF 5 counts files from 0, earlier versions from 1
+    uint64_t const fileBase = (version >= 5U) ? 0U : 1U;
+
+    if (version >= 5U) {
+      // a standalone unit for the entry forms, without string offsets strx is not resolvable here
+      UnitInfo lineUnit{};
+      lineUnit.version = version;
+      lineUnit.addressSize = address_size;
+      std::vector<LineTable::Entry> const directories = LineTable::readEntries(byteReader, sections, lineUnit);
+      std::cout << "Include Directories:" << "\n";
+      for (LineTable::Entry const &directory : directories) {
+        std::cout << directory.path << "\n";
+      }
+      std::vector<LineTable::Entry> const files = LineTable::readEntries(byteReader, sections, lineUnit);
+      std::cout << "file names:" << "\n";
+      for (LineTable::Entry const &fileEntry : files) {
+        std::cout << fileEntry.directoryIndex << " " << fileEntry.timestamp << " " << fileEntry.size << " " << fileEntry.path;
+        if (fileEntry.md5 != nullptr) {
+          std::cout << " md5 " << std::hex;
+          for (size_t i = 0U; i < 16U; i++) {
+            std::cout << static_cast<uint32_t>(fileEntry.md5[i] >> 4U) << static_cast<uint32_t>(fileEntry.md5[i] & 0xFU);
+          }
+          std::cout << std::dec;
+        }
+        std::cout << "\n";
+        fileNameTable.emplace_back(fileEntry.path);
+      }
+    } else {
+      std::vector<std::string> const include_directories = byteReader.getStringTable();
 
-    std::cout << "file names:" << std::endl;
-    do {
-      std::string fileName = byteReader.getString();
+      std::cout << "Include Directories:" << "\n";
+      for (std::string const &includeDir : include_directories) {
+        std::cout << includeDir << "\n";
+      }
 
-      if (!fileName.empty()) {
-        uint64_t const dirIndex = byteReader.readLEB128(false);
+      std::cout << "file names:" << "\n";
+      do {
+        std::string fileName = byteReader.getString();
 
-        uint64_t const modifyTime = byteReader.readLEB128(false);
+        if (!fileName.empty()) {
+          uint64_t const dirIndex = byteReader.readLEB128(false);
 
-        uint64_t const fileSize = byteReader.readLEB128(false);
+          uint64_t const modifyTime = byteReader.readLEB128(false);
 
-        std::cout << dirIndex << " " << modifyTime << " " << fileSize << " " << fileName << std::endl;
+          uint64_t const fileSize = byteReader.readLEB128(false);
 
-        fileNameTable.push_back(std::move(fileName));
-      } else {
-        break;
-      }
+          std::cout << dirIndex << " " << modifyTime << " " << fileSize << " " << fileName << "\n";
 
-    } while (true);
+          fileNameTable.push_back(std::move(fileName));
+        } else {
+          break;
+        }
+
+      } while (true);
+    }
+    auto const fileName = [&fileNameTable, fileBase](uint64_t const index) -> std::string {
+      return ((index < fileBase) || ((index - fileBase) >= fileNameTable.size())) ? std::string("??") : fileNameTable[index - fileBase];
+    };
 
     int32_t address = 0;
     int32_t lineNumber = 1;
     uint64_t file = 1U;
-    std::cout << "start with file " << file << " " << fileNameTable[file - 1] << std::endl;
+    std::cout << "start with file " << file << " " << fileName(file) << "\n";
     while (true) {
       ptrdiff_t const offset{byteReader.cursor_ - unitStart};
       if (offset >= unit_length - 1U) {
@@ -136,10 +182,7 @@ public:
         }
         case (StandardOpCode::DW_LNS_set_file): {
           file = byteReader.readLEB128(false);
-          // The index of file name table begin with 1, not 0. So the 1st in table is the 0st element in vector.
-          uint64_t const vectorIndex = file - 1U;
-          assert(vectorIndex < fileNameTable.size());
-          std::cout << "Set File Name to entry " << (file) << " in the File Name Table: " << fileNameTable[vectorIndex];
+          std::cout << "Set File Name to entry " << (file) << " in the File Name Table: " << fileName(file);
           break;
         }
         case (StandardOpCode::DW_LNS_set_column): {
@@ -167,17 +210,29 @@ public:
           addressIncrement = operand;
           break;
         }
+        case (StandardOpCode::DW_LNS_set_prologue_end):
         case (StandardOpCode::DW_LNS_set_epilogue_begin): {
           break;
         }
+        case (StandardOpCode::DW_LNS_set_isa): {
+          uint64_t const isa = byteReader.readLEB128(false);
+          std::cout << "set isa " << isa;
+          break;
+        }
         default: {
-
-          throw std::runtime_error("not implemented yet");
+          // opcodes of a later version, their ULEB128 operands are counted in the header
+          for (uint8_t i = 0U; i < opCodeArgumentLength; i++) {
+            static_cast<void>(byteReader.readLEB128(false));
+          }
+          break;
         }
         }
       } else { // extended opcode
         uint64_t const commandLength = byteReader.readLEB128(false);
-        static_cast<void>(commandLength);
+        if (commandLength > static_cast<uint64_t>(byteReader.end_ - byteReader.cursor_)) {
+          throw std::runtime_error("wrong extended opcode length");
+        }
+        uint8_t const *const commandEnd = byteReader.cursor_ + commandLength;
         uint8_t const subOpcode = byteReader.getNumber<uint8_t>();
         ExtendedOpCode const extendedOpCode = static_cast<ExtendedOpCode>(subOpcode);
         std::cout << "Extended opcode " << static_cast<uint32_t>(subOpcode) << ": ";
@@ -186,13 +241,13 @@ public:
           address = 0;
           lineNumber = 1;
           file = 1;
-          std::cout << "End of Sequence" << std::endl;
+          std::cout << "End of Sequence" << "\n";
           break;
         }
         case (ExtendedOpCode::DW_LNE_set_address): {
           // Handle both 32-bit and 64-bit addresses
           uint64_t newAddress;
-          if (isElf32) {
+          if (address_size == 4U) {
             // 32-bit ELF
             newAddress = byteReader.getNumber<uint32_t>();
           } else {
@@ -203,13 +258,24 @@ public:
           std::cout << "set address to " << std::hex << address;
           break;
         }
+        case (ExtendedOpCode::DW_LNE_define_file): {
+          std::string definedFile = byteReader.getString();
+          uint64_t const dirIndex = byteReader.readLEB128(false);
+          uint64_t const modifyTime = byteReader.readLEB128(false);
+          uint64_t const fileSize = byteReader.readLEB128(false);
+          std::cout << "define file " << dirIndex << " " << modifyTime << " " << fileSize << " " << definedFile;
+          fileNameTable.push_back(std::move(definedFile));
+          break;
+        }
         case (ExtendedOpCode::DW_LNE_set_discriminator): {
           uint64_t const discriminator = byteReader.readLEB128(false);
-          static_cast<void>(discriminator);
+          std::cout << "set discriminator " << discriminator;
           break;
         }
         default: {
-          throw std::runtime_error("not implemented yet");
+          // vendor opcodes, e.g. DW_LNE_HP_*, carry their length
+          byteReader.cursor_ = commandEnd;
+          break;
         }
         }
       }
@@ -223,7 +289,7 @@ public:
         lineNumber = newLineNumber;
       }
 
-      std::cout << std::endl;
+      std::cout << "\n";
     }
   }
 
@@ -1,21 +1,137 @@
 #include "DebugLoc.hpp"
-#include <iostream>
+#include <ostream>
+#include <stdexcept>
 #include "ByteReader.hpp"
 #include "VariableLocation.hpp"
 
-void DebugLoc::decodeAt(size_t const offset) const {
-  assert(offset < size_);
-  ByteReader debugLocReader(start_ + offset, size_ - offset);
+namespace {
+enum class LocationListEntry : uint8_t {
+  DW_LLE_end_of_list = 0x00,
+  DW_LLE_base_addressx = 0x01,
+  DW_LLE_startx_endx = 0x02,
+  DW_LLE_startx_length = 0x03,
+  DW_LLE_offset_pair = 0x04,
+  DW_LLE_default_location = 0x05,
+  DW_LLE_base_address = 0x06,
+  DW_LLE_start_end = 0x07,
+  DW_LLE_start_length = 0x08,
+  DW_LLE_GNU_view_pair = 0x09,
+};
+
+uint64_t readAddress(ByteReader &reader, uint8_t const addressSize) {
+  return (addressSize == 4U) ? reader.getNumber<uint32_t>() : reader.getNumber<uint64_t>();
+}
+
+void printExpression(std::ostream &out, ByteReader &reader, uint64_t const locationSize, UnitInfo const &unit) {
+  if (locationSize > static_cast<uint64_t>(reader.end_ - reader.cursor_)) {
+    throw std::runtime_error("over flow");
+  }
+  VariableLocation::handleVariableLocation(out, std::span<const uint8_t>(reader.cursor_, static_cast<size_t>(locationSize)), unit);
+  reader.step(static_cast<size_t>(locationSize));
+  out << "\n";
+}
+} // namespace
+
+void DebugLoc::decodeAt(std::ostream &out, size_t const offset, UnitInfo const &unit) const {
+  if (unit.version >= 5U) {
+    decodeLocationListsEntries(out, offset, unit);
+  } else {
+    decodeLocationList(out, offset, unit);
+  }
+}
+
+void DebugLoc::decodeLocationList(std::ostream &out, size_t const offset, UnitInfo const &unit) const {
+  if (offset >= debugLoc_.size()) {
+    throw std::runtime_error("location list offset out of .debug_loc");
+  }
+  ByteReader debugLocReader(debugLoc_.data() + offset, debugLoc_.size() - offset);
+  uint8_t const addressSize = unit.addressSize;
+  uint64_t const baseAddressSelection = (addressSize == 4U) ? 0xFFFF'FFFFU : ~static_cast<uint64_t>(0U);
   while (true) {
-    uint64_t startAddress = debugLocReader.getNumber<uint64_t>();
-    uint64_t endAddress = debugLocReader.getNumber<uint64_t>();
+    uint64_t startAddress = readAddress(debugLocReader, addressSize);
+    uint64_t endAddress = readAddress(debugLocReader, addressSize);
     if ((startAddress == 0) && (endAddress == 0)) {
       break; // End of the debug location entries
     }
-    std::cout << std::hex << "[" << startAddress << ", " << endAddress << std::dec << "):";
+    if (startAddress == baseAddressSelection) {
+      out << std::hex << "base address " << endAddress << std::dec << "\n";
+      continue;
+    }
+    out << std::hex << "[" << startAddress << ", " << endAddress << std::dec << "):";
     uint16_t const locationSize = debugLocReader.getNumber<uint16_t>();
-    VariableLocation::handleVariableLocation(std::span<const uint8_t>(debugLocReader.cursor_, locationSize));
-    debugLocReader.step(locationSize);
-    std::cout << std::endl;
+    printExpression(out, debugLocReader, locationSize, unit);
+  }
+}
+
+void DebugLoc::decodeLocationListsEntries(std::ostream &out, size_t const offset, UnitInfo const &unit) const {
+  if (offset >= debugLoclists_.size()) {
+    throw std::runtime_error("location list offset out of .debug_loclists");
+  }
+  ByteReader reader(debugLoclists_.data() + offset, debugLoclists_.size() - offset);
+  // like .debug_loc, offset pairs are printed as they are encoded, relative to the current base address
+  while (true) {
+    LocationListEntry const entry = static_cast<LocationListEntry>(reader.getNumber<uint8_t>());
+    switch (entry) {
+    case (LocationListEntry::DW_LLE_end_of_list): {
+      return;
+    }
+    case (LocationListEntry::DW_LLE_base_addressx): {
+      out << std::hex << "base address " << unit.address(reader.readLEB128(false)) << std::dec << "\n";
+      break;
+    }
+    case (LocationListEntry::DW_LLE_startx_endx): {
+      uint64_t const start = unit.address(reader.readLEB128(false));
+      uint64_t const end = unit.address(reader.readLEB128(false));
+      out << std::hex << "[" << start << ", " << end << std::dec << "):";
+      printExpression(out, reader, reader.readLEB128(false), unit);
+      break;
+    }
+    case (LocationListEntry::DW_LLE_startx_length): {
+      uint64_t const start = unit.address(reader.readLEB128(false));
+      uint64_t const length = reader.readLEB128(false);
+      out << std::hex << "[" << start << ", " << (start + length) << std::dec << "):";
+      printExpression(out, reader, reader.readLEB128(false), unit);
+      break;
+    }
+    case (LocationListEntry::DW_LLE_offset_pair): {
+      uint64_t const start = reader.readLEB128(false);
+      uint64_t const end = reader.readLEB128(false);
+      out << std::hex << "[" << start << ", " << end << std::dec << "):";
+      printExpression(out, reader, reader.readLEB128(false), unit);
+      break;
+    }
+    case (LocationListEntry::DW_LLE_default_location): {
+      out << "default:";
+      printExpression(out, reader, reader.readLEB128(false), unit);
+      break;
+    }
+    case (LocationListEntry::DW_LLE_base_address): {
+      out << std::hex << "base address " << readAddress(reader, unit.addressSize) << std::dec << "\n";
+      break;
+    }
+    case (LocationListEntry::DW_LLE_start_end): {
+      uint64_t const start = readAddress(reader, unit.addressSize);
+      uint64_t const end = readAddress(reader, unit.addressSize);
+      out << std::hex << "[" << start << ", " << end << std::dec << "):";
+      printExpression(out, reader, reader.readLEB128(false), unit);
+      break;
+    }
+    case (LocationListEntry::DW_LLE_start_length): {
+      uint64_t const start = readAddress(reader, unit.addressSize);
+      uint64_t const length = reader.readLEB128(false);
+      out << std::hex << "[" << start << ", " << (start + length) << std::dec << "):";
+      printExpression(out, reader, reader.readLEB128(false), unit);
+      break;
+    }
+    case (LocationListEntry::DW_LLE_GNU_view_pair): {
+      // location views of the following entry, no expression of its own
+      uint64_t const startView = reader.readLEB128(false);
+      out << "view pair " << startView << " " << reader.readLEB128(false) << "\n";
+      break;
+    }
+    default: {
+      throw std::runtime_error("unknown location list entry");
+    }
+    }
   }
-}
\ No newline at end of file
+}
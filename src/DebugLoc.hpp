@@ -1,22 +1,27 @@
 #ifndef DEBUG_LOC_HPP
 #define DEBUG_LOC_HPP
 
+#include <cstddef>
 #include <cstdint>
-#include <vector>
+#include <ostream>
+#include <span>
+#include "DwarfSections.hpp"
+#include "UnitInfo.hpp"
 
 class DebugLoc {
 public:
-  DebugLoc() : start_(nullptr), size_(0) {
-  }
-  template <typename ShdrType>
-  DebugLoc(std::vector<uint8_t> const &elfFile, const ShdrType *const debugLocSection) : start_(elfFile.data() + debugLocSection->sh_offset), size_(debugLocSection->sh_size) {
+  explicit DebugLoc(DwarfSections const &sections) : debugLoc_(sections.debugLoc), debugLoclists_(sections.debugLoclists) {
   }
 
-  void decodeAt(size_t const offset) const;
+  // Prints the location list at offset to out, from .debug_loc up to DWARF 4 and from .debug_loclists since DWARF 5
+  void decodeAt(std::ostream &out, size_t const offset, UnitInfo const &unit) const;
 
 private:
-  uint8_t const *start_;
-  size_t size_;
+  void decodeLocationList(std::ostream &out, size_t const offset, UnitInfo const &unit) const;
+  void decodeLocationListsEntries(std::ostream &out, size_t const offset, UnitInfo const &unit) const;
+
+  std::span<uint8_t const> debugLoc_;
+  std::span<uint8_t const> debugLoclists_;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,22 @@
+#include "DwarfSections.hpp"
+
+std::string_view DwarfSections::string(FormValue const &formValue) const noexcept {
+  switch (formValue.form) {
+  case (DebugAbbrev::Form::DW_FORM_strp): {
+    return (debugStr == nullptr) ? std::string_view() : std::string_view(debugStr + formValue.value);
+  }
+  case (DebugAbbrev::Form::DW_FORM_GNU_strp_alt):
+  case (DebugAbbrev::Form::DW_FORM_strp_sup): {
+    return (altDebugStr == nullptr) ? std::string_view() : std::string_view(altDebugStr + formValue.value);
+  }
+  case (DebugAbbrev::Form::DW_FORM_line_strp): {
+    return (debugLineStr == nullptr) ? std::string_view() : std::string_view(debugLineStr + formValue.value);
+  }
+  case (DebugAbbrev::Form::DW_FORM_string): {
+    return std::string_view(reinterpret_cast<char const *>(formValue.data), static_cast<size_t>(formValue.size));
+  }
+  default: {
+    return std::string_view();
+  }
+  }
+}
@@ -0,0 +1,73 @@
+#ifndef DWARF_SECTIONS_HPP
+#define DWARF_SECTIONS_HPP
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include "FormValue.hpp"
+
+// The debug sections of one object file. Everything decoded from them points into the file contents, which must
+// outlive every user. Missing sections are empty spans or nullptr.
+struct DwarfSections {
+  std::span<uint8_t const> debugInfo;
+  std::span<uint8_t const> debugTypes;         // DWARF 4 type units, -fdebug-types-section
+  char const *debugStr = nullptr;
+  char const *debugLineStr = nullptr;          // DWARF 5 DW_FORM_line_strp
+  std::span<uint8_t const> debugStrOffsets;    // DWARF 5 DW_FORM_strx
+  std::span<uint8_t const> debugAddr;          // DWARF 5 DW_FORM_addrx
+  std::span<uint8_t const> debugLine;
+  std::span<uint8_t const> debugRanges;        // up to DWARF 4
+  std::span<uint8_t const> debugRnglists;      // DWARF 5
+  std::span<uint8_t const> debugLoc;           // up to DWARF 4
+  std::span<uint8_t const> debugLoclists;      // DWARF 5
+  std::span<uint8_t const> debugAranges;
+
+  // The supplementary file of a binary processed by dwz, see SupplementaryFile. Its units reference each other with
+  // DW_FORM_ref_addr and their strings with DW_FORM_strp; units of the binary point into it with DW_FORM_GNU_ref_alt
+  // and DW_FORM_GNU_strp_alt, or the DWARF 5 DW_FORM_ref_sup4/8 and DW_FORM_strp_sup.
+  std::span<uint8_t const> altDebugInfo;
+  char const *altDebugStr = nullptr;
+  uint32_t altAbbrevBase = 0U; // the abbreviation tables of the file are keyed by their offset plus this
+
+  // The units of .debug_types are numbered behind .debug_info, and those of the supplementary file behind both, so that
+  // the DIEs of all sections share one offset space and one DIEIndex. A DIE offset maps to the section holding it and
+  // the DIE offset of that section's first byte.
+  struct UnitSection {
+    std::span<uint8_t const> data;
+    uint32_t base;
+  };
+
+  inline bool inDebugInfo(uint32_t const offset) const noexcept {
+    return offset < debugInfo.size();
+  }
+
+  inline bool inDebugTypes(uint32_t const offset) const noexcept {
+    return !inDebugInfo(offset) && !inAltFile(offset);
+  }
+
+  // DIE offset of the first byte of the supplementary .debug_info
+  inline uint32_t altBase() const noexcept {
+    return static_cast<uint32_t>(debugInfo.size() + debugTypes.size());
+  }
+
+  inline bool inAltFile(uint32_t const offset) const noexcept {
+    return offset >= altBase();
+  }
+
+  inline UnitSection unitSection(uint32_t const offset) const noexcept {
+    if (inDebugInfo(offset)) {
+      return UnitSection{debugInfo, 0U};
+    }
+    return inAltFile(offset) ? UnitSection{altDebugInfo, altBase()} : UnitSection{debugTypes, static_cast<uint32_t>(debugInfo.size())};
+  }
+
+  // One past the last DIE offset of all sections
+  inline uint32_t unitsEnd() const noexcept {
+    return static_cast<uint32_t>(altBase() + altDebugInfo.size());
+  }
+
+  // Value of a string form; strx has been resolved to a .debug_str offset by FormValue::read. Empty for other forms,
+  // and for DW_FORM_GNU_strp_alt and DW_FORM_strp_sup without a supplementary file.
+  std::string_view string(FormValue const &formValue) const noexcept;
+};
+
+#endif
@@ -0,0 +1,85 @@
+#include "ElfFile.hpp"
+#include <cstring>
+#include "elf.h"
+
+namespace {
+template <typename EhdrType, typename ShdrType>
+void collectSections(std::span<uint8_t const> const bytes, std::unordered_map<std::string_view, std::span<uint8_t const>> &sections) {
+  if (bytes.size() < sizeof(EhdrType)) {
+    return;
+  }
+  EhdrType header;
+  memcpy(&header, bytes.data(), sizeof(header));
+  if ((header.e_shentsize != sizeof(ShdrType)) || (header.e_shstrndx >= header.e_shnum) || (header.e_shoff > bytes.size()) ||
+      (header.e_shnum > ((bytes.size() - header.e_shoff) / sizeof(ShdrType)))) {
+    return;
+  }
+  auto const sectionHeader = [&bytes, &header](uint32_t const index) {
+    ShdrType result;
+    memcpy(&result, bytes.data() + header.e_shoff + (index * sizeof(ShdrType)), sizeof(result));
+    return result;
+  };
+  auto const inFile = [&bytes](ShdrType const &section) {
+    return (section.sh_offset <= bytes.size()) && (section.sh_size <= (bytes.size() - section.sh_offset));
+  };
+
+  ShdrType const names = sectionHeader(header.e_shstrndx);
+  if (!inFile(names)) {
+    return;
+  }
+  std::span<uint8_t const> const nameTable = bytes.subspan(static_cast<size_t>(names.sh_offset), static_cast<size_t>(names.sh_size));
+  for (uint32_t i = 0U; i < header.e_shnum; i++) {
+    ShdrType const section = sectionHeader(i);
+    // compressed sections are not supported, they are left out as if missing
+    if ((section.sh_type == SHT_NOBITS) || ((section.sh_flags & SHF_COMPRESSED) != 0U) || (section.sh_name >= nameTable.size()) || !inFile(section)) {
+      continue;
+    }
+    char const *const name = reinterpret_cast<char const *>(nameTable.data() + section.sh_name);
+    void const *const terminator = memchr(name, 0, nameTable.size() - section.sh_name);
+    if (terminator == nullptr) {
+      continue;
+    }
+    sections.emplace(std::string_view(name, static_cast<size_t>(static_cast<char const *>(terminator) - name)),
+                     bytes.subspan(static_cast<size_t>(section.sh_offset), static_cast<size_t>(section.sh_size)));
+  }
+}
+} // namespace
+
+std::optional<ElfFile> ElfFile::open(std::string const &path) {
+  ElfFile file;
+  file.mapping_ = MappedFile::open(path);
+  std::span<uint8_t const> const bytes = file.mapping_.bytes();
+  if ((bytes.size() < EI_NIDENT) || (bytes[EI_MAG0] != ELFMAG0) || (bytes[EI_MAG1] != ELFMAG1) || (bytes[EI_MAG2] != ELFMAG2) || (bytes[EI_MAG3] != ELFMAG3)) {
+    return std::nullopt;
+  }
+  if (bytes[EI_CLASS] == ELFCLASS32) {
+    collectSections<Elf32_Ehdr, Elf32_Shdr>(bytes, file.sections_);
+  } else if (bytes[EI_CLASS] == ELFCLASS64) {
+    collectSections<Elf64_Ehdr, Elf64_Shdr>(bytes, file.sections_);
+  }
+  return file;
+}
+
+std::span<uint8_t const> ElfFile::section(std::string_view const name) const noexcept {
+  std::unordered_map<std::string_view, std::span<uint8_t const>>::const_iterator const it = sections_.find(name);
+  return (it == sections_.end()) ? std::span<uint8_t const>() : it->second;
+}
+
+std::span<uint8_t const> ElfFile::buildId() const noexcept {
+  // name and descriptor of a note are padded to 4 bytes, in ELF32 and ELF64 alike
+  std::span<uint8_t const> notes = section(".note.gnu.build-id");
+  while (notes.size() >= sizeof(Elf32_Nhdr)) {
+    Elf32_Nhdr note;
+    memcpy(&note, notes.data(), sizeof(note));
+    size_t const nameSize = (static_cast<size_t>(note.n_namesz) + 3U) & ~static_cast<size_t>(3U);
+    size_t const descriptorSize = (static_cast<size_t>(note.n_descsz) + 3U) & ~static_cast<size_t>(3U);
+    if ((nameSize > (notes.size() - sizeof(note))) || (descriptorSize > (notes.size() - sizeof(note) - nameSize))) {
+      break;
+    }
+    if ((note.n_type == NT_GNU_BUILD_ID) && (note.n_namesz == 4U) && (memcmp(notes.data() + sizeof(note), "GNU", 4U) == 0)) {
+      return notes.subspan(sizeof(note) + nameSize, note.n_descsz);
+    }
+    notes = notes.subspan(sizeof(note) + nameSize + descriptorSize);
+  }
+  return std::span<uint8_t const>();
+}
@@ -0,0 +1,29 @@
+#ifndef ELF_FILE_HPP
+#define ELF_FILE_HPP
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "MappedFile.hpp"
+
+// A mapped ELF file other than the binary itself, which debug info refers to: a .dwo file, a .dwp package or the
+// supplementary file of dwz. Only the section headers are read on open, the sections are looked up by name.
+class ElfFile {
+public:
+  // nullopt if the file is missing or not an ELF file
+  static std::optional<ElfFile> open(std::string const &path);
+
+  // Empty if the file has no such section. Compressed sections are left out as if missing.
+  std::span<uint8_t const> section(std::string_view const name) const noexcept;
+
+  // Descriptor of the NT_GNU_BUILD_ID note in .note.gnu.build-id, empty if there is none
+  std::span<uint8_t const> buildId() const noexcept;
+
+private:
+  MappedFile mapping_;
+  std::unordered_map<std::string_view, std::span<uint8_t const>> sections_;
+};
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef ELF_WRITER_HPP
+#define ELF_WRITER_HPP
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "elf.h"
+
+class ElfWriter {
+public:
+  struct Section {
+    std::string name;
+    std::span<uint8_t const> data;
+  };
+
+  // Copy of the ELF file with the given non-alloc sections added, or replacing the sections of the same name.
+  // Nothing already in the file moves: the new contents, a new .shstrtab if names were added and a new section header
+  // table are appended at the end, and the old headers and contents are left behind unreferenced. Program headers are
+  // untouched, so this is only meant for sections which are not loaded, like debug info.
+  template <typename EhdrType, typename ShdrType>
+  static std::vector<uint8_t> withSections(std::span<uint8_t const> const elfFile, std::vector<Section> const &sections) {
+    std::vector<uint8_t> out(elfFile.begin(), elfFile.end());
+    EhdrType elfHeader;
+    memcpy(&elfHeader, elfFile.data(), sizeof(EhdrType));
+    if (elfHeader.e_shstrndx >= elfHeader.e_shnum) {
+      throw std::runtime_error("no section name table");
+    }
+
+    std::vector<ShdrType> sectionHeaders(elfHeader.e_shnum);
+    memcpy(sectionHeaders.data(), elfFile.data() + elfHeader.e_shoff, sizeof(ShdrType) * sectionHeaders.size());
+    ShdrType const &nameTableHeader = sectionHeaders[elfHeader.e_shstrndx];
+    std::vector<uint8_t> nameTable(elfFile.data() + nameTableHeader.sh_offset, elfFile.data() + nameTableHeader.sh_offset + nameTableHeader.sh_size);
+    bool namesAdded = false;
+
+    for (Section const &section : sections) {
+      size_t headerIndex = 0U;
+      while ((headerIndex < sectionHeaders.size()) && (section.name != (reinterpret_cast<char const *>(nameTable.data()) + sectionHeaders[headerIndex].sh_name))) {
+        headerIndex++;
+      }
+      if (headerIndex == sectionHeaders.size()) {
+        ShdrType header{};
+        header.sh_name = static_cast<decltype(header.sh_name)>(nameTable.size());
+        header.sh_type = SHT_PROGBITS;
+        header.sh_addralign = 1U;
+        nameTable.insert(nameTable.end(), section.name.begin(), section.name.end());
+        nameTable.push_back(0U);
+        namesAdded = true;
+        sectionHeaders.push_back(header);
+      }
+      ShdrType &header = sectionHeaders[headerIndex];
+      header.sh_offset = static_cast<decltype(header.sh_offset)>(appendAligned(out, section.data));
+      header.sh_size = static_cast<decltype(header.sh_size)>(section.data.size());
+    }
+
+    if (namesAdded) {
+      ShdrType &header = sectionHeaders[elfHeader.e_shstrndx];
+      header.sh_offset = static_cast<decltype(header.sh_offset)>(appendAligned(out, nameTable));
+      header.sh_size = static_cast<decltype(header.sh_size)>(nameTable.size());
+    }
+
+    if (sectionHeaders.size() >= SHN_LORESERVE) {
+      throw std::runtime_error("too many sections");
+    }
+    elfHeader.e_shoff = static_cast<decltype(elfHeader.e_shoff)>(appendAligned(out, std::span<uint8_t const>(reinterpret_cast<uint8_t const *>(sectionHeaders.data()),
+                                                                                                             sizeof(ShdrType) * sectionHeaders.size())));
+    elfHeader.e_shnum = static_cast<decltype(elfHeader.e_shnum)>(sectionHeaders.size());
+    memcpy(out.data(), &elfHeader, sizeof(EhdrType));
+    return out;
+  }
+
+private:
+  // Appends data at the next 8 byte boundary and returns its file offset
+  static size_t appendAligned(std::vector<uint8_t> &out, std::span<uint8_t const> const data) {
+    out.resize((out.size() + 7U) & ~static_cast<size_t>(7U), 0U);
+    size_t const offset = out.size();
+    out.insert(out.end(), data.begin(), data.end());
+    return offset;
+  }
+};
+
+#endif
@@ -0,0 +1,389 @@
+#include "FormValue.hpp"
+#include <cstring>
+
+namespace {
+void stepChecked(ByteReader &reader, uint64_t const bytes) {
+  if (bytes > static_cast<uint64_t>(reader.end_ - reader.cursor_)) {
+    throw std::runtime_error("over flow");
+  }
+  reader.step(static_cast<size_t>(bytes));
+}
+
+void skipLEB128(ByteReader &reader) {
+  while ((reader.getNumber<uint8_t>() & 0x80U) != 0U) {
+  }
+}
+
+uint64_t readUnsigned(ByteReader &reader, uint32_t const bytes) {
+  uint64_t value = 0U;
+  for (uint32_t i = 0U; i < bytes; i++) {
+    value |= static_cast<uint64_t>(reader.getNumber<uint8_t>()) << (8U * i);
+  }
+  return value;
+}
+
+// Encoded byte count of the index of strx1..4 and addrx1..4, 0 for the ULEB128 encoded strx, addrx and their GNU forms
+uint32_t indexSize(DebugAbbrev::Form const form) noexcept {
+  switch (form) {
+  case (DebugAbbrev::Form::DW_FORM_strx1):
+  case (DebugAbbrev::Form::DW_FORM_addrx1): {
+    return 1U;
+  }
+  case (DebugAbbrev::Form::DW_FORM_strx2):
+  case (DebugAbbrev::Form::DW_FORM_addrx2): {
+    return 2U;
+  }
+  case (DebugAbbrev::Form::DW_FORM_strx3):
+  case (DebugAbbrev::Form::DW_FORM_addrx3): {
+    return 3U;
+  }
+  case (DebugAbbrev::Form::DW_FORM_strx4):
+  case (DebugAbbrev::Form::DW_FORM_addrx4): {
+    return 4U;
+  }
+  default: {
+    return 0U;
+  }
+  }
+}
+} // namespace
+
+FormValue FormValue::read(ByteReader &reader, DebugAbbrev::AttributeSpecification const &specification, UnitInfo const &unit) {
+  DebugAbbrev::Form const form = specification.form;
+  uint64_t const unitOffset = unit.offset;
+  FormValue formValue{form, 0U, nullptr, 0U};
+  switch (form) {
+  case (DebugAbbrev::Form::DW_FORM_addr): {
+    if (unit.addressSize == 4U) {
+      formValue.value = reader.getNumber<uint32_t>();
+    } else {
+      formValue.value = reader.getNumber<uint64_t>();
+    }
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_block1): {
+    formValue.size = reader.getNumber<uint8_t>();
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_block2): {
+    formValue.size = reader.getNumber<uint16_t>();
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_block4): {
+    formValue.size = reader.getNumber<uint32_t>();
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_block):
+  case (DebugAbbrev::Form::DW_FORM_exprloc): {
+    formValue.size = reader.readLEB128(false);
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_data1):
+  case (DebugAbbrev::Form::DW_FORM_flag): {
+    formValue.value = reader.getNumber<uint8_t>();
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_data2): {
+    formValue.value = reader.getNumber<uint16_t>();
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_flag_present): {
+    // the flag is implied by the abbreviation, nothing is stored
+    formValue.value = 1U;
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_data4):
+  case (DebugAbbrev::Form::DW_FORM_line_strp):
+  case (DebugAbbrev::Form::DW_FORM_strp_sup):
+  case (DebugAbbrev::Form::DW_FORM_GNU_strp_alt):
+  case (DebugAbbrev::Form::DW_FORM_sec_offset): {
+    formValue.value = reader.getNumber<uint32_t>();
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_strp): {
+    formValue.value = reader.getNumber<uint32_t>();
+    if (unit.inAltFile) {
+      formValue.form = DebugAbbrev::Form::DW_FORM_GNU_strp_alt;
+    }
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_GNU_ref_alt):
+  case (DebugAbbrev::Form::DW_FORM_ref_sup4): {
+    formValue.value = unit.altBase + static_cast<uint64_t>(reader.getNumber<uint32_t>());
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_ref_sup8): {
+    formValue.value = unit.altBase + reader.getNumber<uint64_t>();
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_data8):
+  case (DebugAbbrev::Form::DW_FORM_ref_sig8): {
+    formValue.value = reader.getNumber<uint64_t>();
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_data16): {
+    formValue.data = reader.cursor_;
+    formValue.size = 16U;
+    stepChecked(reader, 16U);
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_implicit_const): {
+    formValue.value = static_cast<uint64_t>(specification.implicitConst);
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_strx):
+  case (DebugAbbrev::Form::DW_FORM_strx1):
+  case (DebugAbbrev::Form::DW_FORM_strx2):
+  case (DebugAbbrev::Form::DW_FORM_strx3):
+  case (DebugAbbrev::Form::DW_FORM_strx4):
+  case (DebugAbbrev::Form::DW_FORM_GNU_str_index): {
+    uint32_t const bytes = indexSize(form);
+    uint64_t const index = (bytes == 0U) ? reader.readLEB128(false) : readUnsigned(reader, bytes);
+    formValue.form = DebugAbbrev::Form::DW_FORM_strp;
+    formValue.value = unit.stringOffset(index);
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_addrx):
+  case (DebugAbbrev::Form::DW_FORM_addrx1):
+  case (DebugAbbrev::Form::DW_FORM_addrx2):
+  case (DebugAbbrev::Form::DW_FORM_addrx3):
+  case (DebugAbbrev::Form::DW_FORM_addrx4):
+  case (DebugAbbrev::Form::DW_FORM_GNU_addr_index): {
+    uint32_t const bytes = indexSize(form);
+    uint64_t const index = (bytes == 0U) ? reader.readLEB128(false) : readUnsigned(reader, bytes);
+    formValue.form = DebugAbbrev::Form::DW_FORM_addr;
+    formValue.value = unit.address(index);
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_rnglistx): {
+    formValue.form = DebugAbbrev::Form::DW_FORM_sec_offset;
+    formValue.value = unit.rangeList(reader.readLEB128(false));
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_loclistx): {
+    formValue.form = DebugAbbrev::Form::DW_FORM_sec_offset;
+    formValue.value = unit.locationList(reader.readLEB128(false));
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_sdata): {
+    formValue.value = reader.readLEB128(true);
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_udata): {
+    formValue.value = reader.readLEB128(false);
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_string): {
+    formValue.data = reader.cursor_;
+    while (reader.getNumber<uint8_t>() != 0U) {
+    }
+    formValue.size = static_cast<uint64_t>(reader.cursor_ - formValue.data - 1);
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_ref1): {
+    formValue.value = unitOffset + static_cast<uint64_t>(reader.getNumber<uint8_t>());
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_ref2): {
+    formValue.value = unitOffset + static_cast<uint64_t>(reader.getNumber<uint16_t>());
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_ref4): {
+    formValue.value = unitOffset + static_cast<uint64_t>(reader.getNumber<uint32_t>());
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_ref8): {
+    formValue.value = unitOffset + reader.getNumber<uint64_t>();
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_ref_udata): {
+    formValue.value = unitOffset + reader.readLEB128(false);
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_ref_addr): {
+    // DWARF2 encodes ref_addr with the address size, later versions with the offset size
+    if ((unit.version <= 2U) && (unit.addressSize == 8U)) {
+      formValue.value = reader.getNumber<uint64_t>();
+    } else {
+      formValue.value = reader.getNumber<uint32_t>();
+    }
+    if (unit.inAltFile) {
+      formValue.value += unit.altBase;
+    }
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_indirect): {
+    DebugAbbrev::AttributeSpecification const actual{specification.attributeName, static_cast<DebugAbbrev::Form>(reader.readLEB128(false)), 0};
+    return read(reader, actual, unit);
+  }
+  default: {
+    throw std::runtime_error("not implemented yet");
+  }
+  }
+
+  if (formValue.isBlock()) {
+    formValue.data = reader.cursor_;
+    if (formValue.size > static_cast<uint64_t>(reader.end_ - reader.cursor_)) {
+      throw std::runtime_error("over flow");
+    }
+    reader.step(static_cast<size_t>(formValue.size));
+  }
+  return formValue;
+}
+
+void FormValue::skip(ByteReader &reader, DebugAbbrev::Form const form, UnitInfo const &unit) {
+  switch (form) {
+  case (DebugAbbrev::Form::DW_FORM_flag_present):
+  case (DebugAbbrev::Form::DW_FORM_implicit_const): {
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_data1):
+  case (DebugAbbrev::Form::DW_FORM_flag):
+  case (DebugAbbrev::Form::DW_FORM_ref1):
+  case (DebugAbbrev::Form::DW_FORM_strx1):
+  case (DebugAbbrev::Form::DW_FORM_addrx1): {
+    stepChecked(reader, 1U);
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_data2):
+  case (DebugAbbrev::Form::DW_FORM_ref2):
+  case (DebugAbbrev::Form::DW_FORM_strx2):
+  case (DebugAbbrev::Form::DW_FORM_addrx2): {
+    stepChecked(reader, 2U);
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_strx3):
+  case (DebugAbbrev::Form::DW_FORM_addrx3): {
+    stepChecked(reader, 3U);
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_data4):
+  case (DebugAbbrev::Form::DW_FORM_ref4):
+  case (DebugAbbrev::Form::DW_FORM_strp):
+  case (DebugAbbrev::Form::DW_FORM_line_strp):
+  case (DebugAbbrev::Form::DW_FORM_strp_sup):
+  case (DebugAbbrev::Form::DW_FORM_ref_sup4):
+  case (DebugAbbrev::Form::DW_FORM_GNU_ref_alt):
+  case (DebugAbbrev::Form::DW_FORM_GNU_strp_alt):
+  case (DebugAbbrev::Form::DW_FORM_strx4):
+  case (DebugAbbrev::Form::DW_FORM_addrx4):
+  case (DebugAbbrev::Form::DW_FORM_sec_offset): {
+    stepChecked(reader, 4U);
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_data8):
+  case (DebugAbbrev::Form::DW_FORM_ref8):
+  case (DebugAbbrev::Form::DW_FORM_ref_sup8):
+  case (DebugAbbrev::Form::DW_FORM_ref_sig8): {
+    stepChecked(reader, 8U);
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_data16): {
+    stepChecked(reader, 16U);
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_addr): {
+    stepChecked(reader, unit.addressSize);
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_ref_addr): {
+    stepChecked(reader, ((unit.version <= 2U) && (unit.addressSize == 8U)) ? 8U : 4U);
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_sdata):
+  case (DebugAbbrev::Form::DW_FORM_udata):
+  case (DebugAbbrev::Form::DW_FORM_ref_udata):
+  case (DebugAbbrev::Form::DW_FORM_strx):
+  case (DebugAbbrev::Form::DW_FORM_addrx):
+  case (DebugAbbrev::Form::DW_FORM_rnglistx):
+  case (DebugAbbrev::Form::DW_FORM_loclistx):
+  case (DebugAbbrev::Form::DW_FORM_GNU_addr_index):
+  case (DebugAbbrev::Form::DW_FORM_GNU_str_index): {
+    skipLEB128(reader);
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_string): {
+    void const *const terminator = memchr(reader.cursor_, 0, static_cast<size_t>(reader.end_ - reader.cursor_));
+    if (terminator == nullptr) {
+      throw std::runtime_error("over flow");
+    }
+    reader.cursor_ = static_cast<uint8_t const *>(terminator) + 1;
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_block1): {
+    stepChecked(reader, reader.getNumber<uint8_t>());
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_block2): {
+    stepChecked(reader, reader.getNumber<uint16_t>());
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_block4): {
+    stepChecked(reader, reader.getNumber<uint32_t>());
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_block):
+  case (DebugAbbrev::Form::DW_FORM_exprloc): {
+    stepChecked(reader, reader.readLEB128(false));
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_indirect): {
+    skip(reader, static_cast<DebugAbbrev::Form>(reader.readLEB128(false)), unit);
+    break;
+  }
+  default: {
+    throw std::runtime_error("not implemented yet");
+  }
+  }
+}
+
+bool FormValue::isReference() const noexcept {
+  switch (form) {
+  case (DebugAbbrev::Form::DW_FORM_ref1):
+  case (DebugAbbrev::Form::DW_FORM_ref2):
+  case (DebugAbbrev::Form::DW_FORM_ref4):
+  case (DebugAbbrev::Form::DW_FORM_ref8):
+  case (DebugAbbrev::Form::DW_FORM_ref_udata):
+  case (DebugAbbrev::Form::DW_FORM_ref_addr):
+  case (DebugAbbrev::Form::DW_FORM_GNU_ref_alt):
+  case (DebugAbbrev::Form::DW_FORM_ref_sup4):
+  case (DebugAbbrev::Form::DW_FORM_ref_sup8): {
+    return true;
+  }
+  default: {
+    return false;
+  }
+  }
+}
+
+bool FormValue::isBlock() const noexcept {
+  switch (form) {
+  case (DebugAbbrev::Form::DW_FORM_block1):
+  case (DebugAbbrev::Form::DW_FORM_block2):
+  case (DebugAbbrev::Form::DW_FORM_block4):
+  case (DebugAbbrev::Form::DW_FORM_block):
+  case (DebugAbbrev::Form::DW_FORM_exprloc): {
+    return true;
+  }
+  default: {
+    return false;
+  }
+  }
+}
+
+bool FormValue::isConstant() const noexcept {
+  switch (form) {
+  case (DebugAbbrev::Form::DW_FORM_data1):
+  case (DebugAbbrev::Form::DW_FORM_data2):
+  case (DebugAbbrev::Form::DW_FORM_data4):
+  case (DebugAbbrev::Form::DW_FORM_data8):
+  case (DebugAbbrev::Form::DW_FORM_sdata):
+  case (DebugAbbrev::Form::DW_FORM_udata):
+  case (DebugAbbrev::Form::DW_FORM_implicit_const): {
+    return true;
+  }
+  default: {
+    return false;
+  }
+  }
+}
@@ -0,0 +1,33 @@
+#ifndef FORM_VALUE_HPP
+#define FORM_VALUE_HPP
+#include <cstdint>
+#include "ByteReader.hpp"
+#include "DebugAbbrev.hpp"
+#include "UnitInfo.hpp"
+
+// One decoded attribute value. Nothing is copied: blocks and inline strings point into the section data.
+struct FormValue {
+  DebugAbbrev::Form form;
+  uint64_t value;      // constant, flag, address, section offset, .debug_info offset of a reference, or type signature
+  uint8_t const *data; // block content, DW_FORM_data16 bytes or DW_FORM_string characters
+  uint64_t size;       // block length
+
+  // References of the ref1..ref_udata class are rebased onto the unit offset, so value is always a DIE offset.
+  // References into the supplementary file of dwz, and DW_FORM_ref_addr inside it, are rebased onto
+  // DwarfSections::altBase; DW_FORM_strp of its units becomes DW_FORM_GNU_strp_alt.
+  // DW_FORM_ref_sig8 is not a reference in that sense, its value is the signature of a type unit.
+  // The DWARF 5 indirections are resolved through the tables of the unit: strx yields a DW_FORM_strp value, addrx a
+  // DW_FORM_addr value, rnglistx and loclistx a DW_FORM_sec_offset value. DW_FORM_GNU_str_index and
+  // DW_FORM_GNU_addr_index of split DWARF 4 units are strx and addrx under another name. implicit_const takes its value
+  // from the abbreviation.
+  static FormValue read(ByteReader &reader, DebugAbbrev::AttributeSpecification const &specification, UnitInfo const &unit);
+
+  // Moves the reader behind a value without decoding it, for the attributes a caller is not interested in
+  static void skip(ByteReader &reader, DebugAbbrev::Form const form, UnitInfo const &unit);
+
+  bool isReference() const noexcept;
+  bool isBlock() const noexcept; // block1..block and exprloc, data and size describe the bytes
+  bool isConstant() const noexcept;
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "FunctionIndex.hpp"
+#include <algorithm>
+#include "DIEIndex.hpp"
+#include "Parallel.hpp"
+#include "RangeList.hpp"
+
+void FunctionIndex::collect(DIEIndex const &dieIndex, UnitInfo const &unit, bool const withInlined, std::vector<Range> &ranges) {
+  for (uint32_t i = unit.firstDIE; i < unit.endDIE; i++) {
+    DebugAbbrev::Tag const tag = dieIndex.at(i).tag;
+    if ((tag != DebugAbbrev::Tag::DW_TAG_subprogram) && (!withInlined || (tag != DebugAbbrev::Tag::DW_TAG_inlined_subroutine))) {
+      continue;
+    }
+    for (RangeList::Range const &range : RangeList::ofDIE(dieIndex, i)) {
+      ranges.push_back(Range{range.low, range.high, i});
+    }
+  }
+}
+
+FunctionIndex FunctionIndex::build(DIEIndex const &dieIndex, bool const withInlined) {
+  std::vector<DIEIndex::UnitInfo> const &units = dieIndex.units();
+  std::vector<std::vector<Range>> unitRanges(units.size());
+  Parallel::forEach(units.size(), [&](size_t const unitIndex, size_t) {
+    collect(dieIndex, units[unitIndex], withInlined, unitRanges[unitIndex]);
+  });
+
+  std::vector<Range> ranges;
+  for (std::vector<Range> const &unitRange : unitRanges) {
+    ranges.insert(ranges.end(), unitRange.begin(), unitRange.end());
+  }
+  return fromRanges(std::move(ranges));
+}
+
+FunctionIndex FunctionIndex::build(DIEIndex const &dieIndex, uint32_t const unitIndex, bool const withInlined) {
+  std::vector<Range> ranges;
+  collect(dieIndex, dieIndex.units()[unitIndex], withInlined, ranges);
+  return fromRanges(std::move(ranges));
+}
+
+FunctionIndex FunctionIndex::fromRanges(std::vector<Range> &&ranges) {
+  // outer ranges before the ranges they contain; of two equal ranges the later DIE counts as the inner one, which is
+  // right for an inlined instance covering all of its caller
+  std::sort(ranges.begin(), ranges.end(), [](Range const &lhs, Range const &rhs) {
+    if (lhs.low != rhs.low) {
+      return lhs.low < rhs.low;
+    }
+    return (lhs.high != rhs.high) ? (lhs.high > rhs.high) : (lhs.function < rhs.function);
+  });
+
+  // sweep: the open range started last is the innermost one
+  std::vector<Range> segments;
+  std::vector<Range> open;
+  uint64_t cursor = 0U;
+  auto const emitUntil = [&](uint64_t const position) {
+    while ((cursor < position) && !open.empty()) {
+      Range const &innermost = open.back();
+      if (innermost.high <= cursor) {
+        open.pop_back();
+        continue;
+      }
+      uint64_t const end = std::min(innermost.high, position);
+      if (!segments.empty() && (segments.back().high == cursor) && (segments.back().function == innermost.function)) {
+        segments.back().high = end;
+      } else {
+        segments.push_back(Range{cursor, end, innermost.function});
+      }
+      cursor = end;
+    }
+    cursor = std::max(cursor, position);
+  };
+  for (Range const &range : ranges) {
+    emitUntil(range.low);
+    open.push_back(range);
+  }
+  emitUntil(UINT64_MAX);
+
+  FunctionIndex functionIndex;
+  functionIndex.layout(segments);
+  return functionIndex;
+}
+
+void FunctionIndex::layout(std::vector<Range> const &segments) {
+  starts_.assign(segments.size() + 1U, 0U);
+  ranks_.assign(segments.size() + 1U, 0U);
+  size_t next = 0U;
+  fill(segments, next, 1U);
+  lows_.reserve(segments.size());
+  ends_.reserve(segments.size());
+  functions_.reserve(segments.size());
+  for (Range const &segment : segments) {
+    lows_.push_back(segment.low);
+    ends_.push_back(segment.high);
+    functions_.push_back(segment.function);
+  }
+}
+
+void FunctionIndex::fill(std::vector<Range> const &segments, size_t &next, size_t const k) {
+  // in-order traversal of the implicit tree visits the slots in sorted order
+  if (k >= starts_.size()) {
+    return;
+  }
+  fill(segments, next, 2U * k);
+  starts_[k] = segments[next].low;
+  ranks_[k] = static_cast<uint32_t>(next);
+  next++;
+  fill(segments, next, (2U * k) + 1U);
+}
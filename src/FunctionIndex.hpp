@@ -0,0 +1,80 @@
+#ifndef FUNCTION_INDEX_HPP
+#define FUNCTION_INDEX_HPP
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "UnitInfo.hpp"
+
+class DIEIndex;
+
+// Maps code addresses to the DW_TAG_subprogram DIE which contains them, or optionally to the innermost
+// DW_TAG_inlined_subroutine, whose parents then give the whole inline chain.
+// The ranges of all functions are cut into disjoint segments first. Where ranges nest, the segment belongs to the
+// innermost function, so a lookup never has to look at more than one candidate. The segment starts are stored in
+// Eytzinger order (the implicit binary search tree laid out breadth first): the top levels of the tree share a few
+// cache lines and the search loop has no data dependent branch.
+class FunctionIndex {
+public:
+  static uint32_t constexpr noFunction = UINT32_MAX;
+
+  // Functions with DW_AT_ranges are decoded from the range sections of the index
+  static FunctionIndex build(DIEIndex const &dieIndex, bool const withInlined);
+
+  // The functions of one unit of the index
+  static FunctionIndex build(DIEIndex const &dieIndex, uint32_t const unitIndex, bool const withInlined);
+
+  // DIE index of the innermost function (or inlined instance) containing address, noFunction if there is none
+  inline uint32_t find(uint64_t const address) const noexcept {
+    size_t k = 1U;
+    size_t const count = starts_.size() - 1U;
+    while (k <= count) {
+      k = (2U * k) + static_cast<size_t>(starts_[k] <= address);
+    }
+    // k now encodes the search path; dropping the trailing right turns and the last left turn gives the first start
+    // behind address
+    k >>= static_cast<unsigned>(std::countr_one(k)) + 1U;
+    size_t const segment = (k == 0U) ? count : ranks_[k];
+    if ((segment == 0U) || (address >= ends_[segment - 1U])) {
+      return noFunction;
+    }
+    return functions_[segment - 1U];
+  }
+
+  // Like find(), for a walk over ascending addresses: segment starts at 0 and only moves forward, so a sorted batch
+  // costs one pass over the segments instead of a search per address
+  inline uint32_t findNext(uint64_t const address, size_t &segment) const noexcept {
+    while ((segment < ends_.size()) && (ends_[segment] <= address)) {
+      segment++;
+    }
+    if ((segment == ends_.size()) || (address < lows_[segment])) {
+      return noFunction;
+    }
+    return functions_[segment];
+  }
+
+  inline size_t segmentCount() const noexcept {
+    return ends_.size();
+  }
+
+private:
+  struct Range {
+    uint64_t low;
+    uint64_t high;
+    uint32_t function;
+  };
+
+  static void collect(DIEIndex const &dieIndex, UnitInfo const &unit, bool const withInlined, std::vector<Range> &ranges);
+  static FunctionIndex fromRanges(std::vector<Range> &&ranges);
+  void layout(std::vector<Range> const &segments);
+  void fill(std::vector<Range> const &segments, size_t &next, size_t const k);
+
+  std::vector<uint64_t> starts_{0U}; // Eytzinger order, slot 0 unused
+  std::vector<uint32_t> ranks_{0U};  // position of every slot of starts_ in sorted order
+  std::vector<uint64_t> lows_;       // sorted order, for findNext
+  std::vector<uint64_t> ends_;       // sorted order
+  std::vector<uint32_t> functions_;  // sorted order
+};
+
+#endif
@@ -0,0 +1,467 @@
+#include "IndexWriter.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <map>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include "AcceleratorTables.hpp"
+#include "DIEIndex.hpp"
+#include "NameIndex.hpp"
+#include "Parallel.hpp"
+#include "QualifiedNames.hpp"
+
+namespace {
+uint32_t constexpr noString = UINT32_MAX; // the name is stored inline in .debug_info
+
+struct Record {
+  std::string_view name;          // plain DW_AT_name, as .debug_names wants it
+  uint32_t stringOffset;          // offset of name in .debug_str or noString
+  std::string_view qualifiedName; // as .gdb_index wants it
+  DebugAbbrev::Tag tag;
+  uint32_t unit; // index into debugInfoUnits()
+  uint32_t dieOffset;
+  bool isStatic;
+  bool inGdbIndex; // gdb finds inlined instances and mangled names through the functions they belong to
+};
+
+// Both tables list compile units and type units separately, DWARF5 type units in .debug_info go to the type unit list
+struct UnitLists {
+  std::vector<uint32_t> compileUnits; // indices into debugInfoUnits()
+  std::vector<uint32_t> typeUnits;
+  std::vector<uint32_t> position; // per unit of debugInfoUnits() its index in compileUnits or typeUnits
+
+  explicit UnitLists(std::span<DIEIndex::UnitInfo const> const units) : position(units.size(), 0U) {
+    for (size_t i = 0U; i < units.size(); i++) {
+      std::vector<uint32_t> &list = units[i].isTypeUnit() ? typeUnits : compileUnits;
+      position[i] = static_cast<uint32_t>(list.size());
+      list.push_back(static_cast<uint32_t>(i));
+    }
+  }
+};
+
+struct AddressRange {
+  uint64_t low;
+  uint64_t high;
+  uint32_t unit;
+};
+
+struct Shard {
+  QualifiedNames qualifiedNames; // private per thread like in NameIndex::build
+  std::vector<Record> records;
+  std::vector<AddressRange> ranges;
+};
+
+// gdb symbol kinds in the upper bits of a CU vector entry
+uint32_t constexpr gdbKindType = 1U;
+uint32_t constexpr gdbKindVariable = 2U;
+uint32_t constexpr gdbKindFunction = 3U;
+uint32_t constexpr gdbKindOther = 4U;
+
+template <typename T>
+void append(std::vector<uint8_t> &out, T const value) {
+  size_t const position = out.size();
+  out.resize(position + sizeof(T));
+  memcpy(out.data() + position, &value, sizeof(T));
+}
+
+template <typename T>
+void patch(std::vector<uint8_t> &out, size_t const position, T const value) noexcept {
+  memcpy(out.data() + position, &value, sizeof(T));
+}
+
+// Smallest of DW_FORM_data1, 2 and 4 which holds every index into a list of count entries
+DebugAbbrev::Form indexForm(size_t const count) noexcept {
+  return (count <= 0x100U) ? DebugAbbrev::Form::DW_FORM_data1 : ((count <= 0x1'0000U) ? DebugAbbrev::Form::DW_FORM_data2 : DebugAbbrev::Form::DW_FORM_data4);
+}
+
+void appendIndex(std::vector<uint8_t> &out, DebugAbbrev::Form const form, uint32_t const value) {
+  if (form == DebugAbbrev::Form::DW_FORM_data1) {
+    append(out, static_cast<uint8_t>(value));
+  } else if (form == DebugAbbrev::Form::DW_FORM_data2) {
+    append(out, static_cast<uint16_t>(value));
+  } else {
+    append(out, value);
+  }
+}
+
+void appendULEB128(std::vector<uint8_t> &out, uint64_t value) {
+  do {
+    uint8_t byte = static_cast<uint8_t>(value & 0x7FU);
+    value >>= 7U;
+    if (value != 0U) {
+      byte = static_cast<uint8_t>(byte | 0x80U);
+    }
+    out.push_back(byte);
+  } while (value != 0U);
+}
+
+// Offset of a string value in .debug_str or noString. FormValue::read already resolves DW_FORM_strx and strx1..4
+// through .debug_str_offsets and reports them as DW_FORM_strp.
+uint32_t debugStrOffset(std::optional<FormValue> const &value) noexcept {
+  return (value.has_value() && (value->form == DebugAbbrev::Form::DW_FORM_strp)) ? static_cast<uint32_t>(value->value) : noString;
+}
+
+// The entities debuggers look up by name: definitions of types, functions, global variables and namespaces, and the
+// inlined instances of functions
+bool isIndexed(DIEIndex const &dieIndex, uint32_t const index) {
+  DIEIndex::DIEInfo const &die = dieIndex.at(index);
+  switch (die.tag) {
+  case (DebugAbbrev::Tag::DW_TAG_base_type):
+  case (DebugAbbrev::Tag::DW_TAG_structure_type):
+  case (DebugAbbrev::Tag::DW_TAG_class_type):
+  case (DebugAbbrev::Tag::DW_TAG_union_type):
+  case (DebugAbbrev::Tag::DW_TAG_enumeration_type):
+  case (DebugAbbrev::Tag::DW_TAG_typedef):
+  case (DebugAbbrev::Tag::DW_TAG_subprogram):
+  case (DebugAbbrev::Tag::DW_TAG_inlined_subroutine):
+  case (DebugAbbrev::Tag::DW_TAG_namespace): {
+    break;
+  }
+  case (DebugAbbrev::Tag::DW_TAG_variable): {
+    // locals are not looked up by name
+    if (die.parent != DIEIndex::invalidIndex) {
+      DebugAbbrev::Tag const scope = dieIndex.at(die.parent).tag;
+      if ((scope == DebugAbbrev::Tag::DW_TAG_subprogram) || (scope == DebugAbbrev::Tag::DW_TAG_lexical_block) ||
+          (scope == DebugAbbrev::Tag::DW_TAG_inlined_subroutine)) {
+        return false;
+      }
+    }
+    break;
+  }
+  default: {
+    return false;
+  }
+  }
+  std::optional<FormValue> const declaration = dieIndex.attribute(index, DebugAbbrev::AttributeName::DW_AT_declaration);
+  return !(declaration.has_value() && (declaration->value != 0U));
+}
+
+uint32_t gdbKind(DebugAbbrev::Tag const tag) noexcept {
+  switch (tag) {
+  case (DebugAbbrev::Tag::DW_TAG_subprogram): {
+    return gdbKindFunction;
+  }
+  case (DebugAbbrev::Tag::DW_TAG_variable): {
+    return gdbKindVariable;
+  }
+  case (DebugAbbrev::Tag::DW_TAG_namespace): {
+    return gdbKindOther;
+  }
+  default: {
+    return gdbKindType;
+  }
+  }
+}
+
+// Code ranges of a unit: the range of the unit DIE, or the ranges of its functions if the unit has DW_AT_ranges
+void collectRanges(DIEIndex const &dieIndex, uint32_t const unitIndex, std::vector<AddressRange> &ranges) {
+  auto const addRange = [&](uint32_t const index) {
+    std::optional<FormValue> const lowPc = dieIndex.attribute(index, DebugAbbrev::AttributeName::DW_AT_low_pc);
+    std::optional<FormValue> const highPc = dieIndex.attribute(index, DebugAbbrev::AttributeName::DW_AT_high_pc);
+    if (!lowPc.has_value() || !highPc.has_value() || (lowPc->value == 0U)) {
+      return false; // functions dropped by the linker keep low_pc 0
+    }
+    // since DWARF4 high_pc may be the size of the range
+    uint64_t const high = (highPc->form == DebugAbbrev::Form::DW_FORM_addr) ? highPc->value : (lowPc->value + highPc->value);
+    if (high > lowPc->value) {
+      ranges.push_back(AddressRange{lowPc->value, high, unitIndex});
+    }
+    return true;
+  };
+
+  DIEIndex::UnitInfo const &unit = dieIndex.units()[unitIndex];
+  if ((unit.firstDIE == unit.endDIE) || addRange(unit.firstDIE)) {
+    return;
+  }
+  for (uint32_t i = unit.firstDIE + 1U; i < unit.endDIE; i++) {
+    if (dieIndex.at(i).tag == DebugAbbrev::Tag::DW_TAG_subprogram) {
+      static_cast<void>(addRange(i));
+    }
+  }
+}
+
+std::vector<uint8_t> writeDebugNames(DIEIndex const &dieIndex, UnitLists const &unitLists, std::vector<Record> &records, std::span<uint8_t const> const debugStr,
+                                     std::vector<uint8_t> &newDebugStr) {
+  struct Name {
+    std::string_view name;
+    uint32_t hash;
+    uint32_t stringOffset;
+    size_t firstRecord;
+    size_t recordCount;
+  };
+
+  std::sort(records.begin(), records.end(), [](Record const &lhs, Record const &rhs) {
+    return (lhs.name != rhs.name) ? (lhs.name < rhs.name) : (lhs.dieOffset < rhs.dieOffset);
+  });
+  std::vector<Name> names;
+  for (size_t i = 0U; i < records.size(); i++) {
+    if ((i == 0U) || (records[i].name != records[i - 1U].name)) {
+      names.push_back(Name{records[i].name, AcceleratorTables::debugNamesHash(records[i].name), noString, i, 0U});
+    }
+    Name &name = names.back();
+    name.recordCount++;
+    if (name.stringOffset == noString) {
+      name.stringOffset = records[i].stringOffset;
+    }
+  }
+
+  // names only stored inline get appended to a copy of .debug_str
+  for (Name &name : names) {
+    if (name.stringOffset != noString) {
+      continue;
+    }
+    if (newDebugStr.empty()) {
+      newDebugStr.assign(debugStr.begin(), debugStr.end());
+    }
+    name.stringOffset = static_cast<uint32_t>(newDebugStr.size());
+    newDebugStr.insert(newDebugStr.end(), name.name.begin(), name.name.end());
+    newDebugStr.push_back(0U);
+  }
+
+  // the names of one bucket have to be contiguous
+  uint32_t const bucketCount = static_cast<uint32_t>(names.size());
+  std::sort(names.begin(), names.end(), [bucketCount](Name const &lhs, Name const &rhs) {
+    uint32_t const lhsBucket = lhs.hash % bucketCount;
+    uint32_t const rhsBucket = rhs.hash % bucketCount;
+    if (lhsBucket != rhsBucket) {
+      return lhsBucket < rhsBucket;
+    }
+    return (lhs.hash != rhs.hash) ? (lhs.hash < rhs.hash) : (lhs.name < rhs.name);
+  });
+
+  std::span<DIEIndex::UnitInfo const> const units = dieIndex.debugInfoUnits();
+  DebugAbbrev::Form const compileUnitForm = indexForm(unitLists.compileUnits.size());
+  DebugAbbrev::Form const typeUnitForm = indexForm(unitLists.typeUnits.size());
+  uint32_t constexpr compileUnitIndex = 1U; // DW_IDX_compile_unit
+  uint32_t constexpr typeUnitIndex = 2U;    // DW_IDX_type_unit
+  uint32_t constexpr dieOffsetIndex = 3U;   // DW_IDX_die_offset
+
+  // one abbreviation per tag and kind of unit
+  std::map<std::pair<DebugAbbrev::Tag, bool>, uint32_t> abbrevCodes;
+  for (Record const &record : records) {
+    abbrevCodes.emplace(std::make_pair(record.tag, units[record.unit].isTypeUnit()), 0U);
+  }
+  std::vector<uint8_t> abbrevTable;
+  uint32_t nextCode = 1U;
+  for (std::pair<std::pair<DebugAbbrev::Tag, bool> const, uint32_t> &abbrev : abbrevCodes) {
+    bool const inTypeUnit = abbrev.first.second;
+    abbrev.second = nextCode++;
+    appendULEB128(abbrevTable, abbrev.second);
+    appendULEB128(abbrevTable, static_cast<uint64_t>(abbrev.first.first));
+    appendULEB128(abbrevTable, inTypeUnit ? typeUnitIndex : compileUnitIndex);
+    appendULEB128(abbrevTable, static_cast<uint64_t>(inTypeUnit ? typeUnitForm : compileUnitForm));
+    appendULEB128(abbrevTable, dieOffsetIndex);
+    appendULEB128(abbrevTable, static_cast<uint64_t>(DebugAbbrev::Form::DW_FORM_ref4));
+    appendULEB128(abbrevTable, 0U);
+    appendULEB128(abbrevTable, 0U);
+  }
+  appendULEB128(abbrevTable, 0U);
+
+  std::vector<uint8_t> entryPool;
+  std::vector<uint32_t> entryOffsets;
+  entryOffsets.reserve(names.size());
+  for (Name const &name : names) {
+    entryOffsets.push_back(static_cast<uint32_t>(entryPool.size()));
+    for (size_t i = name.firstRecord; i < name.firstRecord + name.recordCount; i++) {
+      Record const &record = records[i];
+      bool const inTypeUnit = units[record.unit].isTypeUnit();
+      appendULEB128(entryPool, abbrevCodes[std::make_pair(record.tag, inTypeUnit)]);
+      appendIndex(entryPool, inTypeUnit ? typeUnitForm : compileUnitForm, unitLists.position[record.unit]);
+      append(entryPool, record.dieOffset - units[record.unit].offset);
+    }
+    appendULEB128(entryPool, 0U);
+  }
+
+  std::vector<uint8_t> section;
+  append(section, uint32_t{0U}); // unit_length, patched below
+  append(section, uint16_t{5U});
+  append(section, uint16_t{0U});
+  append(section, static_cast<uint32_t>(unitLists.compileUnits.size()));
+  append(section, static_cast<uint32_t>(unitLists.typeUnits.size()));
+  append(section, uint32_t{0U}); // foreign type units
+  append(section, bucketCount);
+  append(section, static_cast<uint32_t>(names.size()));
+  append(section, static_cast<uint32_t>(abbrevTable.size()));
+  append(section, uint32_t{0U}); // no augmentation string
+  for (uint32_t const unit : unitLists.compileUnits) {
+    append(section, units[unit].offset);
+  }
+  for (uint32_t const unit : unitLists.typeUnits) {
+    append(section, units[unit].offset);
+  }
+  std::vector<uint32_t> buckets(bucketCount, 0U);
+  for (size_t i = names.size(); i > 0U; i--) {
+    buckets[names[i - 1U].hash % bucketCount] = static_cast<uint32_t>(i);
+  }
+  for (uint32_t const bucket : buckets) {
+    append(section, bucket);
+  }
+  for (Name const &name : names) {
+    append(section, name.hash);
+  }
+  for (Name const &name : names) {
+    append(section, name.stringOffset);
+  }
+  for (uint32_t const entryOffset : entryOffsets) {
+    append(section, entryOffset);
+  }
+  section.insert(section.end(), abbrevTable.begin(), abbrevTable.end());
+  section.insert(section.end(), entryPool.begin(), entryPool.end());
+  patch(section, 0U, static_cast<uint32_t>(section.size() - sizeof(uint32_t)));
+  return section;
+}
+
+std::vector<uint8_t> writeGdbIndex(DIEIndex const &dieIndex, UnitLists const &unitLists, std::vector<Record> &records, std::vector<AddressRange> &ranges) {
+  std::span<DIEIndex::UnitInfo const> const units = dieIndex.debugInfoUnits();
+  // type units are numbered after the compile units
+  auto const cuIndex = [&](uint32_t const unit) {
+    uint32_t const position = unitLists.position[unit];
+    return units[unit].isTypeUnit() ? static_cast<uint32_t>(unitLists.compileUnits.size()) + position : position;
+  };
+
+  std::sort(records.begin(), records.end(), [](Record const &lhs, Record const &rhs) {
+    return (lhs.qualifiedName != rhs.qualifiedName) ? (lhs.qualifiedName < rhs.qualifiedName) : (lhs.unit < rhs.unit);
+  });
+  std::sort(ranges.begin(), ranges.end(), [](AddressRange const &lhs, AddressRange const &rhs) {
+    return lhs.low < rhs.low;
+  });
+
+  // every symbol has a vector of CU indices tagged with kind and static flag, the vectors come first in the constant
+  // pool so that no symbol has the name offset 0
+  struct Symbol {
+    std::string_view name;
+    uint32_t nameOffset;
+    uint32_t vectorOffset;
+  };
+  std::vector<Symbol> symbols;
+  std::vector<uint8_t> vectors;
+  std::vector<uint32_t> entries;
+  for (size_t i = 0U; i < records.size(); i++) {
+    Record const &record = records[i];
+    entries.push_back(cuIndex(record.unit) | (gdbKind(record.tag) << 28U) | (record.isStatic ? 0x8000'0000U : 0U));
+    if ((i + 1U < records.size()) && (records[i + 1U].qualifiedName == record.qualifiedName)) {
+      continue;
+    }
+    std::sort(entries.begin(), entries.end());
+    entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+    symbols.push_back(Symbol{record.qualifiedName, 0U, static_cast<uint32_t>(vectors.size())});
+    append(vectors, static_cast<uint32_t>(entries.size()));
+    for (uint32_t const entry : entries) {
+      append(vectors, entry);
+    }
+    entries.clear();
+  }
+  std::vector<uint8_t> constantPool = std::move(vectors);
+  for (Symbol &symbol : symbols) {
+    symbol.nameOffset = static_cast<uint32_t>(constantPool.size());
+    constantPool.insert(constantPool.end(), symbol.name.begin(), symbol.name.end());
+    constantPool.push_back(0U);
+  }
+
+  // gdb keeps the load factor below 3/4
+  size_t const slotCount = std::bit_ceil(std::max<size_t>(16U, (symbols.size() * 4U / 3U) + 1U));
+  std::vector<uint32_t> slots(slotCount * 2U, 0U);
+  size_t const mask = slotCount - 1U;
+  for (Symbol const &symbol : symbols) {
+    uint32_t const hashValue = AcceleratorTables::gdbIndexHash(symbol.name);
+    size_t const step = ((hashValue * 17U) & mask) | 1U;
+    size_t slot = hashValue & mask;
+    while ((slots[slot * 2U] != 0U) || (slots[(slot * 2U) + 1U] != 0U)) {
+      slot = (slot + step) & mask;
+    }
+    slots[slot * 2U] = symbol.nameOffset;
+    slots[(slot * 2U) + 1U] = symbol.vectorOffset;
+  }
+
+  uint32_t constexpr headerSize = 6U * sizeof(uint32_t);
+  uint32_t const compUnitListOffset = headerSize;
+  uint32_t const typeUnitListOffset = compUnitListOffset + static_cast<uint32_t>(unitLists.compileUnits.size() * 2U * sizeof(uint64_t));
+  uint32_t const addressAreaOffset = typeUnitListOffset + static_cast<uint32_t>(unitLists.typeUnits.size() * 3U * sizeof(uint64_t));
+  uint32_t const symbolTableOffset = addressAreaOffset + static_cast<uint32_t>(ranges.size() * ((2U * sizeof(uint64_t)) + sizeof(uint32_t)));
+  uint32_t const constantPoolOffset = symbolTableOffset + static_cast<uint32_t>(slots.size() * sizeof(uint32_t));
+
+  std::vector<uint8_t> section;
+  section.reserve(constantPoolOffset + constantPool.size());
+  append(section, uint32_t{7U});
+  append(section, compUnitListOffset);
+  append(section, typeUnitListOffset);
+  append(section, addressAreaOffset);
+  append(section, symbolTableOffset);
+  append(section, constantPoolOffset);
+  for (uint32_t const unit : unitLists.compileUnits) {
+    append(section, static_cast<uint64_t>(units[unit].offset));
+    append(section, static_cast<uint64_t>(units[unit].end - units[unit].offset));
+  }
+  for (uint32_t const unit : unitLists.typeUnits) {
+    append(section, static_cast<uint64_t>(units[unit].offset));
+    append(section, static_cast<uint64_t>(units[unit].typeOffset));
+    append(section, units[unit].signature);
+  }
+  for (AddressRange const &range : ranges) {
+    append(section, range.low);
+    append(section, range.high);
+    append(section, cuIndex(range.unit));
+  }
+  for (uint32_t const slot : slots) {
+    append(section, slot);
+  }
+  section.insert(section.end(), constantPool.begin(), constantPool.end());
+  return section;
+}
+} // namespace
+
+IndexWriter::Sections IndexWriter::write(DIEIndex const &dieIndex, std::span<uint8_t const> const debugStr, bool const withGdbIndex) {
+  std::span<DIEIndex::UnitInfo const> const units = dieIndex.debugInfoUnits();
+  std::vector<Shard> shards(Parallel::workerCount(units.size()));
+
+  Parallel::forEach(units.size(), [&](size_t const unitIndex, size_t const worker) {
+    Shard &shard = shards[worker];
+    DIEIndex::UnitInfo const &unit = units[unitIndex];
+    if (withGdbIndex && !unit.isTypeUnit()) {
+      collectRanges(dieIndex, static_cast<uint32_t>(unitIndex), shard.ranges);
+    }
+    for (uint32_t i = unit.firstDIE; i < unit.endDIE; i++) {
+      if (!isIndexed(dieIndex, i)) {
+        continue;
+      }
+      // out-of-line definitions and inlined instances are named by their declaration
+      DIEIndex::DIEInfo const &die = dieIndex.at(i);
+      uint32_t const nameIndex = (die.name == StringPool::noString) ? QualifiedNames::declaration(dieIndex, i) : i;
+      std::string_view const name = dieIndex.name(nameIndex);
+      if (name.empty()) {
+        continue;
+      }
+      uint32_t const stringOffset = debugStrOffset(dieIndex.attribute(nameIndex, DebugAbbrev::AttributeName::DW_AT_name));
+      bool const inGdbIndex = die.tag != DebugAbbrev::Tag::DW_TAG_inlined_subroutine;
+      bool const isStatic = inGdbIndex && (die.tag != DebugAbbrev::Tag::DW_TAG_namespace) && !NameIndex::isExternallyVisible(dieIndex, i);
+      std::string_view const qualifiedName = inGdbIndex ? shard.qualifiedNames.name(dieIndex, i) : std::string_view();
+      shard.records.push_back(Record{name, stringOffset, qualifiedName, die.tag, static_cast<uint32_t>(unitIndex), die.offset, isStatic, inGdbIndex});
+      // .debug_names has an entry under the mangled name as well
+      std::optional<FormValue> const linkageName = QualifiedNames::linkageName(dieIndex, i);
+      if (linkageName.has_value()) {
+        std::string_view const mangled = dieIndex.string(*linkageName);
+        if (!mangled.empty() && (mangled != name)) {
+          shard.records.push_back(Record{mangled, debugStrOffset(linkageName), std::string_view(), die.tag, static_cast<uint32_t>(unitIndex), die.offset, isStatic, false});
+        }
+      }
+    }
+  });
+
+  std::vector<Record> records;
+  std::vector<AddressRange> ranges;
+  for (Shard const &shard : shards) {
+    records.insert(records.end(), shard.records.begin(), shard.records.end());
+    ranges.insert(ranges.end(), shard.ranges.begin(), shard.ranges.end());
+  }
+
+  UnitLists const unitLists(units);
+  Sections sections;
+  sections.debugNames = writeDebugNames(dieIndex, unitLists, records, debugStr, sections.debugStr);
+  if (withGdbIndex) {
+    records.erase(std::remove_if(records.begin(), records.end(), [](Record const &record) { return !record.inGdbIndex; }), records.end());
+    sections.gdbIndex = writeGdbIndex(dieIndex, unitLists, records, ranges);
+  }
+  return sections;
+}
@@ -0,0 +1,26 @@
+#ifndef INDEX_WRITER_HPP
+#define INDEX_WRITER_HPP
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class DIEIndex;
+
+// Builds the accelerator tables a binary without them is missing, from one parallel scan over all units:
+//  - a DWARF5 .debug_names with one name index covering every unit, names are the plain DW_AT_name and the
+//    DW_AT_linkage_name, inlined instances of functions are listed as well
+//  - optionally a version 7 .gdb_index, names are qualified as gdb expects
+// .debug_names refers to its names by .debug_str offset. Names which a producer stored inline with DW_FORM_string
+// are appended to a copy of .debug_str, which then has to replace the original section.
+class IndexWriter {
+public:
+  struct Sections {
+    std::vector<uint8_t> debugNames;
+    std::vector<uint8_t> gdbIndex; // empty unless requested
+    std::vector<uint8_t> debugStr; // empty if every name was already in .debug_str, otherwise the complete new section
+  };
+
+  static Sections write(DIEIndex const &dieIndex, std::span<uint8_t const> const debugStr, bool const withGdbIndex);
+};
+
+#endif
@@ -0,0 +1,340 @@
+#include "LineTable.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include "ByteReader.hpp"
+#include "FormValue.hpp"
+
+namespace {
+enum class StandardOpCode : uint8_t {
+  DW_LNS_copy = 1U,
+  DW_LNS_advance_pc = 2U,
+  DW_LNS_advance_line = 3U,
+  DW_LNS_set_file = 4U,
+  DW_LNS_set_column = 5U,
+  DW_LNS_negate_stmt = 6U,
+  DW_LNS_set_basic_block = 7U,
+  DW_LNS_const_add_pc = 8U,
+  DW_LNS_fixed_advance_pc = 9U,
+  DW_LNS_set_prologue_end = 10U,
+  DW_LNS_set_epilogue_begin = 11U,
+  DW_LNS_set_isa = 12U
+};
+
+enum class LineNumberContentType : uint16_t {
+  DW_LNCT_path = 0x1U,
+  DW_LNCT_directory_index = 0x2U,
+  DW_LNCT_timestamp = 0x3U,
+  DW_LNCT_size = 0x4U,
+  DW_LNCT_MD5 = 0x5U,
+};
+
+enum class ExtendedOpCode : uint8_t {
+  DW_LNE_end_sequence = 1U,
+  DW_LNE_set_address = 2U,
+  DW_LNE_define_file = 3U,
+  DW_LNE_set_discriminator = 4U,
+};
+
+std::string joinPath(std::string_view const directory, std::string_view const name) {
+  if (directory.empty() || (!name.empty() && (name.front() == '/'))) {
+    return std::string(name);
+  }
+  std::string path(directory);
+  if (path.back() != '/') {
+    path.push_back('/');
+  }
+  path.append(name);
+  return path;
+}
+} // namespace
+
+std::vector<LineTable::Entry> LineTable::readEntries(ByteReader &reader, DwarfSections const &sections, UnitInfo const &unit) {
+  std::vector<std::pair<LineNumberContentType, DebugAbbrev::AttributeSpecification>> formats;
+  uint8_t const formatCount = reader.getNumber<uint8_t>();
+  for (uint8_t i = 0U; i < formatCount; i++) {
+    LineNumberContentType const contentType = static_cast<LineNumberContentType>(reader.readLEB128(false));
+    // only the form of the specification is used
+    DebugAbbrev::Form const form = static_cast<DebugAbbrev::Form>(reader.readLEB128(false));
+    formats.emplace_back(contentType, DebugAbbrev::AttributeSpecification{DebugAbbrev::AttributeName::DW_AT_name, form, 0});
+  }
+  std::vector<Entry> entries;
+  uint64_t const count = reader.readLEB128(false);
+  for (uint64_t i = 0U; i < count; i++) {
+    Entry entry{std::string_view(), 0U, 0U, 0U, nullptr};
+    for (std::pair<LineNumberContentType, DebugAbbrev::AttributeSpecification> const &format : formats) {
+      FormValue const formValue = FormValue::read(reader, format.second, unit);
+      switch (format.first) {
+      case (LineNumberContentType::DW_LNCT_path): {
+        entry.path = sections.string(formValue);
+        break;
+      }
+      case (LineNumberContentType::DW_LNCT_directory_index): {
+        entry.directoryIndex = formValue.value;
+        break;
+      }
+      case (LineNumberContentType::DW_LNCT_timestamp): {
+        entry.timestamp = formValue.value;
+        break;
+      }
+      case (LineNumberContentType::DW_LNCT_size): {
+        entry.size = formValue.value;
+        break;
+      }
+      case (LineNumberContentType::DW_LNCT_MD5): {
+        entry.md5 = (formValue.size == 16U) ? formValue.data : nullptr;
+        break;
+      }
+      default: {
+        // vendor content types like DW_LNCT_LLVM_source are read over
+        break;
+      }
+      }
+    }
+    entries.push_back(entry);
+  }
+  return entries;
+}
+
+LineTable LineTable::decode(DwarfSections const &sections, UnitInfo const &unit, uint64_t const offset, std::string_view const compDir, bool const headerOnly) {
+  std::span<uint8_t const> const debugLine = sections.debugLine;
+  if (offset >= debugLine.size()) {
+    throw std::runtime_error("line table offset out of .debug_line");
+  }
+  ByteReader reader(debugLine.data() + offset, debugLine.size() - static_cast<size_t>(offset));
+  uint32_t const unitLength = reader.getNumber<uint32_t>();
+  if (unitLength >= 0xFFFF'FFF0U) {
+    throw std::runtime_error("64-bit DWARF is not supported");
+  }
+  if (unitLength > static_cast<size_t>(reader.end_ - reader.cursor_)) {
+    throw std::runtime_error("wrong unit_length");
+  }
+  uint8_t const *const unitEnd = reader.cursor_ + unitLength;
+
+  uint16_t const version = reader.getNumber<uint16_t>();
+  if ((version < 2U) || (version > 5U)) {
+    throw std::runtime_error("unsupported line table version");
+  }
+  uint8_t addressSize = unit.addressSize;
+  if (version >= 5U) {
+    addressSize = reader.getNumber<uint8_t>();
+    static_cast<void>(reader.getNumber<uint8_t>()); // segment_selector_size
+  }
+  uint32_t const headerLength = reader.getNumber<uint32_t>();
+  uint8_t const *const programStart = reader.cursor_ + headerLength;
+  if (programStart > unitEnd) {
+    throw std::runtime_error("header_length too large");
+  }
+  uint8_t const minimumInstructionLength = reader.getNumber<uint8_t>();
+  if (version >= 4U) {
+    static_cast<void>(reader.getNumber<uint8_t>()); // maximum_operations_per_instruction, only used by VLIW targets
+  }
+  bool const defaultIsStatement = reader.getNumber<uint8_t>() != 0U;
+  int8_t const lineBase = reader.getNumber<int8_t>();
+  uint8_t const lineRange = reader.getNumber<uint8_t>();
+  uint8_t const opcodeBase = reader.getNumber<uint8_t>();
+  if ((opcodeBase == 0U) || (lineRange == 0U)) {
+    throw std::runtime_error("invalid line table header");
+  }
+  std::vector<uint8_t> standardOpcodeLengths;
+  for (uint8_t i = 1U; i < opcodeBase; i++) {
+    standardOpcodeLengths.push_back(reader.getNumber<uint8_t>());
+  }
+
+  LineTable table;
+  std::vector<std::string> includeDirectories;
+  auto const addFile = [&](std::string_view const name, uint64_t const directoryIndex) {
+    // up to DWARF 4 directory 0 is the compilation directory and the table starts with directory 1; DWARF 5 lists the
+    // compilation directory itself as entry 0
+    uint64_t const directory = directoryIndex + static_cast<uint64_t>(version >= 5U) - 1U;
+    std::string_view const directoryName = (((version < 5U) && (directoryIndex == 0U)) || (directory >= includeDirectories.size())) ? std::string_view() : includeDirectories[directory];
+    table.fileNames_.push_back(joinPath(compDir, joinPath(directoryName, name)));
+  };
+  if (version >= 5U) {
+    // the line program is read with its own address size, the unit only lends the string tables
+    UnitInfo lineUnit = unit;
+    lineUnit.addressSize = addressSize;
+    for (Entry const &directory : readEntries(reader, sections, lineUnit)) {
+      includeDirectories.emplace_back(directory.path);
+    }
+    for (Entry const &file : readEntries(reader, sections, lineUnit)) {
+      addFile(file.path, file.directoryIndex);
+    }
+    table.fileBase_ = 0U;
+  } else {
+    includeDirectories = reader.getStringTable();
+    for (std::string name = reader.getString(); !name.empty(); name = reader.getString()) {
+      uint64_t const directoryIndex = reader.readLEB128(false);
+      static_cast<void>(reader.readLEB128(false)); // modification time
+      static_cast<void>(reader.readLEB128(false)); // file size
+      addFile(name, directoryIndex);
+    }
+  }
+  if (headerOnly) {
+    return table;
+  }
+
+  reader.cursor_ = programStart;
+  reader.end_ = unitEnd;
+  Row const initial{0U, 1U, 1U, 0U, defaultIsStatement, false, 0U};
+  Row state = initial;
+  uint32_t sequenceStart = 0U;
+  auto const appendRow = [&]() {
+    table.rows_.push_back(state);
+    if (state.endSequence) {
+      uint32_t const endRow = static_cast<uint32_t>(table.rows_.size() - 1U);
+      if (endRow > sequenceStart) {
+        table.sequences_.push_back(Sequence{table.rows_[sequenceStart].address, state.address, sequenceStart, endRow});
+      }
+      sequenceStart = endRow + 1U;
+      state = initial;
+    }
+    // the discriminator only applies to the row it was set for
+    state.discriminator = 0U;
+  };
+
+  while (reader.cursor_ < reader.end_) {
+    uint8_t const opCode = reader.getNumber<uint8_t>();
+    if (opCode >= opcodeBase) { // special opcode
+      uint8_t const adjusted = static_cast<uint8_t>(opCode - opcodeBase);
+      state.address += static_cast<uint64_t>(adjusted / lineRange) * minimumInstructionLength;
+      state.line = static_cast<uint32_t>(static_cast<int64_t>(state.line) + lineBase + (adjusted % lineRange));
+      appendRow();
+    } else if (opCode > 0U) { // standard opcode
+      switch (static_cast<StandardOpCode>(opCode)) {
+      case (StandardOpCode::DW_LNS_copy): {
+        appendRow();
+        break;
+      }
+      case (StandardOpCode::DW_LNS_advance_pc): {
+        state.address += reader.readLEB128(false) * minimumInstructionLength;
+        break;
+      }
+      case (StandardOpCode::DW_LNS_advance_line): {
+        state.line = static_cast<uint32_t>(static_cast<int64_t>(state.line) + static_cast<int64_t>(reader.readLEB128(true)));
+        break;
+      }
+      case (StandardOpCode::DW_LNS_set_file): {
+        state.file = static_cast<uint32_t>(reader.readLEB128(false));
+        break;
+      }
+      case (StandardOpCode::DW_LNS_set_column): {
+        state.column = static_cast<uint16_t>(reader.readLEB128(false));
+        break;
+      }
+      case (StandardOpCode::DW_LNS_negate_stmt): {
+        state.isStatement = !state.isStatement;
+        break;
+      }
+      case (StandardOpCode::DW_LNS_const_add_pc): {
+        state.address += static_cast<uint64_t>((255U - opcodeBase) / lineRange) * minimumInstructionLength;
+        break;
+      }
+      case (StandardOpCode::DW_LNS_fixed_advance_pc): {
+        state.address += reader.getNumber<uint16_t>();
+        break;
+      }
+      case (StandardOpCode::DW_LNS_set_basic_block):
+      case (StandardOpCode::DW_LNS_set_prologue_end):
+      case (StandardOpCode::DW_LNS_set_epilogue_begin): {
+        break;
+      }
+      default: {
+        // DW_LNS_set_isa and opcodes of newer versions: skip the operands the header announces
+        for (uint8_t i = 0U; i < standardOpcodeLengths[opCode - 1U]; i++) {
+          static_cast<void>(reader.readLEB128(false));
+        }
+        break;
+      }
+      }
+    } else { // extended opcode
+      uint64_t const length = reader.readLEB128(false);
+      if ((length == 0U) || (length > static_cast<uint64_t>(reader.end_ - reader.cursor_))) {
+        throw std::runtime_error("wrong extended opcode length");
+      }
+      uint8_t const *const next = reader.cursor_ + length;
+      switch (static_cast<ExtendedOpCode>(reader.getNumber<uint8_t>())) {
+      case (ExtendedOpCode::DW_LNE_end_sequence): {
+        state.endSequence = true;
+        appendRow();
+        break;
+      }
+      case (ExtendedOpCode::DW_LNE_set_address): {
+        state.address = (addressSize == 4U) ? reader.getNumber<uint32_t>() : reader.getNumber<uint64_t>();
+        break;
+      }
+      case (ExtendedOpCode::DW_LNE_define_file): {
+        std::string const name = reader.getString();
+        uint64_t const directoryIndex = reader.readLEB128(false);
+        addFile(name, directoryIndex);
+        break;
+      }
+      case (ExtendedOpCode::DW_LNE_set_discriminator): {
+        state.discriminator = static_cast<uint32_t>(reader.readLEB128(false));
+        break;
+      }
+      default: {
+        break;
+      }
+      }
+      reader.cursor_ = next;
+    }
+  }
+
+  std::sort(table.sequences_.begin(), table.sequences_.end(), [](Sequence const &lhs, Sequence const &rhs) {
+    return lhs.low < rhs.low;
+  });
+  return table;
+}
+
+LineTable::Row const *LineTable::find(uint64_t const address) const noexcept {
+  std::vector<Sequence>::const_iterator sequence = std::upper_bound(sequences_.begin(), sequences_.end(), address, [](uint64_t const value, Sequence const &candidate) {
+    return value < candidate.low;
+  });
+  if (sequence == sequences_.begin()) {
+    return nullptr;
+  }
+  --sequence;
+  if (address >= sequence->high) {
+    return nullptr;
+  }
+  // last row at or before address
+  std::vector<Row>::const_iterator const row =
+      std::upper_bound(rows_.begin() + sequence->firstRow, rows_.begin() + sequence->endRow, address, [](uint64_t const value, Row const &candidate) {
+        return value < candidate.address;
+      });
+  return &*(row - 1);
+}
+
+LineTable::Row const *LineTable::findNext(uint64_t const address, Cursor &cursor) const noexcept {
+  while ((cursor.sequence < sequences_.size()) && (sequences_[cursor.sequence].high <= address)) {
+    // rows are in program order, not address order, so the row position is only valid within one sequence
+    cursor.sequence++;
+    cursor.row = 0U;
+  }
+  if ((cursor.sequence == sequences_.size()) || (address < sequences_[cursor.sequence].low)) {
+    return nullptr;
+  }
+  Sequence const &sequence = sequences_[cursor.sequence];
+  uint32_t row = std::max(cursor.row, sequence.firstRow);
+  // gallop to the last row at or before address: double the step while it stays behind, then halve it back
+  uint32_t step = 1U;
+  while (((row + step) < sequence.endRow) && (rows_[row + step].address <= address)) {
+    row += step;
+    step *= 2U;
+  }
+  while (step > 1U) {
+    step /= 2U;
+    if (((row + step) < sequence.endRow) && (rows_[row + step].address <= address)) {
+      row += step;
+    }
+  }
+  cursor.row = row;
+  return &rows_[row];
+}
+
+std::string_view LineTable::fileName(uint32_t const file) const noexcept {
+  if ((file < fileBase_) || ((file - fileBase_) >= fileNames_.size())) {
+    return std::string_view();
+  }
+  return fileNames_[file - fileBase_];
+}
@@ -0,0 +1,83 @@
+#ifndef LINE_TABLE_HPP
+#define LINE_TABLE_HPP
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ByteReader.hpp"
+#include "DwarfSections.hpp"
+#include "UnitInfo.hpp"
+
+// The rows of one line number program, for address lookups. Unlike DebugLine, which prints the program opcode by
+// opcode, this runs the state machine silently and keeps the resulting matrix.
+class LineTable {
+public:
+  struct Row {
+    uint64_t address;
+    uint32_t file; // index into the file name table of the program
+    uint32_t line;
+    uint16_t column;
+    bool isStatement;
+    bool endSequence; // first address behind the sequence, the row itself describes no code
+    uint32_t discriminator; // block of the line the code belongs to, 0 if the line has only one
+  };
+
+  // One entry of the directory or file name table of a DWARF 5 line program header
+  struct Entry {
+    std::string_view path;
+    uint64_t directoryIndex;
+    uint64_t timestamp;
+    uint64_t size;
+    uint8_t const *md5; // 16 bytes, nullptr if the producer recorded none
+  };
+
+  // compDir is the DW_AT_comp_dir of the unit, relative file names are resolved against it. The line program
+  // belongs to unit, whose tables resolve the string forms of a DWARF 5 header. With headerOnly the program is not
+  // run, the table has the file names of the header and no rows.
+  static LineTable decode(DwarfSections const &sections, UnitInfo const &unit, uint64_t const offset, std::string_view const compDir, bool const headerOnly = false);
+
+  // Reads an entry format description followed by the entries it describes, the way DWARF 5 encodes the directory
+  // and the file name table
+  static std::vector<Entry> readEntries(ByteReader &reader, DwarfSections const &sections, UnitInfo const &unit);
+
+  // Row which covers address, nullptr if no sequence contains it
+  Row const *find(uint64_t const address) const noexcept;
+
+  // Position of a walk over ascending addresses, see findNext
+  struct Cursor {
+    uint32_t sequence = 0U;
+    uint32_t row = 0U;
+  };
+
+  // Like find(), for ascending addresses: the cursor only moves forward, in steps which double while the rows are
+  // behind address, so dense batches cost a linear pass and sparse ones a logarithmic skip per address
+  Row const *findNext(uint64_t const address, Cursor &cursor) const noexcept;
+
+  // Full path of a file of the file name table, empty for an invalid index
+  std::string_view fileName(uint32_t const file) const noexcept;
+
+  inline std::vector<Row> const &rows() const noexcept {
+    return rows_;
+  }
+
+  // Full paths of the file name table, in file index order starting at the first file
+  inline std::vector<std::string> const &fileNames() const noexcept {
+    return fileNames_;
+  }
+
+private:
+  struct Sequence {
+    uint64_t low;
+    uint64_t high;
+    uint32_t firstRow;
+    uint32_t endRow; // index of the end_sequence row
+  };
+
+  std::vector<Row> rows_;
+  std::vector<Sequence> sequences_; // sorted by low
+  std::vector<std::string> fileNames_;
+  uint32_t fileBase_ = 1U; // index of the first file, DWARF 5 counts from 0
+};
+
+#endif
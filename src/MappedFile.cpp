@@ -0,0 +1,65 @@
+#include "MappedFile.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+  }
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0U)) {
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    if (data_ != nullptr) {
+      munmap(data_, size_);
+    }
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0U);
+  }
+  return *this;
+}
+
+MappedFile MappedFile::open(std::string const &path) {
+  MappedFile file;
+  int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return file;
+  }
+  struct stat status;
+  if ((fstat(fd, &status) == 0) && (status.st_size > 0)) {
+    void *const data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED) {
+      file.data_ = data;
+      file.size_ = static_cast<size_t>(status.st_size);
+    }
+  }
+  // the mapping stays valid without the descriptor
+  close(fd);
+  return file;
+}
+
+void MappedFile::release(std::span<uint8_t const> const range) const noexcept {
+  uintptr_t const mappingBegin = reinterpret_cast<uintptr_t>(data_);
+  uintptr_t const mappingEnd = mappingBegin + size_;
+  uintptr_t const rangeBegin = reinterpret_cast<uintptr_t>(range.data());
+  uintptr_t const rangeEnd = rangeBegin + range.size();
+  if ((data_ == nullptr) || (rangeBegin >= mappingEnd) || (rangeEnd <= mappingBegin)) {
+    return;
+  }
+  // the mapping starts at a page boundary, pages shared with data before or after range are kept
+  uintptr_t const pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  uintptr_t const begin = (std::max(rangeBegin, mappingBegin) + pageSize - 1U) & ~(pageSize - 1U);
+  uintptr_t const end = std::min(rangeEnd, mappingEnd) & ~(pageSize - 1U);
+  if (begin < end) {
+    // a private read only mapping of a file, MADV_DONTNEED cannot lose data
+    madvise(reinterpret_cast<void *>(begin), end - begin, MADV_DONTNEED);
+  }
+}
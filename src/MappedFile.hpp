@@ -0,0 +1,38 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+// Read only mapping of a whole file. Nothing is read up front, the kernel loads the pages which are touched.
+class MappedFile {
+public:
+  MappedFile() noexcept = default;
+  ~MappedFile();
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+  MappedFile(MappedFile const &) = delete;
+  MappedFile &operator=(MappedFile const &) = delete;
+
+  // Not open if the file is missing, empty or cannot be mapped
+  static MappedFile open(std::string const &path);
+
+  inline bool isOpen() const noexcept {
+    return data_ != nullptr;
+  }
+
+  inline std::span<uint8_t const> bytes() const noexcept {
+    return std::span<uint8_t const>(static_cast<uint8_t const *>(data_), size_);
+  }
+
+  // Drops the pages which lie wholly inside range from memory, for data which has been consumed. They are not lost, a
+  // later access loads them again. Parts of range outside of the mapping are ignored.
+  void release(std::span<uint8_t const> const range) const noexcept;
+
+private:
+  void *data_ = nullptr;
+  size_t size_ = 0U;
+};
+
+#endif
@@ -0,0 +1,151 @@
+#include "NameIndex.hpp"
+#include <algorithm>
+#include <bit>
+#include "DIEIndex.hpp"
+#include "Parallel.hpp"
+#include "QualifiedNames.hpp"
+
+namespace {
+struct Record {
+  std::string_view name;
+  uint32_t hash;
+  NameIndex::Entry entry;
+};
+
+struct Shard {
+  QualifiedNames qualifiedNames; // a private cache per thread, so the shards never wait for each other
+  std::vector<Record> records;
+};
+} // namespace
+
+uint32_t NameIndex::hash(std::string_view const name) noexcept {
+  uint32_t hashValue = 5381U;
+  for (char const c : name) {
+    hashValue = (hashValue * 33U) + static_cast<uint8_t>(c);
+  }
+  return hashValue;
+}
+
+bool NameIndex::isExternallyVisible(DIEIndex const &dieIndex, uint32_t const index) {
+  DIEIndex::DIEInfo const &die = dieIndex.at(index);
+  std::optional<FormValue> const declaration = dieIndex.attribute(index, DebugAbbrev::AttributeName::DW_AT_declaration);
+  if (declaration.has_value() && (declaration->value != 0U)) {
+    return false; // only definitions are indexed
+  }
+
+  switch (die.tag) {
+  case (DebugAbbrev::Tag::DW_TAG_subprogram):
+  case (DebugAbbrev::Tag::DW_TAG_variable): {
+    // out-of-line definitions carry DW_AT_external on their declaration
+    std::optional<FormValue> external = dieIndex.attribute(index, DebugAbbrev::AttributeName::DW_AT_external);
+    if (!external.has_value()) {
+      uint32_t const declarationIndex = QualifiedNames::declaration(dieIndex, index);
+      if (declarationIndex != index) {
+        external = dieIndex.attribute(declarationIndex, DebugAbbrev::AttributeName::DW_AT_external);
+      }
+    }
+    return external.has_value() && (external->value != 0U);
+  }
+  case (DebugAbbrev::Tag::DW_TAG_structure_type):
+  case (DebugAbbrev::Tag::DW_TAG_class_type):
+  case (DebugAbbrev::Tag::DW_TAG_union_type):
+  case (DebugAbbrev::Tag::DW_TAG_enumeration_type):
+  case (DebugAbbrev::Tag::DW_TAG_typedef): {
+    // types local to a function or an anonymous namespace are not visible from outside
+    for (uint32_t parent = die.parent; parent != DIEIndex::invalidIndex; parent = dieIndex.at(parent).parent) {
+      DIEIndex::DIEInfo const &scope = dieIndex.at(parent);
+      if ((scope.tag == DebugAbbrev::Tag::DW_TAG_subprogram) || (scope.tag == DebugAbbrev::Tag::DW_TAG_lexical_block) ||
+          ((scope.tag == DebugAbbrev::Tag::DW_TAG_namespace) && (scope.name == StringPool::noString))) {
+        return false;
+      }
+    }
+    return die.name != StringPool::noString;
+  }
+  default: {
+    return false;
+  }
+  }
+}
+
+NameIndex NameIndex::build(DIEIndex const &dieIndex) {
+  std::vector<DIEIndex::UnitInfo> const &units = dieIndex.units();
+  std::vector<Shard> shards(Parallel::workerCount(units.size()));
+
+  Parallel::forEach(units.size(), [&](size_t const unitIndex, size_t const worker) {
+    Shard &shard = shards[worker];
+    DIEIndex::UnitInfo const &unit = units[unitIndex];
+    for (uint32_t i = unit.firstDIE; i < unit.endDIE; i++) {
+      if (!isExternallyVisible(dieIndex, i)) {
+        continue;
+      }
+      DIEIndex::DIEInfo const &die = dieIndex.at(i);
+      std::string_view plainName = dieIndex.name(i);
+      if (plainName.empty()) {
+        plainName = dieIndex.name(QualifiedNames::declaration(dieIndex, i));
+      }
+      if (plainName.empty()) {
+        continue;
+      }
+      shard.records.push_back(Record{plainName, hash(plainName), Entry{die.offset, die.tag, false}});
+      std::string_view const qualifiedName = shard.qualifiedNames.name(dieIndex, i);
+      if (qualifiedName != plainName) {
+        shard.records.push_back(Record{qualifiedName, hash(qualifiedName), Entry{die.offset, die.tag, true}});
+      }
+    }
+  });
+
+  std::vector<Record> records;
+  for (Shard const &shard : shards) {
+    records.insert(records.end(), shard.records.begin(), shard.records.end());
+  }
+  std::sort(records.begin(), records.end(), [](Record const &lhs, Record const &rhs) {
+    if (lhs.hash != rhs.hash) {
+      return lhs.hash < rhs.hash;
+    }
+    if (lhs.name != rhs.name) {
+      return lhs.name < rhs.name;
+    }
+    return lhs.entry.dieOffset < rhs.entry.dieOffset;
+  });
+
+  NameIndex nameIndex;
+  nameIndex.entries_.reserve(records.size());
+  std::vector<Slot> groups;
+  for (size_t i = 0U; i < records.size(); i++) {
+    Record const &record = records[i];
+    if ((i == 0U) || (record.hash != records[i - 1U].hash) || (record.name != records[i - 1U].name)) {
+      groups.push_back(Slot{record.hash, static_cast<uint32_t>(nameIndex.names_.size()), static_cast<uint32_t>(record.name.size()), static_cast<uint32_t>(i), 0U});
+      nameIndex.names_.insert(nameIndex.names_.end(), record.name.begin(), record.name.end());
+    }
+    groups.back().entryCount++;
+    nameIndex.entries_.push_back(record.entry);
+  }
+
+  // load factor of at most one half keeps the probe sequences short
+  size_t const slotCount = std::bit_ceil(std::max<size_t>(16U, groups.size() * 2U));
+  nameIndex.slots_.assign(slotCount, Slot{0U, 0U, 0U, 0U, 0U});
+  for (Slot const &group : groups) {
+    size_t position = group.hash & (slotCount - 1U);
+    while (nameIndex.slots_[position].entryCount != 0U) {
+      position = (position + 1U) & (slotCount - 1U);
+    }
+    nameIndex.slots_[position] = group;
+  }
+  nameIndex.nameCount_ = groups.size();
+  return nameIndex;
+}
+
+std::span<NameIndex::Entry const> NameIndex::lookup(std::string_view const name) const noexcept {
+  if (slots_.empty()) {
+    return std::span<Entry const>();
+  }
+  uint32_t const hashValue = hash(name);
+  size_t const mask = slots_.size() - 1U;
+  for (size_t position = hashValue & mask; slots_[position].entryCount != 0U; position = (position + 1U) & mask) {
+    Slot const &slot = slots_[position];
+    if ((slot.hash == hashValue) && (std::string_view(names_.data() + slot.nameOffset, slot.nameLength) == name)) {
+      return std::span<Entry const>(entries_.data() + slot.firstEntry, slot.entryCount);
+    }
+  }
+  return std::span<Entry const>();
+}
@@ -0,0 +1,67 @@
+#ifndef NAME_INDEX_HPP
+#define NAME_INDEX_HPP
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "DebugAbbrev.hpp"
+
+class DIEIndex;
+
+// name -> defining DIEs of every named, externally visible entity (functions, variables and types).
+// Every entity is found by its plain DW_AT_name and by its qualified name. The index is built from per thread
+// shards and then frozen into an open addressing table of power of two size. All names are stored back to back in
+// one character array and the entries of one name are contiguous, so a lookup is one hash, a short linear probe and
+// one string compare.
+class NameIndex {
+public:
+  struct Entry {
+    uint32_t dieOffset;
+    DebugAbbrev::Tag tag;
+    bool qualified; // found under its qualified name, the plain name has an entry of its own
+  };
+
+  static NameIndex build(DIEIndex const &dieIndex);
+
+  std::span<Entry const> lookup(std::string_view const name) const noexcept;
+
+  // DJB hash as used by .debug_names
+  static uint32_t hash(std::string_view const name) noexcept;
+
+  // Calls visitor(name, entries) for every distinct name
+  template <typename Visitor>
+  void forEachName(Visitor const &visitor) const {
+    for (Slot const &slot : slots_) {
+      if (slot.entryCount != 0U) {
+        visitor(std::string_view(names_.data() + slot.nameOffset, slot.nameLength), std::span<Entry const>(entries_.data() + slot.firstEntry, slot.entryCount));
+      }
+    }
+  }
+
+  inline size_t nameCount() const noexcept {
+    return nameCount_;
+  }
+
+  inline size_t entryCount() const noexcept {
+    return entries_.size();
+  }
+
+  // Definitions of external functions and variables, and types outside of functions and anonymous namespaces
+  static bool isExternallyVisible(DIEIndex const &dieIndex, uint32_t const index);
+
+private:
+  struct Slot {
+    uint32_t hash;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t firstEntry;
+    uint32_t entryCount; // 0 marks an empty slot
+  };
+
+  std::vector<char> names_;
+  std::vector<Entry> entries_;
+  std::vector<Slot> slots_;
+  size_t nameCount_ = 0U;
+};
+
+#endif
@@ -0,0 +1,79 @@
+#include "PackageIndex.hpp"
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include "ByteReader.hpp"
+
+namespace {
+size_t constexpr headerSize = 4U * sizeof(uint32_t);
+} // namespace
+
+PackageIndex::PackageIndex(std::span<uint8_t const> const section) : section_(section) {
+  if (section.empty()) {
+    return;
+  }
+  ByteReader reader(section.data(), section.size());
+  version_ = reader.getNumber<uint16_t>();
+  static_cast<void>(reader.getNumber<uint16_t>()); // padding in version 5, the high half of the version in version 2
+  columnCount_ = reader.getNumber<uint32_t>();
+  unitCount_ = reader.getNumber<uint32_t>();
+  slotCount_ = reader.getNumber<uint32_t>();
+  if ((version_ != 2U) && (version_ != 5U)) {
+    throw std::runtime_error("unsupported package index version " + std::to_string(version_));
+  }
+  if ((slotCount_ & (slotCount_ - 1U)) != 0U) {
+    throw std::runtime_error("package index slot count is not a power of two");
+  }
+  // hash table, index table, column header, then offsets and sizes per unit
+  uint64_t const size = headerSize + (static_cast<uint64_t>(slotCount_) * (sizeof(uint64_t) + sizeof(uint32_t))) + (static_cast<uint64_t>(columnCount_) * sizeof(uint32_t)) +
+                        (2U * static_cast<uint64_t>(unitCount_) * columnCount_ * sizeof(uint32_t));
+  if (size > section.size()) {
+    throw std::runtime_error("package index larger than its section");
+  }
+}
+
+uint32_t PackageIndex::readWord(size_t const offset) const noexcept {
+  uint32_t word;
+  memcpy(&word, section_.data() + offset, sizeof(word));
+  return word;
+}
+
+std::optional<PackageIndex::Row> PackageIndex::find(uint64_t const signature) const {
+  if (slotCount_ == 0U) {
+    return std::nullopt;
+  }
+  size_t const signatures = headerSize;
+  size_t const indices = signatures + (static_cast<size_t>(slotCount_) * sizeof(uint64_t));
+  size_t const columns = indices + (static_cast<size_t>(slotCount_) * sizeof(uint32_t));
+  size_t const offsets = columns + (static_cast<size_t>(columnCount_) * sizeof(uint32_t));
+  size_t const sizes = offsets + (static_cast<size_t>(unitCount_) * columnCount_ * sizeof(uint32_t));
+
+  // double hashing as specified: the low bits pick the slot, the high bits the odd step
+  uint64_t const mask = slotCount_ - 1U;
+  uint64_t slot = signature & mask;
+  uint64_t const step = ((signature >> 32U) & mask) | 1U;
+  for (uint32_t probes = 0U; probes < slotCount_; probes++) {
+    uint32_t const row = readWord(indices + (static_cast<size_t>(slot) * sizeof(uint32_t)));
+    if (row == 0U) {
+      return std::nullopt;
+    }
+    uint64_t candidate;
+    memcpy(&candidate, section_.data() + signatures + (static_cast<size_t>(slot) * sizeof(uint64_t)), sizeof(candidate));
+    if (candidate == signature) {
+      if (row > unitCount_) {
+        throw std::runtime_error("package index row out of range");
+      }
+      Row result{};
+      size_t const rowStart = static_cast<size_t>(row - 1U) * columnCount_ * sizeof(uint32_t);
+      for (uint32_t column = 0U; column < columnCount_; column++) {
+        uint32_t const section = readWord(columns + (column * sizeof(uint32_t)));
+        if (section < result.contributions.size()) {
+          result.contributions[section] = Contribution{readWord(offsets + rowStart + (column * sizeof(uint32_t))), readWord(sizes + rowStart + (column * sizeof(uint32_t)))};
+        }
+      }
+      return result;
+    }
+    slot = (slot + step) & mask;
+  }
+  return std::nullopt;
+}
@@ -0,0 +1,60 @@
+#ifndef PACKAGE_INDEX_HPP
+#define PACKAGE_INDEX_HPP
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+// .debug_cu_index or .debug_tu_index of a .dwp package: an open addressing hash table from DWO id, respectively type
+// signature, to the contribution of the unit to every section of the package. Version 2 is the GNU extension used
+// with DWARF 4, version 5 the standard one. Nothing is decoded up front; a lookup probes the table in place.
+class PackageIndex {
+public:
+  // Column identifiers. Two of them changed their meaning from version 2 to version 5.
+  enum class Section : uint32_t {
+    DW_SECT_INFO = 1,
+    DW_SECT_TYPES = 2, // version 2 only
+    DW_SECT_ABBREV = 3,
+    DW_SECT_LINE = 4,
+    DW_SECT_LOCLISTS = 5, // DW_SECT_LOC in version 2
+    DW_SECT_STR_OFFSETS = 6,
+    DW_SECT_MACRO = 7,    // DW_SECT_MACINFO in version 2
+    DW_SECT_RNGLISTS = 8, // DW_SECT_MACRO in version 2
+  };
+
+  struct Contribution {
+    uint32_t offset;
+    uint32_t size;
+  };
+
+  // Contributions of one unit by column identifier; sections the unit does not contribute to have size 0
+  struct Row {
+    std::array<Contribution, 9> contributions;
+
+    inline Contribution of(Section const section) const noexcept {
+      return contributions[static_cast<uint32_t>(section)];
+    }
+  };
+
+  PackageIndex() noexcept = default;
+
+  // Checks the header and that the tables fit into the section; an empty section gives an empty index
+  explicit PackageIndex(std::span<uint8_t const> const section);
+
+  std::optional<Row> find(uint64_t const signature) const;
+
+  inline uint16_t version() const noexcept {
+    return version_;
+  }
+
+private:
+  uint32_t readWord(size_t const offset) const noexcept;
+
+  std::span<uint8_t const> section_;
+  uint16_t version_ = 0U;
+  uint32_t columnCount_ = 0U;
+  uint32_t unitCount_ = 0U;
+  uint32_t slotCount_ = 0U;
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+class Parallel {
+public:
+  // Number of threads forEach uses for the given number of tasks
+  static size_t workerCount(size_t const tasks) noexcept {
+    size_t const hardwareThreads = std::max<size_t>(1U, static_cast<size_t>(std::thread::hardware_concurrency()));
+    return std::max<size_t>(1U, std::min(hardwareThreads, tasks));
+  }
+
+  // Calls task(taskIndex, workerIndex) for every task. Tasks are handed out one by one, so units of very different size
+  // still balance. The first exception thrown by a task is rethrown after all workers have finished.
+  template <typename Task>
+  static void forEach(size_t const tasks, Task const &task) {
+    size_t const workers = workerCount(tasks);
+    std::atomic<size_t> nextTask{0U};
+    std::vector<std::exception_ptr> errors(workers);
+    auto const work = [&](size_t const worker) {
+      try {
+        for (size_t taskIndex = nextTask.fetch_add(1U); taskIndex < tasks; taskIndex = nextTask.fetch_add(1U)) {
+          task(taskIndex, worker);
+        }
+      } catch (...) {
+        errors[worker] = std::current_exception();
+        nextTask.store(tasks);
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t worker = 1U; worker < workers; worker++) {
+      threads.emplace_back(work, worker);
+    }
+    work(0U);
+    for (std::thread &thread : threads) {
+      thread.join();
+    }
+    for (std::exception_ptr const &error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+  }
+};
+
+#endif
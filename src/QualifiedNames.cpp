@@ -0,0 +1,142 @@
+#include "QualifiedNames.hpp"
+#include "DIEIndex.hpp"
+
+std::string_view QualifiedNames::name(DIEIndex const &dieIndex, uint32_t const index) {
+  std::string_view qualified;
+  static_cast<void>(name(dieIndex, index, qualified));
+  return qualified;
+}
+
+bool QualifiedNames::name(DIEIndex const &dieIndex, uint32_t const index, std::string_view &name) {
+  std::lock_guard<std::mutex> const lock(mutex_);
+  if (names_.size() < dieIndex.size()) {
+    names_.resize(dieIndex.size());
+    known_.resize(dieIndex.size(), false);
+  }
+  return qualify(dieIndex, index, name);
+}
+
+uint32_t QualifiedNames::declaration(DIEIndex const &dieIndex, uint32_t const index) {
+  bool complete = true;
+  return declaration(dieIndex, index, complete);
+}
+
+uint32_t QualifiedNames::declaration(DIEIndex const &dieIndex, uint32_t index, bool &complete) {
+  // a concrete inlined instance points to its abstract instance, which may point to the in-class declaration
+  for (uint32_t hops = 0U; hops < 8U; hops++) {
+    std::optional<FormValue> link = dieIndex.attribute(index, DebugAbbrev::AttributeName::DW_AT_specification);
+    if (!link.has_value()) {
+      link = dieIndex.attribute(index, DebugAbbrev::AttributeName::DW_AT_abstract_origin);
+    }
+    if (!link.has_value() || !link->isReference()) {
+      break;
+    }
+    uint32_t const target = dieIndex.findIndex(static_cast<uint32_t>(link->value));
+    if (target == DIEIndex::invalidIndex) {
+      complete = false;
+      break;
+    }
+    index = target;
+  }
+  return index;
+}
+
+std::optional<FormValue> QualifiedNames::linkageName(DIEIndex const &dieIndex, uint32_t index) {
+  // an inlined instance points to its abstract instance, which may point to the in-class declaration
+  for (uint32_t hops = 0U; hops < 8U; hops++) {
+    std::optional<FormValue> name = dieIndex.attribute(index, DebugAbbrev::AttributeName::DW_AT_linkage_name);
+    if (!name.has_value()) {
+      name = dieIndex.attribute(index, DebugAbbrev::AttributeName::DW_AT_MIPS_linkage_name);
+    }
+    if (name.has_value()) {
+      return name;
+    }
+    std::optional<FormValue> link = dieIndex.attribute(index, DebugAbbrev::AttributeName::DW_AT_abstract_origin);
+    if (!link.has_value()) {
+      link = dieIndex.attribute(index, DebugAbbrev::AttributeName::DW_AT_specification);
+    }
+    if (!link.has_value() || !link->isReference()) {
+      break;
+    }
+    uint32_t const target = dieIndex.findIndex(static_cast<uint32_t>(link->value));
+    if (target == DIEIndex::invalidIndex) {
+      break;
+    }
+    index = target;
+  }
+  return std::nullopt;
+}
+
+bool QualifiedNames::scope(DIEIndex const &dieIndex, uint32_t parent, std::string_view &name) {
+  // blocks do not open a named scope
+  while ((parent != DIEIndex::invalidIndex) && (dieIndex.at(parent).tag == DebugAbbrev::Tag::DW_TAG_lexical_block)) {
+    parent = dieIndex.at(parent).parent;
+  }
+  if (parent == DIEIndex::invalidIndex) {
+    name = std::string_view();
+    return true;
+  }
+  return qualify(dieIndex, parent, name);
+}
+
+bool QualifiedNames::qualify(DIEIndex const &dieIndex, uint32_t const index, std::string_view &name) {
+  if (known_[index]) {
+    name = names_[index];
+    return true;
+  }
+
+  // provisional entry, malformed specification chains must not recurse forever
+  known_[index] = true;
+
+  DIEIndex::DIEInfo const &die = dieIndex.at(index);
+  std::string_view result;
+  bool complete = true;
+  if ((die.tag != DebugAbbrev::Tag::DW_TAG_compile_unit) && (die.tag != DebugAbbrev::Tag::DW_TAG_partial_unit)) {
+    uint32_t const declarationIndex = declaration(dieIndex, index, complete);
+    DIEIndex::DIEInfo const &declarationDIE = dieIndex.at(declarationIndex);
+
+    std::string_view ownName = dieIndex.name((die.name == StringPool::noString) ? declarationIndex : index);
+    if (ownName.empty()) {
+      switch (declarationDIE.tag) {
+      case (DebugAbbrev::Tag::DW_TAG_namespace): {
+        ownName = "(anonymous namespace)";
+        break;
+      }
+      case (DebugAbbrev::Tag::DW_TAG_structure_type): {
+        ownName = "(anonymous struct)";
+        break;
+      }
+      case (DebugAbbrev::Tag::DW_TAG_class_type): {
+        ownName = "(anonymous class)";
+        break;
+      }
+      case (DebugAbbrev::Tag::DW_TAG_union_type): {
+        ownName = "(anonymous union)";
+        break;
+      }
+      case (DebugAbbrev::Tag::DW_TAG_enumeration_type): {
+        ownName = "(anonymous enum)";
+        break;
+      }
+      default: {
+        break;
+      }
+      }
+    }
+
+    std::string_view prefix;
+    complete = scope(dieIndex, declarationDIE.parent, prefix) && complete;
+    if (prefix.empty()) {
+      result = ownName; // points into the section data or is a literal, no copy needed
+    } else if (ownName.empty()) {
+      result = prefix;
+    } else {
+      result = arena_.concat(prefix, "::", ownName);
+    }
+  }
+
+  names_[index] = result;
+  known_[index] = complete;
+  name = result;
+  return complete;
+}
@@ -0,0 +1,44 @@
+#ifndef QUALIFIED_NAMES_HPP
+#define QUALIFIED_NAMES_HPP
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include "FormValue.hpp"
+#include "StringArena.hpp"
+
+class DIEIndex;
+
+// Builds names like ns1::ns2::Class::method.
+// The qualified name of every DIE is memoized by DIE index, so the name of a DIE is its parent's cached name, "::" and
+// its own name appended in one arena allocation. A namespace chain is therefore walked once per index no matter how
+// many members it has. Out-of-line definitions and concrete instances are named through their DW_AT_specification and
+// DW_AT_abstract_origin, using the scope of the declaration. A name which needs a DIE that is not indexed yet, like the
+// declaration of a later unit while the dump indexes unit by unit, is built but not memoized.
+class QualifiedNames {
+public:
+  // Thread safe
+  std::string_view name(DIEIndex const &dieIndex, uint32_t const index);
+  // Like name, returns false if the name needs a DIE which is not indexed yet
+  bool name(DIEIndex const &dieIndex, uint32_t const index, std::string_view &name);
+
+  // Follows DW_AT_abstract_origin and DW_AT_specification to the DIE which declares index
+  static uint32_t declaration(DIEIndex const &dieIndex, uint32_t index);
+  // DW_AT_linkage_name of index or of the abstract instance or declaration it refers to, std::nullopt if there is none
+  static std::optional<FormValue> linkageName(DIEIndex const &dieIndex, uint32_t index);
+
+private:
+  // Follows the links like declaration, complete is set to false if one of them points at a DIE not indexed yet
+  static uint32_t declaration(DIEIndex const &dieIndex, uint32_t index, bool &complete);
+  // qualify and scope return false if some DIE the name needs was missing, such names are not memoized
+  bool qualify(DIEIndex const &dieIndex, uint32_t const index, std::string_view &name);
+  bool scope(DIEIndex const &dieIndex, uint32_t parent, std::string_view &name);
+
+  std::mutex mutex_;
+  StringArena arena_;
+  std::vector<std::string_view> names_;
+  std::vector<bool> known_;
+};
+
+#endif
@@ -0,0 +1,143 @@
+#include "RangeList.hpp"
+#include <optional>
+#include <stdexcept>
+#include "ByteReader.hpp"
+#include "DIEIndex.hpp"
+
+namespace {
+enum class RangeListEntry : uint8_t {
+  DW_RLE_end_of_list = 0x00,
+  DW_RLE_base_addressx = 0x01,
+  DW_RLE_startx_endx = 0x02,
+  DW_RLE_startx_length = 0x03,
+  DW_RLE_offset_pair = 0x04,
+  DW_RLE_base_address = 0x05,
+  DW_RLE_start_end = 0x06,
+  DW_RLE_start_length = 0x07,
+};
+} // namespace
+
+std::vector<RangeList::Range> RangeList::read(std::span<uint8_t const> const debugRanges, uint64_t const offset, uint8_t const addressSize, uint64_t baseAddress) {
+  if (offset >= debugRanges.size()) {
+    throw std::runtime_error("range list offset out of .debug_ranges");
+  }
+  if ((addressSize != 4U) && (addressSize != 8U)) {
+    throw std::runtime_error("unsupported address size");
+  }
+  uint64_t const largestAddress = (addressSize == 4U) ? UINT32_MAX : UINT64_MAX;
+  ByteReader reader(debugRanges.data() + offset, debugRanges.size() - static_cast<size_t>(offset));
+  std::vector<Range> ranges;
+  while (true) {
+    uint64_t const start = (addressSize == 4U) ? reader.getNumber<uint32_t>() : reader.getNumber<uint64_t>();
+    uint64_t const end = (addressSize == 4U) ? reader.getNumber<uint32_t>() : reader.getNumber<uint64_t>();
+    if ((start == 0U) && (end == 0U)) {
+      break; // end of list
+    }
+    if (start == largestAddress) {
+      baseAddress = end; // base address selection
+    } else if (end > start) {
+      ranges.push_back(Range{baseAddress + start, baseAddress + end});
+    }
+  }
+  return ranges;
+}
+
+std::vector<RangeList::Range> RangeList::readRangeLists(std::span<uint8_t const> const debugRnglists, uint64_t const offset, UnitInfo const &unit, uint64_t baseAddress) {
+  if (offset >= debugRnglists.size()) {
+    throw std::runtime_error("range list offset out of .debug_rnglists");
+  }
+  if ((unit.addressSize != 4U) && (unit.addressSize != 8U)) {
+    throw std::runtime_error("unsupported address size");
+  }
+  ByteReader reader(debugRnglists.data() + offset, debugRnglists.size() - static_cast<size_t>(offset));
+  std::vector<Range> ranges;
+  while (true) {
+    uint64_t start = 0U;
+    uint64_t end = 0U;
+    RangeListEntry const entry = static_cast<RangeListEntry>(reader.getNumber<uint8_t>());
+    switch (entry) {
+    case (RangeListEntry::DW_RLE_end_of_list): {
+      return ranges;
+    }
+    case (RangeListEntry::DW_RLE_base_addressx): {
+      baseAddress = unit.address(reader.readLEB128(false));
+      continue;
+    }
+    case (RangeListEntry::DW_RLE_startx_endx): {
+      start = unit.address(reader.readLEB128(false));
+      end = unit.address(reader.readLEB128(false));
+      break;
+    }
+    case (RangeListEntry::DW_RLE_startx_length): {
+      start = unit.address(reader.readLEB128(false));
+      end = start + reader.readLEB128(false);
+      break;
+    }
+    case (RangeListEntry::DW_RLE_offset_pair): {
+      start = baseAddress + reader.readLEB128(false);
+      end = baseAddress + reader.readLEB128(false);
+      break;
+    }
+    case (RangeListEntry::DW_RLE_base_address): {
+      baseAddress = (unit.addressSize == 4U) ? reader.getNumber<uint32_t>() : reader.getNumber<uint64_t>();
+      continue;
+    }
+    case (RangeListEntry::DW_RLE_start_end): {
+      start = (unit.addressSize == 4U) ? reader.getNumber<uint32_t>() : reader.getNumber<uint64_t>();
+      end = (unit.addressSize == 4U) ? reader.getNumber<uint32_t>() : reader.getNumber<uint64_t>();
+      break;
+    }
+    case (RangeListEntry::DW_RLE_start_length): {
+      start = (unit.addressSize == 4U) ? reader.getNumber<uint32_t>() : reader.getNumber<uint64_t>();
+      end = start + reader.readLEB128(false);
+      break;
+    }
+    default: {
+      throw std::runtime_error("unknown range list entry");
+    }
+    }
+    if (end > start) {
+      ranges.push_back(Range{start, end});
+    }
+  }
+}
+
+std::vector<RangeList::Range> RangeList::read(DwarfSections const &sections, UnitInfo const &unit, uint64_t const offset, uint64_t const baseAddress) {
+  if (unit.version >= 5U) {
+    return readRangeLists(sections.debugRnglists, offset, unit, baseAddress);
+  }
+  if (sections.debugRanges.empty()) {
+    throw std::runtime_error("DW_AT_ranges without .debug_ranges");
+  }
+  return read(sections.debugRanges, unit.rangeListsBase + offset, unit.addressSize, baseAddress);
+}
+
+std::vector<RangeList::Range> RangeList::ofDIE(DIEIndex const &dieIndex, uint32_t const index) {
+  std::vector<Range> ranges;
+  std::optional<FormValue> const lowPc = dieIndex.attribute(index, DebugAbbrev::AttributeName::DW_AT_low_pc);
+  if (lowPc.has_value()) {
+    std::optional<FormValue> const highPc = dieIndex.attribute(index, DebugAbbrev::AttributeName::DW_AT_high_pc);
+    if (highPc.has_value() && (lowPc->value != 0U)) {
+      // since DWARF4 high_pc may be the size of the range
+      uint64_t const high = (highPc->form == DebugAbbrev::Form::DW_FORM_addr) ? highPc->value : (lowPc->value + highPc->value);
+      if (high > lowPc->value) {
+        ranges.push_back(Range{lowPc->value, high});
+      }
+      return ranges;
+    }
+  }
+  std::optional<FormValue> const rangesValue = dieIndex.attribute(index, DebugAbbrev::AttributeName::DW_AT_ranges);
+  if (!rangesValue.has_value()) {
+    return ranges;
+  }
+  // offsets in the list are relative to the base address of the unit
+  DIEIndex::DIEInfo const &die = dieIndex.at(index);
+  DIEIndex::UnitInfo const &unit = dieIndex.units()[die.unit];
+  std::optional<FormValue> const unitLowPc = dieIndex.attribute(unit.firstDIE, DebugAbbrev::AttributeName::DW_AT_low_pc);
+  for (Range const &range : read(dieIndex.sections(), unit, rangesValue->value, unitLowPc.has_value() ? unitLowPc->value : unit.baseAddress)) {
+    if (range.low != 0U) {
+      ranges.push_back(range);
+    }
+  }
+  return ranges;
+}
@@ -0,0 +1,33 @@
+#ifndef RANGE_LIST_HPP
+#define RANGE_LIST_HPP
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "DwarfSections.hpp"
+#include "UnitInfo.hpp"
+
+class DIEIndex;
+
+// Address ranges of a DIE with DW_AT_ranges, decoded from .debug_ranges or, since DWARF 5, .debug_rnglists
+class RangeList {
+public:
+  struct Range {
+    uint64_t low;
+    uint64_t high; // one past the last address
+  };
+
+  // baseAddress is the DW_AT_low_pc of the unit, base address selection entries in the list replace it
+  static std::vector<Range> read(std::span<uint8_t const> const debugRanges, uint64_t const offset, uint8_t const addressSize, uint64_t baseAddress);
+
+  // The same for a .debug_rnglists list, whose x entries index the address table of unit
+  static std::vector<Range> readRangeLists(std::span<uint8_t const> const debugRnglists, uint64_t const offset, UnitInfo const &unit, uint64_t baseAddress);
+
+  // The list at offset in the range section of the version of unit
+  static std::vector<Range> read(DwarfSections const &sections, UnitInfo const &unit, uint64_t const offset, uint64_t const baseAddress);
+
+  // Code ranges of a DIE, from DW_AT_low_pc/DW_AT_high_pc or DW_AT_ranges. Empty for DIEs without code and for code
+  // the linker dropped, which keeps DW_AT_low_pc 0.
+  static std::vector<Range> ofDIE(DIEIndex const &dieIndex, uint32_t const index);
+};
+
+#endif
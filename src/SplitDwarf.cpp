@@ -0,0 +1,159 @@
+#include "SplitDwarf.hpp"
+#include <stdexcept>
+#include <vector>
+#include "DebugInfo.hpp"
+
+namespace {
+std::span<uint8_t const> cut(std::span<uint8_t const> const section, PackageIndex::Contribution const contribution) {
+  if ((contribution.offset > section.size()) || (contribution.size > (section.size() - contribution.offset))) {
+    throw std::runtime_error("package contribution out of its section");
+  }
+  return section.subspan(contribution.offset, contribution.size);
+}
+} // namespace
+
+SplitDwarf::SplitDwarf(std::string binaryPath, DwarfSections const &sections) : binaryPath_(std::move(binaryPath)), sections_(sections) {
+}
+
+SplitDwarf::Package *SplitDwarf::package() {
+  if (!packageOpened_) {
+    packageOpened_ = true;
+    std::optional<ElfFile> file = ElfFile::open(binaryPath_ + ".dwp");
+    if (file.has_value()) {
+      package_ = std::make_unique<Package>();
+      package_->file = std::move(*file);
+      package_->units = PackageIndex(package_->file.section(".debug_cu_index"));
+      package_->types = PackageIndex(package_->file.section(".debug_tu_index"));
+    }
+  }
+  return package_.get();
+}
+
+SplitDwarf::DwoFile *SplitDwarf::dwoFile(std::string const &path) {
+  std::unordered_map<std::string, std::unique_ptr<DwoFile>>::iterator it = dwoFiles_.find(path);
+  if (it != dwoFiles_.end()) {
+    return it->second.get();
+  }
+  it = dwoFiles_.emplace(path, nullptr).first;
+  std::optional<ElfFile> file = ElfFile::open(path);
+  if (file.has_value()) {
+    it->second = std::make_unique<DwoFile>();
+    it->second->file = std::move(*file);
+    it->second->abbrevs = DebugAbbrev::parseDebugAbbrev(it->second->file.section(".debug_abbrev.dwo"));
+  }
+  return it->second.get();
+}
+
+DwarfSections SplitDwarf::contributions(Package &package, uint16_t const version, PackageIndex::Row const &row, AbbrevSections const *&abbrevs) const {
+  ElfFile const &file = package.file;
+  DwarfSections sections;
+  sections.debugInfo = cut(file.section(".debug_info.dwo"), row.of(PackageIndex::Section::DW_SECT_INFO));
+  std::span<uint8_t const> const debugStr = file.section(".debug_str.dwo");
+  sections.debugStr = debugStr.empty() ? nullptr : reinterpret_cast<char const *>(debugStr.data());
+  sections.debugStrOffsets = cut(file.section(".debug_str_offsets.dwo"), row.of(PackageIndex::Section::DW_SECT_STR_OFFSETS));
+  sections.debugLine = cut(file.section(".debug_line.dwo"), row.of(PackageIndex::Section::DW_SECT_LINE));
+  if (version >= 5U) {
+    sections.debugLoclists = cut(file.section(".debug_loclists.dwo"), row.of(PackageIndex::Section::DW_SECT_LOCLISTS));
+    sections.debugRnglists = cut(file.section(".debug_rnglists.dwo"), row.of(PackageIndex::Section::DW_SECT_RNGLISTS));
+  } else {
+    sections.debugTypes = cut(file.section(".debug_types.dwo"), row.of(PackageIndex::Section::DW_SECT_TYPES));
+    sections.debugLoc = cut(file.section(".debug_loc.dwo"), row.of(PackageIndex::Section::DW_SECT_LOCLISTS));
+  }
+  sections.debugAddr = sections_.debugAddr;
+  sections.debugRanges = sections_.debugRanges;
+
+  // units sharing an abbreviation contribution share its parsed tables
+  PackageIndex::Contribution const abbrevContribution = row.of(PackageIndex::Section::DW_SECT_ABBREV);
+  std::unique_ptr<AbbrevSections> &parsed = package.abbrevs[abbrevContribution.offset];
+  if (!parsed) {
+    parsed = std::make_unique<AbbrevSections>(DebugAbbrev::parseDebugAbbrev(cut(file.section(".debug_abbrev.dwo"), abbrevContribution)));
+  }
+  abbrevs = parsed.get();
+  return sections;
+}
+
+UnitInfo SplitDwarf::complete(UnitInfo unit, DwarfSections const &sections, Skeleton const *const skeleton) {
+  if (unit.version < 5U) {
+    // before DWARF 5 the string offsets have no header, and the unit has no base to start from
+    unit.strOffsets = sections.debugStrOffsets;
+  }
+  if (skeleton == nullptr) {
+    return unit;
+  }
+  if (!unit.isTypeUnit()) {
+    unit.unitType = UnitInfo::UnitType::DW_UT_split_compile; // a DWARF 4 header does not tell
+  }
+  unit.baseAddress = skeleton->lowPc;
+  if (skeleton->unit->version >= 5U) {
+    unit.addresses = skeleton->unit->addresses;
+  } else {
+    unit.addresses = (skeleton->addrBase <= sections.debugAddr.size()) ? sections.debugAddr.subspan(static_cast<size_t>(skeleton->addrBase)) : std::span<uint8_t const>();
+    unit.rangeListsBase = static_cast<uint32_t>(skeleton->rangesBase);
+  }
+  return unit;
+}
+
+std::optional<SplitDwarf::Unit> SplitDwarf::unit(Skeleton const &skeleton) {
+  Package *const dwp = package();
+  if (dwp != nullptr) {
+    std::optional<PackageIndex::Row> const row = dwp->units.find(skeleton.dwoId);
+    if (row.has_value()) {
+      AbbrevSections const *abbrevs = nullptr;
+      DwarfSections const sections = contributions(*dwp, dwp->units.version(), *row, abbrevs);
+      return Unit{sections, abbrevs, complete(DebugInfo::readUnitHeader(sections, *abbrevs, 0U), sections, &skeleton)};
+    }
+  }
+  if (skeleton.dwoName.empty()) {
+    return std::nullopt;
+  }
+
+  std::vector<std::string> paths;
+  if (skeleton.dwoName.front() == '/') {
+    paths.emplace_back(skeleton.dwoName);
+  } else {
+    if (!skeleton.compDir.empty()) {
+      paths.push_back(std::string(skeleton.compDir) + "/" + std::string(skeleton.dwoName));
+    }
+    size_t const slash = binaryPath_.rfind('/');
+    paths.push_back(((slash == std::string::npos) ? std::string() : binaryPath_.substr(0U, slash + 1U)) + std::string(skeleton.dwoName));
+  }
+  for (std::string const &path : paths) {
+    DwoFile *const dwo = dwoFile(path);
+    if (dwo == nullptr) {
+      continue;
+    }
+    DwarfSections sections;
+    sections.debugInfo = dwo->file.section(".debug_info.dwo");
+    sections.debugTypes = dwo->file.section(".debug_types.dwo");
+    std::span<uint8_t const> const debugStr = dwo->file.section(".debug_str.dwo");
+    sections.debugStr = debugStr.empty() ? nullptr : reinterpret_cast<char const *>(debugStr.data());
+    sections.debugStrOffsets = dwo->file.section(".debug_str_offsets.dwo");
+    sections.debugLine = dwo->file.section(".debug_line.dwo");
+    sections.debugLoc = dwo->file.section(".debug_loc.dwo");
+    sections.debugLoclists = dwo->file.section(".debug_loclists.dwo");
+    sections.debugRnglists = dwo->file.section(".debug_rnglists.dwo");
+    sections.debugAddr = sections_.debugAddr;
+    sections.debugRanges = sections_.debugRanges;
+    // a .dwo holds one compile unit; DWARF 5 lets us check that it is the right one
+    for (UnitInfo const &candidate : DebugInfo::readUnitHeaders(sections, dwo->abbrevs)) {
+      if (!candidate.isTypeUnit() && ((candidate.version < 5U) || (candidate.signature == skeleton.dwoId))) {
+        return Unit{sections, &dwo->abbrevs, complete(candidate, sections, &skeleton)};
+      }
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<SplitDwarf::Unit> SplitDwarf::typeUnit(uint64_t const signature) {
+  Package *const dwp = package();
+  if (dwp == nullptr) {
+    return std::nullopt;
+  }
+  std::optional<PackageIndex::Row> const row = dwp->types.find(signature);
+  if (!row.has_value()) {
+    return std::nullopt;
+  }
+  AbbrevSections const *abbrevs = nullptr;
+  DwarfSections const sections = contributions(*dwp, dwp->types.version(), *row, abbrevs);
+  return Unit{sections, abbrevs, complete(DebugInfo::readUnitHeader(sections, *abbrevs, 0U), sections, nullptr)};
+}
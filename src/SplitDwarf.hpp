@@ -0,0 +1,82 @@
+#ifndef SPLIT_DWARF_HPP
+#define SPLIT_DWARF_HPP
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "DebugAbbrev.hpp"
+#include "DwarfSections.hpp"
+#include "ElfFile.hpp"
+#include "PackageIndex.hpp"
+#include "UnitInfo.hpp"
+
+// Finds the split units of a binary built with -gsplit-dwarf. The binary only holds skeleton units; the DIEs live in a
+// .dwo file per unit or in a package of all of them, <binary>.dwp, whose .debug_cu_index and .debug_tu_index map DWO
+// ids and type signatures to the contributions of the unit. Files are mapped when a query first needs one of their
+// units, so looking at a few addresses of a large binary touches a few .dwo files and not the whole debug info.
+class SplitDwarf {
+public:
+  using AbbrevSections = std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable>;
+
+  // What the unit DIE of a skeleton says about its split unit
+  struct Skeleton {
+    UnitInfo const *unit;
+    std::string_view dwoName; // DW_AT_dwo_name or DW_AT_GNU_dwo_name
+    std::string_view compDir;
+    uint64_t dwoId;           // DWARF 5 has it in the unit header, DWARF 4 in DW_AT_GNU_dwo_id
+    uint64_t lowPc;
+    uint64_t addrBase;        // DW_AT_GNU_addr_base; DW_AT_addr_base of DWARF 5 already set unit->addresses
+    uint64_t rangesBase;      // DW_AT_GNU_ranges_base
+  };
+
+  // A split unit ready to be decoded. Its sections are those of the .dwo file, cut to the contributions of the unit
+  // in a package, together with .debug_addr and .debug_ranges of the binary. The header has the indirection tables
+  // the skeleton provides.
+  struct Unit {
+    DwarfSections sections;
+    AbbrevSections const *debugAbbrevSections;
+    UnitInfo info;
+  };
+
+  // The package is looked for at binaryPath + ".dwp"; sections are those of the binary
+  SplitDwarf(std::string binaryPath, DwarfSections const &sections);
+
+  // The package is consulted first, then the .dwo file named by the skeleton, relative to its DW_AT_comp_dir and then
+  // to the directory of the binary. nullopt if none of them has the unit.
+  std::optional<Unit> unit(Skeleton const &skeleton);
+
+  // Split type unit of a package, for resolving DW_FORM_ref_sig8 in split units. nullopt without a package.
+  std::optional<Unit> typeUnit(uint64_t const signature);
+
+private:
+  struct DwoFile {
+    ElfFile file;
+    AbbrevSections abbrevs;
+  };
+
+  struct Package {
+    ElfFile file;
+    PackageIndex units;
+    PackageIndex types;
+    std::unordered_map<uint32_t, std::unique_ptr<AbbrevSections>> abbrevs; // by offset of the contribution
+  };
+
+  Package *package();
+  DwoFile *dwoFile(std::string const &path);
+  // Sections of a package unit, an exception for contributions outside their section. version is that of the index.
+  DwarfSections contributions(Package &package, uint16_t const version, PackageIndex::Row const &row, AbbrevSections const *&abbrevs) const;
+  // Completes the header of a split unit with the tables of its skeleton, if it has one
+  static UnitInfo complete(UnitInfo unit, DwarfSections const &sections, Skeleton const *const skeleton);
+
+  std::string binaryPath_;
+  DwarfSections sections_;
+  bool packageOpened_ = false;
+  std::unique_ptr<Package> package_;
+  std::unordered_map<std::string, std::unique_ptr<DwoFile>> dwoFiles_; // nullptr for files which could not be opened
+};
+
+#endif
@@ -0,0 +1,49 @@
+#include "StringArena.hpp"
+#include <cstring>
+#include <initializer_list>
+
+char *StringArena::allocate(size_t const size) {
+  if (size > blockSize_ / 4U) {
+    // the remainder of the current block stays available for small strings
+    largeBlocks_.push_back(std::make_unique<char[]>(size));
+    largeBytes_ += size;
+    return largeBlocks_.back().get();
+  }
+  if (used_ + size > capacity_) {
+    blocks_.push_back(std::make_unique<char[]>(blockSize_));
+    used_ = 0U;
+    capacity_ = blockSize_;
+  }
+  char *const result = blocks_.back().get() + used_;
+  used_ += size;
+  return result;
+}
+
+std::string_view StringArena::store(std::string_view const str) {
+  if (str.empty()) {
+    return std::string_view();
+  }
+  char *const destination = allocate(str.size());
+  memcpy(destination, str.data(), str.size());
+  return std::string_view(destination, str.size());
+}
+
+std::string_view StringArena::concat(std::string_view const first, std::string_view const second, std::string_view const third) {
+  size_t const size = first.size() + second.size() + third.size();
+  if (size == 0U) {
+    return std::string_view();
+  }
+  char *const destination = allocate(size);
+  char *cursor = destination;
+  for (std::string_view const part : {first, second, third}) {
+    if (!part.empty()) {
+      memcpy(cursor, part.data(), part.size());
+      cursor += part.size();
+    }
+  }
+  return std::string_view(destination, size);
+}
+
+size_t StringArena::bytesAllocated() const noexcept {
+  return (blocks_.size() * blockSize_) + largeBytes_;
+}
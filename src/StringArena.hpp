@@ -0,0 +1,33 @@
+#ifndef STRING_ARENA_HPP
+#define STRING_ARENA_HPP
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Append-only character storage. Strings are copied into large blocks which are never moved or freed before the
+// arena itself, so the returned views stay valid for the lifetime of the arena.
+class StringArena {
+public:
+  explicit StringArena(size_t const blockSize = 64U * 1024U) : blockSize_(blockSize), used_(0U), capacity_(0U) {
+  }
+
+  std::string_view store(std::string_view const str);
+
+  // Stores the concatenation without building a temporary string
+  std::string_view concat(std::string_view const first, std::string_view const second, std::string_view const third = std::string_view());
+
+  size_t bytesAllocated() const noexcept;
+
+private:
+  char *allocate(size_t const size);
+
+  size_t blockSize_;
+  size_t used_;
+  size_t capacity_;
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  std::vector<std::unique_ptr<char[]>> largeBlocks_; // strings larger than a quarter block get their own allocation
+  size_t largeBytes_ = 0U;
+};
+
+#endif
@@ -0,0 +1,57 @@
+#include "StringPool.hpp"
+#include <functional>
+#include <stdexcept>
+
+StringPool::StringPool(char const *const debugStr) : debugStr_(debugStr), shards_(std::make_unique<Shard[]>(size_t{1U} << shardBits)) {
+}
+
+StringPool::Handle StringPool::handle(DwarfSections const &sections, FormValue const &formValue) {
+  // a .debug_str offset is a handle of its own unless it collides with the interned ones
+  if ((formValue.form == DebugAbbrev::Form::DW_FORM_strp) && (sections.debugStr == debugStr_) && (debugStr_ != nullptr) && (formValue.value < internedFlag)) {
+    return (debugStr_[formValue.value] == '\0') ? noString : static_cast<Handle>(formValue.value);
+  }
+  return intern(sections.string(formValue));
+}
+
+StringPool::Handle StringPool::intern(std::string_view const str) {
+  if (str.empty()) {
+    return noString;
+  }
+  size_t const hashValue = std::hash<std::string_view>{}(str);
+  uint32_t const shardIndex = static_cast<uint32_t>(hashValue >> ((sizeof(size_t) * 8U) - shardBits));
+  Shard &shard = shards_[shardIndex];
+  std::lock_guard<std::mutex> const lock(shard.mutex);
+  std::unordered_map<std::string_view, Handle>::const_iterator const it = shard.handles.find(str);
+  if (it != shard.handles.end()) {
+    return it->second;
+  }
+  // the last index of the last shard would be noString
+  if (shard.strings.size() >= ((size_t{1U} << indexBits) - 1U)) {
+    throw std::runtime_error("too many distinct strings to intern");
+  }
+  Handle const handle = internedFlag | (shardIndex << indexBits) | static_cast<Handle>(shard.strings.size());
+  shard.strings.push_back(str);
+  shard.handles.emplace(str, handle);
+  return handle;
+}
+
+std::string_view StringPool::view(Handle const handle) const noexcept {
+  if (handle == noString) {
+    return std::string_view();
+  }
+  if (!isInterned(handle)) {
+    return std::string_view(debugStr_ + handle);
+  }
+  Shard const &shard = shards_[(handle & ~internedFlag) >> indexBits];
+  return shard.strings[handle & ((1U << indexBits) - 1U)];
+}
+
+bool StringPool::equal(Handle const lhs, Handle const rhs) const noexcept {
+  if (lhs == rhs) {
+    return true;
+  }
+  if ((isInterned(lhs) && isInterned(rhs)) || (lhs == noString) || (rhs == noString)) {
+    return false;
+  }
+  return view(lhs) == view(rhs);
+}
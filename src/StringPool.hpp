@@ -0,0 +1,57 @@
+#ifndef STRING_POOL_HPP
+#define STRING_POOL_HPP
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "DwarfSections.hpp"
+#include "FormValue.hpp"
+
+// DIE names as 32-bit handles. A string in .debug_str is named by its offset and never copied. Any other string, inline
+// DW_FORM_string above all, is interned in a hash set: the first occurrence gets a handle and every equal string found
+// later gets the same one. Interned entries view the section data too, so no characters are copied at all; the sections
+// must outlive the pool.
+// intern() may be called from any number of threads at once, the set is sharded by hash with a mutex per shard. view()
+// does not lock, it must not run while strings are still being interned.
+class StringPool {
+public:
+  using Handle = uint32_t;
+  static Handle constexpr noString = UINT32_MAX; // no string, or an empty one
+
+  explicit StringPool(char const *const debugStr);
+
+  // Handle of the value of a string form, noString for other forms
+  Handle handle(DwarfSections const &sections, FormValue const &formValue);
+
+  // Handle of str, which must stay valid as long as the pool
+  Handle intern(std::string_view const str);
+
+  std::string_view view(Handle const handle) const noexcept;
+
+  // Equal handles always mean equal strings. Interned strings are unique, so two of them differ if their handles do;
+  // only a .debug_str string can equal a string with a different handle, e.g. one the linker did not merge.
+  bool equal(Handle const lhs, Handle const rhs) const noexcept;
+
+private:
+  static uint32_t constexpr shardBits = 6U;
+  static uint32_t constexpr indexBits = 31U - shardBits;
+  static Handle constexpr internedFlag = 1U << 31U; // handles below are .debug_str offsets
+
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<std::string_view, Handle> handles;
+    std::vector<std::string_view> strings;
+  };
+
+  inline static bool isInterned(Handle const handle) noexcept {
+    return (handle & internedFlag) != 0U;
+  }
+
+  char const *debugStr_;
+  std::unique_ptr<Shard[]> shards_;
+};
+
+#endif
@@ -0,0 +1,534 @@
+#include "StructLayout.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <unordered_set>
+#include "ByteReader.hpp"
+#include "DIEIndex.hpp"
+#include "DebugInfo.hpp"
+#include "Parallel.hpp"
+#include "QualifiedNames.hpp"
+#include "StringArena.hpp"
+#include "TypeDedup.hpp"
+#include "TypeNames.hpp"
+#include "UnitCache.hpp"
+#include "UnitFingerprints.hpp"
+
+struct StructLayout::Names {
+  TypeNames typeNames;
+  QualifiedNames qualifiedNames;
+  StringArena cachedNames; // of the layouts read from a UnitCache
+};
+
+namespace {
+using AttributeName = DebugAbbrev::AttributeName;
+using Tag = DebugAbbrev::Tag;
+
+uint8_t constexpr opPlusUconst = 0x23U; // DW_OP_plus_uconst, how DWARF 2 producers give a member offset
+uint64_t constexpr recordVersion = 1U;  // of the unit records in a UnitCache, part of their key
+uint32_t constexpr maxTypeDepth = 64U;  // longer typedef and qualifier chains are taken as cycles in malformed input
+
+std::optional<uint64_t> constant(DIEIndex const &dieIndex, uint32_t const index, AttributeName const attributeName) {
+  std::optional<FormValue> const formValue = dieIndex.attribute(index, attributeName);
+  if (!formValue.has_value() || !formValue->isConstant()) {
+    return std::nullopt;
+  }
+  return formValue->value;
+}
+
+bool hasFlag(DIEIndex const &dieIndex, uint32_t const index, AttributeName const attributeName) {
+  std::optional<FormValue> const formValue = dieIndex.attribute(index, attributeName);
+  return formValue.has_value() && (formValue->value != 0U);
+}
+
+// Size in bytes of the type DIE at typeOffset
+std::optional<uint64_t> byteSize(DIEIndex const &dieIndex, uint32_t const typeOffset, uint32_t const depth = 0U) {
+  uint32_t const index = (typeOffset == 0U) ? DIEIndex::invalidIndex : dieIndex.findIndex(typeOffset);
+  if ((index == DIEIndex::invalidIndex) || (depth > maxTypeDepth)) {
+    return std::nullopt;
+  }
+  std::optional<uint64_t> const size = constant(dieIndex, index, AttributeName::DW_AT_byte_size);
+  if (size.has_value()) {
+    return size;
+  }
+  DIEIndex::DIEInfo const &die = dieIndex.at(index);
+  switch (die.tag) {
+  case (Tag::DW_TAG_pointer_type):
+  case (Tag::DW_TAG_reference_type):
+  case (Tag::DW_TAG_rvalue_reference_type): {
+    return dieIndex.units()[die.unit].addressSize;
+  }
+  case (Tag::DW_TAG_typedef):
+  case (Tag::DW_TAG_const_type):
+  case (Tag::DW_TAG_volatile_type):
+  case (Tag::DW_TAG_restrict_type):
+  case (Tag::DW_TAG_atomic_type):
+  case (Tag::DW_TAG_enumeration_type): {
+    return byteSize(dieIndex, die.typeOffset, depth + 1U);
+  }
+  case (Tag::DW_TAG_array_type): {
+    std::optional<uint64_t> const elementSize = byteSize(dieIndex, die.typeOffset, depth + 1U);
+    if (!elementSize.has_value()) {
+      return std::nullopt;
+    }
+    uint64_t elements = 1U;
+    for (uint32_t child = dieIndex.firstChild(index); child != DIEIndex::invalidIndex; child = dieIndex.at(child).sibling) {
+      if (dieIndex.at(child).tag != Tag::DW_TAG_subrange_type) {
+        continue;
+      }
+      std::optional<uint64_t> count = constant(dieIndex, child, AttributeName::DW_AT_count);
+      if (!count.has_value()) {
+        // a flexible array member has no upper bound and takes no space
+        std::optional<uint64_t> const upperBound = constant(dieIndex, child, AttributeName::DW_AT_upper_bound);
+        uint64_t const lowerBound = constant(dieIndex, child, AttributeName::DW_AT_lower_bound).value_or(0U);
+        count = (upperBound.has_value() && (*upperBound >= lowerBound)) ? (*upperBound - lowerBound + 1U) : 0U;
+      }
+      elements *= *count;
+    }
+    return *elementSize * elements;
+  }
+  default: {
+    return std::nullopt;
+  }
+  }
+}
+
+// Byte offset of a member or base class, nullopt for a location computed at run time such as that of a virtual base
+std::optional<uint64_t> memberLocation(DIEIndex const &dieIndex, uint32_t const index) {
+  std::optional<FormValue> const location = dieIndex.attribute(index, AttributeName::DW_AT_data_member_location);
+  if (!location.has_value()) {
+    return 0U; // union members and DWARF 4 bitfields with DW_AT_data_bit_offset leave it out
+  }
+  if (location->isConstant()) {
+    return location->value;
+  }
+  if (location->isBlock() && (location->size > 1U) && (location->data[0] == opPlusUconst)) {
+    ByteReader reader(location->data + 1, static_cast<size_t>(location->size - 1U));
+    return reader.readLEB128(false);
+  }
+  return std::nullopt;
+}
+
+std::optional<StructLayout::Member> member(DIEIndex const &dieIndex, uint32_t const index, TypeNames &typeNames) {
+  DIEIndex::DIEInfo const &die = dieIndex.at(index);
+  std::optional<uint64_t> const location = memberLocation(dieIndex, index);
+  if (!location.has_value()) {
+    return std::nullopt;
+  }
+  StructLayout::Member result{dieIndex.name(index), typeNames.name(dieIndex, die.typeOffset), *location * 8U, 0U, true, false, die.tag == Tag::DW_TAG_inheritance};
+  if (result.base) {
+    result.name = result.typeName;
+  }
+  std::optional<uint64_t> const typeSize = byteSize(dieIndex, die.typeOffset);
+  std::optional<uint64_t> const bitSize = constant(dieIndex, index, AttributeName::DW_AT_bit_size);
+  if (!bitSize.has_value()) {
+    result.bitSize = typeSize.value_or(0U) * 8U;
+    result.sized = typeSize.has_value();
+    return result;
+  }
+
+  result.bitfield = true;
+  result.bitSize = *bitSize;
+  std::optional<uint64_t> const dataBitOffset = constant(dieIndex, index, AttributeName::DW_AT_data_bit_offset);
+  if (dataBitOffset.has_value()) {
+    result.bitOffset = *dataBitOffset;
+    return result;
+  }
+  // DWARF 2 counts DW_AT_bit_offset from the most significant bit of the storage unit, which on a little endian target
+  // is its last byte
+  std::optional<uint64_t> const bitOffset = constant(dieIndex, index, AttributeName::DW_AT_bit_offset);
+  uint64_t const storageBits = constant(dieIndex, index, AttributeName::DW_AT_byte_size).value_or(typeSize.value_or(0U)) * 8U;
+  if (bitOffset.has_value() && (storageBits >= (*bitOffset + *bitSize))) {
+    result.bitOffset += storageBits - *bitOffset - *bitSize;
+  }
+  return result;
+}
+
+StructLayout::Layout layOut(DIEIndex const &dieIndex, uint32_t const index, uint64_t const size, uint32_t const cacheLineSize, TypeNames &typeNames,
+                            QualifiedNames &qualifiedNames) {
+  DIEIndex::DIEInfo const &die = dieIndex.at(index);
+  StructLayout::Layout layout{die.offset, die.tag, qualifiedNames.name(dieIndex, index), size, {}, {}, 0U, {}};
+  for (uint32_t child = dieIndex.firstChild(index); child != DIEIndex::invalidIndex; child = dieIndex.at(child).sibling) {
+    Tag const tag = dieIndex.at(child).tag;
+    // static data members are DW_TAG_member declarations up to DWARF 4
+    if (((tag != Tag::DW_TAG_member) && (tag != Tag::DW_TAG_inheritance)) || hasFlag(dieIndex, child, AttributeName::DW_AT_declaration) ||
+        hasFlag(dieIndex, child, AttributeName::DW_AT_external)) {
+      continue;
+    }
+    std::optional<StructLayout::Member> const placed = member(dieIndex, child, typeNames);
+    if (placed.has_value()) {
+      layout.members.push_back(*placed);
+    }
+  }
+  std::stable_sort(layout.members.begin(), layout.members.end(), [](StructLayout::Member const &lhs, StructLayout::Member const &rhs) {
+    return lhs.bitOffset < rhs.bitOffset;
+  });
+
+  // union members all start at 0, so they never leave a hole
+  uint64_t const lineBits = static_cast<uint64_t>(cacheLineSize) * 8U;
+  uint64_t end = 0U;
+  for (size_t i = 0U; i < layout.members.size(); i++) {
+    StructLayout::Member const &placed = layout.members[i];
+    if (placed.bitOffset > end) {
+      layout.holes.push_back(StructLayout::Hole{end, placed.bitOffset - end, i});
+    }
+    end = std::max(end, placed.bitOffset + placed.bitSize);
+    if ((placed.bitSize != 0U) && ((placed.bitOffset / lineBits) != ((placed.bitOffset + placed.bitSize - 1U) / lineBits))) {
+      layout.straddling.push_back(i);
+    }
+  }
+  layout.paddingBits = ((size * 8U) > end) ? ((size * 8U) - end) : 0U;
+  return layout;
+}
+
+// The structs, classes and unions defined in unit for which keep(index) holds
+template <typename Keep>
+std::vector<StructLayout::Layout> layOutUnit(DIEIndex const &dieIndex, DIEIndex::UnitInfo const &unit, uint32_t const cacheLineSize, TypeNames &typeNames,
+                                             QualifiedNames &qualifiedNames, Keep const &keep) {
+  std::vector<StructLayout::Layout> layouts;
+  for (uint32_t i = unit.firstDIE; i < unit.endDIE; i++) {
+    Tag const tag = dieIndex.at(i).tag;
+    if ((tag != Tag::DW_TAG_structure_type) && (tag != Tag::DW_TAG_class_type) && (tag != Tag::DW_TAG_union_type)) {
+      continue;
+    }
+    std::optional<uint64_t> const size = constant(dieIndex, i, AttributeName::DW_AT_byte_size);
+    if (!size.has_value() || hasFlag(dieIndex, i, AttributeName::DW_AT_declaration) || !keep(i)) {
+      continue;
+    }
+    layouts.push_back(layOut(dieIndex, i, *size, cacheLineSize, typeNames, qualifiedNames));
+  }
+  return layouts;
+}
+
+template <typename T>
+void append(std::vector<uint8_t> &out, T const value) {
+  uint8_t bytes[sizeof(T)];
+  memcpy(bytes, &value, sizeof(T));
+  out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+void appendText(std::vector<uint8_t> &out, std::string_view const text) {
+  append(out, static_cast<uint32_t>(text.size()));
+  out.insert(out.end(), text.begin(), text.end());
+}
+
+std::string_view readText(ByteReader &reader, StringArena &arena) {
+  uint32_t const size = reader.getNumber<uint32_t>();
+  if (size > static_cast<size_t>(reader.end_ - reader.cursor_)) {
+    throw std::runtime_error("unit cache record too short");
+  }
+  std::string_view const text = arena.store(std::string_view(reinterpret_cast<char const *>(reader.cursor_), size));
+  reader.step(size);
+  return text;
+}
+
+// Everything but the DIE offset, which moves with the unit; equal bytes print the same layout
+void appendContent(std::vector<uint8_t> &out, StructLayout::Layout const &layout) {
+  append(out, static_cast<uint16_t>(layout.tag));
+  appendText(out, layout.name);
+  append(out, layout.size);
+  append(out, static_cast<uint32_t>(layout.members.size()));
+  for (StructLayout::Member const &placed : layout.members) {
+    appendText(out, placed.name);
+    appendText(out, placed.typeName);
+    append(out, placed.bitOffset);
+    append(out, placed.bitSize);
+    append(out, static_cast<uint8_t>((placed.sized ? 1U : 0U) | (placed.bitfield ? 2U : 0U) | (placed.base ? 4U : 0U)));
+  }
+  append(out, static_cast<uint32_t>(layout.holes.size()));
+  for (StructLayout::Hole const &hole : layout.holes) {
+    append(out, hole.bitOffset);
+    append(out, hole.bits);
+    append(out, static_cast<uint64_t>(hole.before));
+  }
+  append(out, layout.paddingBits);
+  append(out, static_cast<uint32_t>(layout.straddling.size()));
+  for (size_t const straddling : layout.straddling) {
+    append(out, static_cast<uint64_t>(straddling));
+  }
+}
+
+// The layouts of one unit: their count, then per layout the unit relative DIE offset and the content
+std::vector<uint8_t> writeRecord(std::vector<StructLayout::Layout> const &layouts, uint32_t const unitOffset) {
+  std::vector<uint8_t> record;
+  append(record, static_cast<uint64_t>(layouts.size()));
+  for (StructLayout::Layout const &layout : layouts) {
+    append(record, layout.dieOffset - unitOffset);
+    appendContent(record, layout);
+  }
+  return record;
+}
+
+std::vector<StructLayout::Layout> readRecord(std::span<uint8_t const> const record, uint32_t const unitOffset, StringArena &arena) {
+  ByteReader reader(record.data(), record.size());
+  std::vector<StructLayout::Layout> layouts(static_cast<size_t>(reader.getNumber<uint64_t>()));
+  for (StructLayout::Layout &layout : layouts) {
+    layout.dieOffset = unitOffset + reader.getNumber<uint32_t>();
+    layout.tag = static_cast<Tag>(reader.getNumber<uint16_t>());
+    layout.name = readText(reader, arena);
+    layout.size = reader.getNumber<uint64_t>();
+    layout.members.resize(reader.getNumber<uint32_t>());
+    for (StructLayout::Member &placed : layout.members) {
+      placed.name = readText(reader, arena);
+      placed.typeName = readText(reader, arena);
+      placed.bitOffset = reader.getNumber<uint64_t>();
+      placed.bitSize = reader.getNumber<uint64_t>();
+      uint8_t const flags = reader.getNumber<uint8_t>();
+      placed.sized = (flags & 1U) != 0U;
+      placed.bitfield = (flags & 2U) != 0U;
+      placed.base = (flags & 4U) != 0U;
+    }
+    layout.holes.resize(reader.getNumber<uint32_t>());
+    for (StructLayout::Hole &hole : layout.holes) {
+      hole.bitOffset = reader.getNumber<uint64_t>();
+      hole.bits = reader.getNumber<uint64_t>();
+      hole.before = static_cast<size_t>(reader.getNumber<uint64_t>());
+    }
+    layout.paddingBits = reader.getNumber<uint64_t>();
+    layout.straddling.resize(reader.getNumber<uint32_t>());
+    for (size_t &straddling : layout.straddling) {
+      straddling = static_cast<size_t>(reader.getNumber<uint64_t>());
+    }
+  }
+  return layouts;
+}
+
+std::string_view keyword(Tag const tag) noexcept {
+  switch (tag) {
+  case (Tag::DW_TAG_class_type): {
+    return "class";
+  }
+  case (Tag::DW_TAG_union_type): {
+    return "union";
+  }
+  default: {
+    return "struct";
+  }
+  }
+}
+
+// Bits as "3 bytes" or, if not whole bytes, "27 bits"
+std::string amount(uint64_t const bits) {
+  return ((bits % 8U) == 0U) ? (std::to_string(bits / 8U) + " bytes") : (std::to_string(bits) + " bits");
+}
+
+void writeJsonString(std::ostream &out, std::string_view const text) {
+  out << '"';
+  for (char const c : text) {
+    if ((c == '"') || (c == '\\')) {
+      out << '\\' << c;
+    } else if (static_cast<uint8_t>(c) < 0x20U) {
+      out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<uint32_t>(c) << std::dec << std::setfill(' ');
+    } else {
+      out << c;
+    }
+  }
+  out << '"';
+}
+} // namespace
+
+StructLayout::StructLayout(uint32_t const cacheLineSize) noexcept : cacheLineSize_(cacheLineSize) {
+}
+
+StructLayout::StructLayout(StructLayout &&other) noexcept = default;
+StructLayout &StructLayout::operator=(StructLayout &&other) noexcept = default;
+StructLayout::~StructLayout() = default;
+
+StructLayout StructLayout::analyze(DIEIndex const &dieIndex, TypeDedup const &typeDedup, uint32_t const cacheLineSize) {
+  StructLayout result(cacheLineSize);
+  std::vector<DIEIndex::UnitInfo> const &units = dieIndex.units();
+  size_t const workers = Parallel::workerCount(units.size());
+  for (size_t worker = 0U; worker < workers; worker++) {
+    result.names_.push_back(std::make_unique<Names>());
+  }
+
+  std::vector<std::vector<Layout>> unitLayouts(units.size());
+  Parallel::forEach(units.size(), [&](size_t const unitIndex, size_t const worker) {
+    Names &names = *result.names_[worker];
+    unitLayouts[unitIndex] = layOutUnit(dieIndex, units[unitIndex], cacheLineSize, names.typeNames, names.qualifiedNames, [&](uint32_t const index) {
+      return typeDedup.isCanonical(dieIndex.at(index).offset);
+    });
+  });
+
+  result.addDistinct(unitLayouts);
+  return result;
+}
+
+StructLayout StructLayout::analyze(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections, UnitCache &cache,
+                                   uint32_t const cacheLineSize) {
+  StructLayout result(cacheLineSize);
+  std::vector<DIEIndex::UnitInfo> const units = DebugInfo::readUnitHeaders(sections, debugAbbrevSections);
+  UnitFingerprints const fingerprints = UnitFingerprints::compute(sections, debugAbbrevSections, units);
+  size_t const workers = Parallel::workerCount(units.size());
+  for (size_t worker = 0U; worker < workers; worker++) {
+    result.names_.push_back(std::make_unique<Names>());
+  }
+  result.unitCount_ = units.size();
+
+  // a changed unit is decoded with the units it references and with all type units, which DW_FORM_ref_sig8 may name
+  std::vector<uint64_t> keys(units.size());
+  std::vector<std::optional<std::span<uint8_t const>>> records(units.size());
+  std::vector<bool> changed(units.size(), false);
+  std::vector<bool> decode(units.size(), false);
+  for (size_t i = 0U; i < units.size(); i++) {
+    keys[i] = (fingerprints.fingerprint(i) ^ (static_cast<uint64_t>(cacheLineSize) * 0x9e3779b97f4a7c15U)) + recordVersion;
+    records[i] = cache.find(keys[i]);
+    if (records[i].has_value()) {
+      result.reusedUnits_++;
+      continue;
+    }
+    changed[i] = true;
+    decode[i] = true;
+    for (size_t const reached : fingerprints.reachable(i)) {
+      decode[reached] = true;
+    }
+  }
+  std::vector<uint32_t> unitOffsets;
+  for (size_t i = 0U; i < units.size(); i++) {
+    if (decode[i] || ((result.reusedUnits_ != units.size()) && units[i].isTypeUnit())) {
+      unitOffsets.push_back(units[i].offset);
+    }
+  }
+
+  std::vector<std::vector<Layout>> unitLayouts(units.size());
+  std::vector<std::vector<uint8_t>> newRecords(units.size());
+  Parallel::forEach(units.size(), [&](size_t const unitIndex, size_t const worker) {
+    if (records[unitIndex].has_value()) {
+      unitLayouts[unitIndex] = readRecord(*records[unitIndex], units[unitIndex].offset, result.names_[worker]->cachedNames);
+    }
+  });
+  if (!unitOffsets.empty()) {
+    DIEIndex const dieIndex = DebugInfo::buildDIEIndex(sections, debugAbbrevSections, unitOffsets);
+    std::vector<DIEIndex::UnitInfo> const &decoded = dieIndex.units();
+    // type names view into the index as well, the new layouts are read back from their records to outlive it
+    Parallel::forEach(decoded.size(), [&](size_t const decodedIndex, size_t const worker) {
+      size_t const unitIndex = static_cast<size_t>(std::lower_bound(units.begin(), units.end(), decoded[decodedIndex].offset, [](DIEIndex::UnitInfo const &unit, uint32_t const offset) {
+                                                     return unit.offset < offset;
+                                                   }) -
+                                                   units.begin());
+      if (!changed[unitIndex]) {
+        return;
+      }
+      Names &names = *result.names_[worker];
+      newRecords[unitIndex] = writeRecord(layOutUnit(dieIndex, decoded[decodedIndex], cacheLineSize, names.typeNames, names.qualifiedNames, [](uint32_t) {
+                                            return true;
+                                          }),
+                                          units[unitIndex].offset);
+      unitLayouts[unitIndex] = readRecord(newRecords[unitIndex], units[unitIndex].offset, names.cachedNames);
+    });
+  }
+  for (size_t i = 0U; i < units.size(); i++) {
+    if (changed[i]) {
+      cache.store(keys[i], newRecords[i].empty() ? writeRecord({}, units[i].offset) : std::move(newRecords[i]));
+    }
+  }
+
+  // without an index of all units there is no TypeDedup; a type repeated in several units has the same layout in each
+  result.addDistinct(unitLayouts);
+  return result;
+}
+
+void StructLayout::addDistinct(std::vector<std::vector<Layout>> &unitLayouts) {
+  // TypeDedup keeps types apart which differ in more than their layout, like DW_AT_alignment of a -gstrict-dwarf unit
+  std::unordered_set<std::string> seen;
+  std::vector<uint8_t> content;
+  for (std::vector<Layout> &layouts : unitLayouts) {
+    for (Layout &layout : layouts) {
+      content.clear();
+      appendContent(content, layout);
+      if (seen.emplace(reinterpret_cast<char const *>(content.data()), content.size()).second) {
+        layouts_.push_back(std::move(layout));
+      }
+    }
+  }
+}
+
+uint64_t StructLayout::sumHoleBits(Layout const &layout) noexcept {
+  uint64_t sum = 0U;
+  for (Hole const &hole : layout.holes) {
+    sum += hole.bits;
+  }
+  return sum;
+}
+
+void StructLayout::print(std::ostream &out) const {
+  uint64_t const lineBits = static_cast<uint64_t>(cacheLineSize_) * 8U;
+  for (Layout const &layout : layouts_) {
+    out << keyword(layout.tag) << " " << layout.name << " {\n";
+    size_t hole = 0U;
+    uint64_t line = 0U;
+    uint64_t memberBits = 0U;
+    for (size_t i = 0U; i < layout.members.size(); i++) {
+      Member const &placed = layout.members[i];
+      for (; (hole < layout.holes.size()) && (layout.holes[hole].before == i); hole++) {
+        out << "\t/* XXX " << amount(layout.holes[hole].bits) << " hole, try to pack */\n";
+      }
+      for (; ((line + 1U) * lineBits) <= placed.bitOffset; line++) {
+        out << "\t/* --- cacheline " << (line + 1U) << " boundary (" << ((line + 1U) * cacheLineSize_) << " bytes) --- */\n";
+      }
+      std::string declarator = placed.base ? std::string("<ancestor>") : std::string(placed.name);
+      if (placed.bitfield) {
+        declarator += ":" + std::to_string(placed.bitSize);
+      }
+      declarator += ";";
+      out << "\t" << std::left << std::setw(26) << placed.typeName << " " << std::setw(21) << declarator << std::right << " /* " << std::setw(5) << (placed.bitOffset / 8U);
+      if (placed.bitfield) {
+        out << ":" << std::setw(2) << (placed.bitOffset % 8U) << " " << std::setw(2) << placed.bitSize << " bits */\n";
+      } else if (!placed.sized) {
+        out << "     ? */\n";
+      } else {
+        out << " " << std::setw(5) << (placed.bitSize / 8U) << " */\n";
+      }
+      memberBits += placed.bitSize;
+    }
+    if (!layout.straddling.empty()) {
+      out << "\t/* crossing a cache line:";
+      for (size_t const index : layout.straddling) {
+        out << " " << layout.members[index].name;
+      }
+      out << " */\n";
+    }
+    uint64_t const lastLine = layout.size % cacheLineSize_;
+    out << "\n\t/* size: " << layout.size << ", cachelines: " << ((layout.size + cacheLineSize_ - 1U) / cacheLineSize_) << ", members: " << layout.members.size() << " */\n";
+    out << "\t/* sum members: " << amount(memberBits) << ", holes: " << layout.holes.size() << ", sum holes: " << amount(sumHoleBits(layout)) << " */\n";
+    if (layout.paddingBits != 0U) {
+      out << "\t/* padding: " << amount(layout.paddingBits) << " */\n";
+    }
+    out << "\t/* last cacheline: " << ((lastLine == 0U) ? cacheLineSize_ : lastLine) << " bytes */\n";
+    out << "};\n\n";
+  }
+}
+
+void StructLayout::writeJson(std::ostream &out) const {
+  out << "[\n";
+  for (size_t i = 0U; i < layouts_.size(); i++) {
+    Layout const &layout = layouts_[i];
+    out << "{\"name\":";
+    writeJsonString(out, layout.name);
+    out << ",\"kind\":\"" << keyword(layout.tag) << "\",\"die\":" << layout.dieOffset << ",\"size\":" << layout.size << ",\"cachelines\":"
+        << ((layout.size + cacheLineSize_ - 1U) / cacheLineSize_) << ",\"holes\":" << layout.holes.size() << ",\"holeBits\":" << sumHoleBits(layout)
+        << ",\"paddingBits\":" << layout.paddingBits << ",\"members\":[";
+    for (size_t j = 0U; j < layout.members.size(); j++) {
+      Member const &placed = layout.members[j];
+      out << ((j == 0U) ? "" : ",") << "{\"name\":";
+      writeJsonString(out, placed.name);
+      out << ",\"type\":";
+      writeJsonString(out, placed.typeName);
+      out << ",\"bitOffset\":" << placed.bitOffset << ",\"bitSize\":" << placed.bitSize << ",\"sized\":" << (placed.sized ? "true" : "false") << ",\"bitfield\":" << (placed.bitfield ? "true" : "false")
+          << ",\"base\":" << (placed.base ? "true" : "false") << ",\"crossesCacheLine\":"
+          << ((std::find(layout.straddling.begin(), layout.straddling.end(), j) != layout.straddling.end()) ? "true" : "false") << "}";
+    }
+    out << "],\"holeList\":[";
+    for (size_t j = 0U; j < layout.holes.size(); j++) {
+      out << ((j == 0U) ? "" : ",") << "{\"bitOffset\":" << layout.holes[j].bitOffset << ",\"bits\":" << layout.holes[j].bits << ",\"before\":";
+      writeJsonString(out, layout.members[layout.holes[j].before].name);
+      out << "}";
+    }
+    out << "]}" << ((i + 1U) < layouts_.size() ? "," : "") << "\n";
+  }
+  out << "]\n";
+}
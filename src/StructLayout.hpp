@@ -0,0 +1,100 @@
+#ifndef STRUCT_LAYOUT_HPP
+#define STRUCT_LAYOUT_HPP
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "DebugAbbrev.hpp"
+
+class DIEIndex;
+class TypeDedup;
+class UnitCache;
+struct DwarfSections;
+
+// Memory layout of every struct, class and union, in the manner of pahole. Members and base classes are placed by
+// DW_AT_data_member_location and, for bitfields, DW_AT_data_bit_offset or the DWARF 2 DW_AT_bit_offset; their sizes come
+// from the member type, through typedefs, qualifiers and array bounds. Gaps between members are reported as holes, the
+// space behind the last member as padding, and members crossing a cache line boundary are listed.
+// A type defined in several units is reported once: the layouts of equal DIEs are alike, and of the layouts which are
+// alike only the first is kept, so the TypeDedup and the cached analysis report the same set.
+class StructLayout {
+public:
+  struct Member {
+    std::string_view name;     // empty for an anonymous member; a base class is named by its type
+    std::string_view typeName;
+    uint64_t bitOffset;        // from the start of the type
+    uint64_t bitSize;
+    bool sized;                // false if the size of the type is unknown, bitSize is 0 then
+    bool bitfield;
+    bool base;                 // DW_TAG_inheritance
+  };
+
+  struct Hole {
+    uint64_t bitOffset;
+    uint64_t bits;
+    size_t before; // index of the member behind the hole
+  };
+
+  struct Layout {
+    uint32_t dieOffset;
+    DebugAbbrev::Tag tag;
+    std::string_view name; // qualified
+    uint64_t size;         // DW_AT_byte_size
+    std::vector<Member> members; // by offset
+    std::vector<Hole> holes;
+    uint64_t paddingBits;        // behind the last member
+    std::vector<size_t> straddling; // members crossing a cache line boundary
+  };
+
+  // Lays out the canonical types of all units in parallel, so a type TypeDedup merged is laid out once
+  static StructLayout analyze(DIEIndex const &dieIndex, TypeDedup const &typeDedup, uint32_t const cacheLineSize = 64U);
+
+  // Incremental: a unit whose fingerprint is in cache is not decoded, its layouts are read from the cache. The other
+  // units are decoded together with the units they reference and are laid out and stored into cache. As no index of
+  // all units is built, only the layouts themselves are compared.
+  static StructLayout analyze(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections, UnitCache &cache,
+                              uint32_t const cacheLineSize = 64U);
+
+  inline std::vector<Layout> const &layouts() const noexcept {
+    return layouts_;
+  }
+
+  // Units whose layouts came from the cache, and all units, of an incremental analysis
+  inline size_t reusedUnits() const noexcept {
+    return reusedUnits_;
+  }
+
+  inline size_t unitCount() const noexcept {
+    return unitCount_;
+  }
+
+  // pahole like text, with holes and cache line boundaries marked between the members
+  void print(std::ostream &out) const;
+
+  // One JSON object per type in an array, for scripts to check e.g. that no hot struct has holes
+  void writeJson(std::ostream &out) const;
+
+  StructLayout(StructLayout &&other) noexcept;
+  StructLayout &operator=(StructLayout &&other) noexcept;
+  ~StructLayout();
+
+private:
+  struct Names;
+
+  explicit StructLayout(uint32_t const cacheLineSize) noexcept;
+
+  static uint64_t sumHoleBits(Layout const &layout) noexcept;
+  // Appends the layouts of the units in unit order, each distinct layout once
+  void addDistinct(std::vector<std::vector<Layout>> &unitLayouts);
+
+  uint32_t cacheLineSize_;
+  std::vector<Layout> layouts_;
+  std::vector<std::unique_ptr<Names>> names_; // the private name caches of the workers, the layouts view into them
+  size_t reusedUnits_ = 0U;
+  size_t unitCount_ = 0U;
+};
+
+#endif
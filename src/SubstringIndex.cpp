@@ -0,0 +1,402 @@
+#include "SubstringIndex.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include "DIEIndex.hpp"
+#include "DebugInfo.hpp"
+#include "Parallel.hpp"
+#include "QualifiedNames.hpp"
+#include "UnitCache.hpp"
+#include "UnitFingerprints.hpp"
+
+namespace {
+uint64_t constexpr recordVersion = 1U;               // of the unit records in a UnitCache, part of their key
+uint64_t constexpr recordKind = 0x7472696772616d73U; // "trigrams", keeps the keys apart from those of other analyses
+
+bool matchesText(std::string_view const name, std::string_view const text, SubstringIndex::Match const match) noexcept {
+  return (match == SubstringIndex::Match::prefix) ? name.starts_with(text) : (name.find(text) != std::string_view::npos);
+}
+
+template <typename T>
+void append(std::vector<uint8_t> &out, T const value) {
+  uint8_t bytes[sizeof(T)];
+  memcpy(bytes, &value, sizeof(T));
+  out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+void appendText(std::vector<uint8_t> &out, std::string_view const text) {
+  append(out, static_cast<uint32_t>(text.size()));
+  out.insert(out.end(), text.begin(), text.end());
+}
+
+// Bounds checked reads of a unit record, which lies unaligned in the mapped cache file
+class RecordReader {
+public:
+  explicit RecordReader(std::span<uint8_t const> const record) noexcept : record_(record) {
+  }
+
+  template <typename T>
+  T number(size_t const position) const {
+    if ((position > record_.size()) || ((record_.size() - position) < sizeof(T))) {
+      throw std::runtime_error("unit cache record too short");
+    }
+    T value;
+    memcpy(&value, record_.data() + position, sizeof(T));
+    return value;
+  }
+
+  // The text at position, which is moved behind it
+  std::string_view text(size_t &position) const {
+    uint32_t const size = number<uint32_t>(position);
+    position += sizeof(size);
+    if ((record_.size() - position) < size) {
+      throw std::runtime_error("unit cache record too short");
+    }
+    std::string_view const result(reinterpret_cast<char const *>(record_.data() + position), size);
+    position += size;
+    return result;
+  }
+
+private:
+  std::span<uint8_t const> record_;
+};
+
+// Turns (key, value) pairs sorted by key into the distinct keys, the start of each key's values and the values
+template <typename Key>
+void compress(std::vector<std::pair<Key, uint32_t>> const &pairs, std::vector<Key> &keys, std::vector<uint32_t> &starts, std::vector<uint32_t> &values) {
+  values.reserve(pairs.size());
+  for (size_t i = 0U; i < pairs.size(); i++) {
+    if ((i == 0U) || (pairs[i].first != pairs[i - 1U].first)) {
+      keys.push_back(pairs[i].first);
+      starts.push_back(static_cast<uint32_t>(values.size()));
+    }
+    values.push_back(pairs[i].second);
+  }
+  starts.push_back(static_cast<uint32_t>(values.size()));
+}
+
+// Concatenates the per worker results
+template <typename Pair>
+std::vector<Pair> concat(std::vector<std::vector<Pair>> &&shards) {
+  size_t total = 0U;
+  for (std::vector<Pair> const &shard : shards) {
+    total += shard.size();
+  }
+  std::vector<Pair> result;
+  result.reserve(total);
+  for (std::vector<Pair> &shard : shards) {
+    result.insert(result.end(), shard.begin(), shard.end());
+    std::vector<Pair>().swap(shard);
+  }
+  return result;
+}
+} // namespace
+
+SubstringIndex::SubstringIndex(StringPool const &strings) noexcept : pool_(&strings) {
+}
+
+SubstringIndex SubstringIndex::build(DIEIndex const &dieIndex) {
+  SubstringIndex index(dieIndex.strings());
+
+  // (name, DIE) of every named DIE, the units are scanned in parallel
+  std::vector<DIEIndex::UnitInfo> const &units = dieIndex.units();
+  std::vector<std::vector<std::pair<StringPool::Handle, uint32_t>>> namedShards(Parallel::workerCount(units.size()));
+  Parallel::forEach(units.size(), [&](size_t const unitIndex, size_t const worker) {
+    for (uint32_t i = units[unitIndex].firstDIE; i < units[unitIndex].endDIE; i++) {
+      if (dieIndex.at(i).name != StringPool::noString) {
+        namedShards[worker].emplace_back(dieIndex.at(i).name, i);
+      }
+    }
+  });
+  std::vector<std::pair<StringPool::Handle, uint32_t>> named = concat(std::move(namedShards));
+  std::sort(named.begin(), named.end());
+  compress(named, index.strings_, index.dieStarts_, index.dies_);
+  std::vector<std::pair<StringPool::Handle, uint32_t>>().swap(named);
+
+  // (trigram, string) once for every trigram of a string, the strings are split into one task per 4096
+  size_t constexpr stringsPerTask = 4096U;
+  size_t const tasks = (index.strings_.size() + stringsPerTask - 1U) / stringsPerTask;
+  std::vector<std::vector<std::pair<uint32_t, uint32_t>>> trigramShards(Parallel::workerCount(tasks));
+  Parallel::forEach(tasks, [&](size_t const task, size_t const worker) {
+    std::vector<uint32_t> own;
+    size_t const end = std::min(index.strings_.size(), (task + 1U) * stringsPerTask);
+    for (size_t string = task * stringsPerTask; string < end; string++) {
+      std::string_view const text = index.pool_->view(index.strings_[string]);
+      own.clear();
+      for (size_t position = 0U; (position + 3U) <= text.size(); position++) {
+        own.push_back(trigram(text, position));
+      }
+      std::sort(own.begin(), own.end());
+      own.erase(std::unique(own.begin(), own.end()), own.end());
+      for (uint32_t const key : own) {
+        trigramShards[worker].emplace_back(key, static_cast<uint32_t>(string));
+      }
+    }
+  });
+  std::vector<std::pair<uint32_t, uint32_t>> trigrams = concat(std::move(trigramShards));
+  std::sort(trigrams.begin(), trigrams.end());
+  compress(trigrams, index.trigrams_, index.postingStarts_, index.postings_);
+  return index;
+}
+
+bool SubstringIndex::matches(uint32_t const string, std::string_view const text, Match const match) const noexcept {
+  return matchesText(pool_->view(strings_[string]), text, match);
+}
+
+std::vector<uint32_t> SubstringIndex::find(std::string_view const text, Match const match) const {
+  std::vector<uint32_t> candidates;
+  if (text.size() < 3U) {
+    candidates.resize(strings_.size());
+    for (uint32_t i = 0U; i < candidates.size(); i++) {
+      candidates[i] = i;
+    }
+  } else {
+    // a string starting with text contains its trigrams as well, so prefix queries are filtered alike
+    std::vector<std::pair<uint32_t, uint32_t>> lists; // (size, position in trigrams_) of every trigram of text
+    for (size_t position = 0U; (position + 3U) <= text.size(); position++) {
+      std::vector<uint32_t>::const_iterator const it = std::lower_bound(trigrams_.begin(), trigrams_.end(), trigram(text, position));
+      if ((it == trigrams_.end()) || (*it != trigram(text, position))) {
+        return std::vector<uint32_t>();
+      }
+      uint32_t const key = static_cast<uint32_t>(it - trigrams_.begin());
+      lists.emplace_back(static_cast<uint32_t>(postings(key).size()), key);
+    }
+    std::sort(lists.begin(), lists.end());
+    lists.erase(std::unique(lists.begin(), lists.end()), lists.end());
+
+    candidates.assign(postings(lists[0].second).begin(), postings(lists[0].second).end());
+    std::vector<uint32_t> intersection;
+    for (size_t i = 1U; (i < lists.size()) && !candidates.empty(); i++) {
+      intersection.clear();
+      std::span<uint32_t const> const next = postings(lists[i].second);
+      std::set_intersection(candidates.begin(), candidates.end(), next.begin(), next.end(), std::back_inserter(intersection));
+      candidates.swap(intersection);
+    }
+  }
+
+  std::vector<uint32_t> result;
+  for (uint32_t const string : candidates) {
+    if (matches(string, text, match)) {
+      std::span<uint32_t const> const dies = diesNamedBy(string);
+      result.insert(result.end(), dies.begin(), dies.end());
+    }
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+// A record holds the number of names and of trigrams, the sorted trigrams, the start of the postings of each and the
+// postings, which are name numbers. Then come the record position of every name and the names, sorted, each followed by
+// the number of DIEs it names and per DIE the unit relative offset, the tag and the qualified name.
+std::vector<uint8_t> SubstringIndex::writeRecord(DIEIndex const &dieIndex, UnitInfo const &unit, QualifiedNames &qualifiedNames) {
+  std::vector<std::pair<std::string_view, uint32_t>> named;
+  for (uint32_t i = unit.firstDIE; i < unit.endDIE; i++) {
+    if (dieIndex.at(i).name != StringPool::noString) {
+      named.emplace_back(dieIndex.name(i), i);
+    }
+  }
+  std::sort(named.begin(), named.end());
+  std::vector<std::string_view> names;
+  std::vector<uint32_t> dieStarts;
+  std::vector<uint32_t> dies;
+  compress(named, names, dieStarts, dies);
+
+  std::vector<std::pair<uint32_t, uint32_t>> pairs;
+  std::vector<uint32_t> own;
+  for (size_t name = 0U; name < names.size(); name++) {
+    own.clear();
+    for (size_t position = 0U; (position + 3U) <= names[name].size(); position++) {
+      own.push_back(trigram(names[name], position));
+    }
+    std::sort(own.begin(), own.end());
+    own.erase(std::unique(own.begin(), own.end()), own.end());
+    for (uint32_t const key : own) {
+      pairs.emplace_back(key, static_cast<uint32_t>(name));
+    }
+  }
+  std::sort(pairs.begin(), pairs.end());
+  std::vector<uint32_t> keys;
+  std::vector<uint32_t> postingStarts;
+  std::vector<uint32_t> postings;
+  compress(pairs, keys, postingStarts, postings);
+
+  std::vector<uint8_t> record;
+  append(record, static_cast<uint32_t>(names.size()));
+  append(record, static_cast<uint32_t>(keys.size()));
+  for (std::vector<uint32_t> const *const numbers : {&keys, &postingStarts, &postings}) {
+    for (uint32_t const number : *numbers) {
+      append(record, number);
+    }
+  }
+  size_t const positions = record.size();
+  record.resize(positions + (names.size() * sizeof(uint32_t)));
+  for (size_t name = 0U; name < names.size(); name++) {
+    uint32_t const position = static_cast<uint32_t>(record.size());
+    memcpy(record.data() + positions + (name * sizeof(uint32_t)), &position, sizeof(position));
+    appendText(record, names[name]);
+    append(record, dieStarts[name + 1U] - dieStarts[name]);
+    for (uint32_t die = dieStarts[name]; die < dieStarts[name + 1U]; die++) {
+      append(record, dieIndex.at(dies[die]).offset - unit.offset);
+      append(record, static_cast<uint16_t>(dieIndex.at(dies[die]).tag));
+      appendText(record, qualifiedNames.name(dieIndex, dies[die]));
+    }
+  }
+  return record;
+}
+
+void SubstringIndex::searchRecord(std::span<uint8_t const> const record, uint32_t const unitOffset, std::string_view const text, Match const match, std::vector<Found> &found) {
+  RecordReader const reader(record);
+  uint32_t const nameCount = reader.number<uint32_t>(0U);
+  uint32_t const trigramCount = reader.number<uint32_t>(sizeof(uint32_t));
+  size_t const keysAt = 2U * sizeof(uint32_t);
+  size_t const startsAt = keysAt + (static_cast<size_t>(trigramCount) * sizeof(uint32_t));
+  size_t const postingsAt = startsAt + ((static_cast<size_t>(trigramCount) + 1U) * sizeof(uint32_t));
+  size_t const positionsAt = postingsAt + (static_cast<size_t>(reader.number<uint32_t>(startsAt + (static_cast<size_t>(trigramCount) * sizeof(uint32_t)))) * sizeof(uint32_t));
+  // the postings of the trigram at position key of the table
+  auto const postingsOf = [&](uint32_t const key, std::vector<uint32_t> &out) {
+    uint32_t const end = reader.number<uint32_t>(startsAt + ((static_cast<size_t>(key) + 1U) * sizeof(uint32_t)));
+    out.clear();
+    for (uint32_t i = reader.number<uint32_t>(startsAt + (static_cast<size_t>(key) * sizeof(uint32_t))); i < end; i++) {
+      out.push_back(reader.number<uint32_t>(postingsAt + (static_cast<size_t>(i) * sizeof(uint32_t))));
+    }
+  };
+
+  std::vector<uint32_t> candidates;
+  if (text.size() < 3U) {
+    candidates.resize(nameCount);
+    std::iota(candidates.begin(), candidates.end(), 0U);
+  } else {
+    std::vector<std::pair<uint32_t, uint32_t>> lists; // (size, position in the table) of every trigram of text
+    for (size_t position = 0U; (position + 3U) <= text.size(); position++) {
+      uint32_t const wanted = trigram(text, position);
+      uint32_t low = 0U;
+      uint32_t high = trigramCount;
+      while (low < high) {
+        uint32_t const middle = low + ((high - low) / 2U);
+        if (reader.number<uint32_t>(keysAt + (static_cast<size_t>(middle) * sizeof(uint32_t))) < wanted) {
+          low = middle + 1U;
+        } else {
+          high = middle;
+        }
+      }
+      if ((low == trigramCount) || (reader.number<uint32_t>(keysAt + (static_cast<size_t>(low) * sizeof(uint32_t))) != wanted)) {
+        return;
+      }
+      uint32_t const size = reader.number<uint32_t>(startsAt + ((static_cast<size_t>(low) + 1U) * sizeof(uint32_t))) -
+                            reader.number<uint32_t>(startsAt + (static_cast<size_t>(low) * sizeof(uint32_t)));
+      lists.emplace_back(size, low);
+    }
+    std::sort(lists.begin(), lists.end());
+    lists.erase(std::unique(lists.begin(), lists.end()), lists.end());
+
+    postingsOf(lists[0].second, candidates);
+    std::vector<uint32_t> next;
+    std::vector<uint32_t> intersection;
+    for (size_t i = 1U; (i < lists.size()) && !candidates.empty(); i++) {
+      postingsOf(lists[i].second, next);
+      intersection.clear();
+      std::set_intersection(candidates.begin(), candidates.end(), next.begin(), next.end(), std::back_inserter(intersection));
+      candidates.swap(intersection);
+    }
+  }
+
+  size_t const first = found.size();
+  for (uint32_t const name : candidates) {
+    size_t position = reader.number<uint32_t>(positionsAt + (static_cast<size_t>(name) * sizeof(uint32_t)));
+    if (!matchesText(reader.text(position), text, match)) {
+      continue;
+    }
+    uint32_t const dieCount = reader.number<uint32_t>(position);
+    position += sizeof(dieCount);
+    for (uint32_t die = 0U; die < dieCount; die++) {
+      Found &entry = found.emplace_back();
+      entry.dieOffset = unitOffset + reader.number<uint32_t>(position);
+      entry.unitOffset = unitOffset;
+      position += sizeof(uint32_t);
+      entry.tag = static_cast<DebugAbbrev::Tag>(reader.number<uint16_t>(position));
+      position += sizeof(uint16_t);
+      entry.qualifiedName = reader.text(position);
+    }
+  }
+  std::sort(found.begin() + static_cast<ptrdiff_t>(first), found.end(), [](Found const &lhs, Found const &rhs) {
+    return lhs.dieOffset < rhs.dieOffset;
+  });
+}
+
+SubstringIndex::Search SubstringIndex::search(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections, UnitCache &cache,
+                                              std::string_view const text, Match const match) {
+  std::vector<UnitInfo> const units = DebugInfo::readUnitHeaders(sections, debugAbbrevSections);
+  UnitFingerprints const fingerprints = UnitFingerprints::compute(sections, debugAbbrevSections, units);
+  Search result{{}, 0U, units.size()};
+
+  // type units repeating a signature are left out, as DIEIndex leaves them out; a changed unit is decoded with the
+  // units it references, through which its qualified names may go
+  DIEIndex::TypeSignatures signatures;
+  std::vector<bool> skipped(units.size(), false);
+  std::vector<uint64_t> keys(units.size());
+  std::vector<std::optional<std::span<uint8_t const>>> records(units.size());
+  std::vector<bool> changed(units.size(), false);
+  std::vector<bool> decode(units.size(), false);
+  for (size_t i = 0U; i < units.size(); i++) {
+    if (units[i].isTypeUnit() && !signatures.emplace(units[i].signature, units[i].offset).second) {
+      skipped[i] = true;
+      continue;
+    }
+    keys[i] = (fingerprints.fingerprint(i) ^ recordKind) + recordVersion;
+    records[i] = cache.find(keys[i]);
+    if (records[i].has_value()) {
+      result.reusedUnits++;
+      continue;
+    }
+    changed[i] = true;
+    decode[i] = true;
+    for (size_t const reached : fingerprints.reachable(i)) {
+      decode[reached] = true;
+    }
+  }
+  std::vector<uint32_t> unitOffsets;
+  for (size_t i = 0U; i < units.size(); i++) {
+    if (decode[i]) {
+      unitOffsets.push_back(units[i].offset);
+    }
+  }
+
+  std::vector<std::vector<uint8_t>> newRecords(units.size());
+  if (!unitOffsets.empty()) {
+    DIEIndex const dieIndex = DebugInfo::buildDIEIndex(sections, debugAbbrevSections, unitOffsets);
+    std::vector<DIEIndex::UnitInfo> const &decoded = dieIndex.units();
+    std::vector<std::unique_ptr<QualifiedNames>> qualifiedNames;
+    for (size_t worker = Parallel::workerCount(decoded.size()); worker > 0U; worker--) {
+      qualifiedNames.push_back(std::make_unique<QualifiedNames>());
+    }
+    Parallel::forEach(decoded.size(), [&](size_t const decodedIndex, size_t const worker) {
+      size_t const unitIndex = static_cast<size_t>(std::lower_bound(units.begin(), units.end(), decoded[decodedIndex].offset, [](UnitInfo const &unit, uint32_t const offset) {
+                                                     return unit.offset < offset;
+                                                   }) -
+                                                   units.begin());
+      if (changed[unitIndex]) {
+        newRecords[unitIndex] = writeRecord(dieIndex, decoded[decodedIndex], *qualifiedNames[worker]);
+      }
+    });
+  }
+
+  std::vector<std::vector<Found>> unitFound(units.size());
+  Parallel::forEach(units.size(), [&](size_t const unitIndex, size_t) {
+    if (!skipped[unitIndex]) {
+      std::span<uint8_t const> const record = changed[unitIndex] ? std::span<uint8_t const>(newRecords[unitIndex]) : *records[unitIndex];
+      searchRecord(record, units[unitIndex].offset, text, match, unitFound[unitIndex]);
+    }
+  });
+  for (size_t i = 0U; i < units.size(); i++) {
+    if (changed[i]) {
+      cache.store(keys[i], std::move(newRecords[i]));
+    }
+  }
+  result.found = concat(std::move(unitFound));
+  return result;
+}
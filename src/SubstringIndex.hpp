@@ -0,0 +1,94 @@
+#ifndef SUBSTRING_INDEX_HPP
+#define SUBSTRING_INDEX_HPP
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "DebugAbbrev.hpp"
+#include "DwarfSections.hpp"
+#include "StringPool.hpp"
+#include "UnitInfo.hpp"
+
+class DIEIndex;
+class QualifiedNames;
+class UnitCache;
+
+// Trigram index over the distinct DW_AT_name strings of a DIEIndex, .debug_str and interned inline strings alike, for
+// substring and prefix queries such as "Allocator". Every trigram maps to the sorted list of strings containing it; a
+// query intersects the lists of its own trigrams, starting with the shortest, and checks the few candidates left. Every
+// string maps back to all DIEs named by it. Queries shorter than a trigram scan the distinct strings.
+// Built in parallel and immutable afterwards; the DIEIndex must outlive it and must not be moved.
+class SubstringIndex {
+public:
+  enum class Match { substring, prefix };
+
+  // A DIE found by search, which outlives the DIEs decoded for it
+  struct Found {
+    uint32_t dieOffset;
+    uint32_t unitOffset;
+    DebugAbbrev::Tag tag;
+    std::string qualifiedName;
+  };
+
+  struct Search {
+    std::vector<Found> found; // in DIE offset order
+    size_t reusedUnits;       // units whose table came from the cache
+    size_t unitCount;
+  };
+
+  static SubstringIndex build(DIEIndex const &dieIndex);
+
+  // Incremental: every unit has its own trigram table, stored in cache under the fingerprint of the unit together with
+  // the names it indexes and the DIEs named by them. A query looks the trigrams up in the records of the unchanged
+  // units where they lie in the mapped cache file, and decodes only the changed units with the units they reference.
+  static Search search(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections, UnitCache &cache,
+                       std::string_view const text, Match const match);
+
+  // Indices of the DIEs whose name contains (or starts with) text, in index order
+  std::vector<uint32_t> find(std::string_view const text, Match const match) const;
+
+  inline size_t stringCount() const noexcept {
+    return strings_.size();
+  }
+
+  inline size_t trigramCount() const noexcept {
+    return trigrams_.size();
+  }
+
+private:
+  explicit SubstringIndex(StringPool const &strings) noexcept;
+
+  // Three bytes packed into the low 24 bits
+  static inline uint32_t trigram(std::string_view const text, size_t const position) noexcept {
+    return (static_cast<uint32_t>(static_cast<uint8_t>(text[position])) << 16U) | (static_cast<uint32_t>(static_cast<uint8_t>(text[position + 1U])) << 8U) |
+           static_cast<uint32_t>(static_cast<uint8_t>(text[position + 2U]));
+  }
+
+  bool matches(uint32_t const string, std::string_view const text, Match const match) const noexcept;
+
+  // The record of one unit in a UnitCache: its trigram table, names and DIEs, see search
+  static std::vector<uint8_t> writeRecord(DIEIndex const &dieIndex, UnitInfo const &unit, QualifiedNames &qualifiedNames);
+  // Appends the DIEs of a unit record whose name contains (or starts with) text, in offset order
+  static void searchRecord(std::span<uint8_t const> const record, uint32_t const unitOffset, std::string_view const text, Match const match, std::vector<Found> &found);
+
+  inline std::span<uint32_t const> postings(uint32_t const key) const noexcept {
+    return std::span<uint32_t const>(postings_).subspan(postingStarts_[key], postingStarts_[key + 1U] - postingStarts_[key]);
+  }
+
+  inline std::span<uint32_t const> diesNamedBy(uint32_t const string) const noexcept {
+    return std::span<uint32_t const>(dies_).subspan(dieStarts_[string], dieStarts_[string + 1U] - dieStarts_[string]);
+  }
+
+  StringPool const *pool_;
+  std::vector<StringPool::Handle> strings_; // distinct names, a string is its position here
+  std::vector<uint32_t> dieStarts_;         // DIEs named by string i are dies_[dieStarts_[i] .. dieStarts_[i + 1])
+  std::vector<uint32_t> dies_;
+  std::vector<uint32_t> trigrams_;          // sorted; strings containing trigrams_[i] are postings_[postingStarts_[i] .. postingStarts_[i + 1])
+  std::vector<uint32_t> postingStarts_;
+  std::vector<uint32_t> postings_;
+};
+
+#endif
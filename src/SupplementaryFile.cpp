@@ -0,0 +1,93 @@
+#include "SupplementaryFile.hpp"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "ByteReader.hpp"
+
+namespace {
+// Name at the start of data, empty if it is not terminated
+std::string_view terminatedName(std::span<uint8_t const> const data) noexcept {
+  void const *const terminator = memchr(data.data(), 0, data.size());
+  if (terminator == nullptr) {
+    return std::string_view();
+  }
+  return std::string_view(reinterpret_cast<char const *>(data.data()), static_cast<size_t>(static_cast<uint8_t const *>(terminator) - data.data()));
+}
+} // namespace
+
+SupplementaryFile::SupplementaryFile(ElfFile &&file, std::string path) noexcept : file_(std::move(file)), path_(std::move(path)) {
+}
+
+std::optional<SupplementaryFile::Link> SupplementaryFile::link(std::span<uint8_t const> const debugAltLink, std::span<uint8_t const> const debugSup) {
+  // .gnu_debugaltlink: the name and the build id behind it
+  std::string_view name = terminatedName(debugAltLink);
+  if (!name.empty()) {
+    return Link{name, debugAltLink.subspan(name.size() + 1U)};
+  }
+  // .debug_sup: version, is_supplementary, the name, the checksum as ULEB128 size and bytes; dwz puts the build id there
+  if (debugSup.size() < 4U) {
+    return std::nullopt;
+  }
+  ByteReader reader(debugSup.data(), debugSup.size());
+  uint16_t const version = reader.getNumber<uint16_t>();
+  uint8_t const isSupplementary = reader.getNumber<uint8_t>();
+  name = terminatedName(debugSup.subspan(3U));
+  if ((version != 5U) || (isSupplementary != 0U) || name.empty()) {
+    return std::nullopt;
+  }
+  reader.step(name.size() + 1U);
+  uint64_t const checksumSize = reader.readLEB128(false);
+  if (checksumSize > static_cast<uint64_t>(reader.end_ - reader.cursor_)) {
+    return Link{name, std::span<uint8_t const>()};
+  }
+  return Link{name, std::span<uint8_t const>(reader.cursor_, static_cast<size_t>(checksumSize))};
+}
+
+std::optional<SupplementaryFile> SupplementaryFile::open(Link const &link, std::string const &binaryPath, std::string const &debugDirectory) {
+  std::vector<std::string> paths;
+  if (!link.buildId.empty() && !debugDirectory.empty()) {
+    char constexpr digits[] = "0123456789abcdef";
+    std::string path = debugDirectory + "/.build-id/";
+    for (size_t i = 0U; i < link.buildId.size(); i++) {
+      path += digits[link.buildId[i] >> 4U];
+      path += digits[link.buildId[i] & 0xFU];
+      if (i == 0U) {
+        path += '/';
+      }
+    }
+    paths.push_back(path + ".debug");
+  }
+  if (link.name.front() == '/') {
+    paths.emplace_back(link.name);
+  } else {
+    size_t const slash = binaryPath.rfind('/');
+    paths.push_back(((slash == std::string::npos) ? std::string() : binaryPath.substr(0U, slash + 1U)) + std::string(link.name));
+  }
+
+  for (std::string const &path : paths) {
+    std::optional<ElfFile> file = ElfFile::open(path);
+    if (!file.has_value() || file->section(".debug_info").empty()) {
+      continue;
+    }
+    std::span<uint8_t const> const buildId = file->buildId();
+    if (!link.buildId.empty() && !std::equal(buildId.begin(), buildId.end(), link.buildId.begin(), link.buildId.end())) {
+      continue;
+    }
+    return SupplementaryFile(std::move(*file), path);
+  }
+  return std::nullopt;
+}
+
+void SupplementaryFile::addSections(DwarfSections &sections, size_t const debugAbbrevSize) const {
+  sections.altDebugInfo = file_.section(".debug_info");
+  std::span<uint8_t const> const debugStr = file_.section(".debug_str");
+  sections.altDebugStr = debugStr.empty() ? nullptr : reinterpret_cast<char const *>(debugStr.data());
+  sections.altAbbrevBase = static_cast<uint32_t>(debugAbbrevSize);
+}
+
+void SupplementaryFile::addAbbreviations(DwarfSections const &sections, AbbrevSections &debugAbbrevSections) const {
+  for (std::pair<ptrdiff_t const, DebugAbbrev::AbbrevTable> &table : DebugAbbrev::parseDebugAbbrev(file_.section(".debug_abbrev"))) {
+    debugAbbrevSections.emplace(table.first + static_cast<ptrdiff_t>(sections.altAbbrevBase), std::move(table.second));
+  }
+}
@@ -0,0 +1,54 @@
+#ifndef SUPPLEMENTARY_FILE_HPP
+#define SUPPLEMENTARY_FILE_HPP
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "DebugAbbrev.hpp"
+#include "DwarfSections.hpp"
+#include "ElfFile.hpp"
+
+// The file dwz moves the debug info shared by several binaries into. A binary names it in .gnu_debugaltlink, or with
+// DWARF 5 in .debug_sup, together with its build id. The .debug_info of the file is numbered behind the sections of the
+// binary, so that DW_FORM_GNU_ref_alt resolves through the same DIEIndex as any other reference and every partial unit
+// of the file is decoded once, not once per unit importing it. The file is mapped, only the pages touched are read.
+class SupplementaryFile {
+public:
+  using AbbrevSections = std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable>;
+
+  // What the binary says about its supplementary file
+  struct Link {
+    std::string_view name;
+    std::span<uint8_t const> buildId; // empty if the link has none
+  };
+
+  // From .gnu_debugaltlink or .debug_sup, nullopt if neither names a file
+  static std::optional<Link> link(std::span<uint8_t const> const debugAltLink, std::span<uint8_t const> const debugSup);
+
+  // Looks for <debugDirectory>/.build-id/xx/yyyy.debug first, then for the linked name, relative to the directory of the
+  // binary unless it is absolute. A file whose build id differs from the one of the link is skipped. nullopt if none is
+  // found.
+  static std::optional<SupplementaryFile> open(Link const &link, std::string const &binaryPath, std::string const &debugDirectory);
+
+  // Puts .debug_info and .debug_str of the file behind those of the binary; debugAbbrevSize is the size of the binary's
+  // .debug_abbrev, behind which the abbreviation tables of the file are keyed
+  void addSections(DwarfSections &sections, size_t const debugAbbrevSize) const;
+
+  // Adds the abbreviation tables of the file to those of the binary, keyed as addSections set up
+  void addAbbreviations(DwarfSections const &sections, AbbrevSections &debugAbbrevSections) const;
+
+  inline std::string const &path() const noexcept {
+    return path_;
+  }
+
+private:
+  SupplementaryFile(ElfFile &&file, std::string path) noexcept;
+
+  ElfFile file_;
+  std::string path_;
+};
+
+#endif
@@ -0,0 +1,11 @@
+#include "SymbolTable.hpp"
+
+SymbolTable::Symbol const *SymbolTable::find(uint64_t const address) const noexcept {
+  std::vector<Symbol>::const_iterator const symbol = std::upper_bound(symbols_.begin(), symbols_.end(), address, [](uint64_t const value, Symbol const &candidate) {
+    return value < candidate.address;
+  });
+  if ((symbol == symbols_.begin()) || (address >= (symbol - 1)->sectionEnd)) {
+    return nullptr;
+  }
+  return &*(symbol - 1);
+}
@@ -0,0 +1,97 @@
+#ifndef SYMBOL_TABLE_HPP
+#define SYMBOL_TABLE_HPP
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "elf.h"
+
+// Function symbols of the ELF symbol table sorted by address, for naming code the debug info does not describe, like
+// _start, PLT stubs and the padding between functions. Names point into the file contents, which must outlive the
+// table.
+class SymbolTable {
+public:
+  struct Symbol {
+    uint64_t address;
+    uint64_t size;
+    uint64_t sectionEnd;
+    std::string_view name;
+    std::string_view file; // STT_FILE symbol the function belongs to, empty if unknown
+  };
+
+  // .symtab, or .dynsym if the binary is stripped
+  template <typename EhdrType, typename ShdrType, typename SymType>
+  static SymbolTable build(std::span<uint8_t const> const elfFile) {
+    SymbolTable table;
+    EhdrType const *const elfHeader = reinterpret_cast<EhdrType const *>(elfFile.data());
+    ShdrType const *const sectionHeaders = reinterpret_cast<ShdrType const *>(elfFile.data() + elfHeader->e_shoff);
+    ShdrType const *symbolSection = nullptr;
+    for (uint32_t i = 0U; i < elfHeader->e_shnum; i++) {
+      if ((sectionHeaders[i].sh_type == SHT_SYMTAB) || ((sectionHeaders[i].sh_type == SHT_DYNSYM) && (symbolSection == nullptr))) {
+        symbolSection = sectionHeaders + i;
+      }
+    }
+    if ((symbolSection == nullptr) || (symbolSection->sh_link >= elfHeader->e_shnum)) {
+      return table;
+    }
+    ShdrType const &stringSection = sectionHeaders[symbolSection->sh_link];
+    char const *const strings = reinterpret_cast<char const *>(elfFile.data() + stringSection.sh_offset);
+
+    // a STT_FILE symbol starts the local symbols of one object; once global symbols were seen, a later file symbol
+    // no longer says anything about them
+    std::string_view file;
+    bool symbolSeen = false;
+    bool fileAfterSymbol = false;
+    size_t const count = static_cast<size_t>(symbolSection->sh_size / sizeof(SymType));
+    for (size_t i = 0U; i < count; i++) {
+      SymType symbol;
+      memcpy(&symbol, elfFile.data() + symbolSection->sh_offset + (i * sizeof(SymType)), sizeof(SymType));
+      if (symbol.st_name >= stringSection.sh_size) {
+        continue;
+      }
+      unsigned const type = static_cast<unsigned>(symbol.st_info) & 0xFU;
+      if (type == STT_FILE) {
+        file = std::string_view(strings + symbol.st_name);
+        fileAfterSymbol = fileAfterSymbol || symbolSeen;
+        continue;
+      }
+      if ((type != STT_FUNC) && (type != STT_NOTYPE)) {
+        continue;
+      }
+      symbolSeen = true;
+      if ((symbol.st_shndx == SHN_UNDEF) || (symbol.st_shndx >= elfHeader->e_shnum) || (strings[symbol.st_name] == '\0')) {
+        continue;
+      }
+      ShdrType const &section = sectionHeaders[symbol.st_shndx];
+      if ((section.sh_flags & SHF_EXECINSTR) == 0U) {
+        continue;
+      }
+      bool const local = (static_cast<unsigned>(symbol.st_info) >> 4U) == STB_LOCAL;
+      table.symbols_.push_back(Symbol{static_cast<uint64_t>(symbol.st_value), static_cast<uint64_t>(symbol.st_size),
+                                      static_cast<uint64_t>(section.sh_addr + section.sh_size), std::string_view(strings + symbol.st_name),
+                                      (local || !fileAfterSymbol) ? file : std::string_view()});
+    }
+    // of symbols at the same address the largest one is the function, the others are labels; of equal ones the first
+    // in the table counts
+    std::stable_sort(table.symbols_.begin(), table.symbols_.end(), [](Symbol const &lhs, Symbol const &rhs) {
+      return (lhs.address != rhs.address) ? (lhs.address < rhs.address) : (lhs.size < rhs.size);
+    });
+    table.symbols_.erase(std::unique(table.symbols_.begin(), table.symbols_.end(),
+                                     [](Symbol const &lhs, Symbol const &rhs) {
+                                       return (lhs.address == rhs.address) && (lhs.size == rhs.size);
+                                     }),
+                         table.symbols_.end());
+    return table;
+  }
+
+  // Last function symbol at or before address in the same section, nullptr if there is none. Like addr2line, the
+  // symbol size is not checked, so alignment padding belongs to the function before it.
+  Symbol const *find(uint64_t const address) const noexcept;
+
+private:
+  std::vector<Symbol> symbols_;
+};
+
+#endif
@@ -0,0 +1,358 @@
+#include "Symbolizer.hpp"
+#include <algorithm>
+#include <bit>
+#include "DebugInfo.hpp"
+#include "QualifiedNames.hpp"
+
+namespace {
+struct SortEntry {
+  uint64_t address;
+  uint32_t input;
+};
+
+// LSD radix sort of the addresses with their input positions, 11 bits per pass. Only the low bits in which the
+// addresses differ are sorted, which for the code addresses of one binary is two or three passes, against the 20 or so
+// rounds of a comparison sort. The counts of all passes are taken in one read of the input.
+std::vector<SortEntry> radixSort(std::span<uint64_t const> const addresses) {
+  unsigned constexpr digitBits = 11U;
+  size_t constexpr bucketCount = static_cast<size_t>(1U) << digitBits;
+  std::vector<SortEntry> entries(addresses.size());
+  uint64_t differing = 0U;
+  for (uint64_t const address : addresses) {
+    differing |= address ^ addresses[0];
+  }
+  size_t const passCount = static_cast<size_t>((std::bit_width(differing) + digitBits - 1U) / digitBits);
+  if (passCount == 0U) {
+    for (size_t i = 0U; i < addresses.size(); i++) {
+      entries[i] = SortEntry{addresses[i], static_cast<uint32_t>(i)};
+    }
+    return entries;
+  }
+
+  std::vector<uint32_t> counts(passCount * bucketCount, 0U);
+  for (uint64_t const address : addresses) {
+    for (size_t pass = 0U; pass < passCount; pass++) {
+      counts[(pass * bucketCount) + static_cast<size_t>((address >> (pass * digitBits)) & (bucketCount - 1U))]++;
+    }
+  }
+  for (size_t pass = 0U; pass < passCount; pass++) {
+    uint32_t position = 0U;
+    for (size_t bucket = pass * bucketCount; bucket < (pass + 1U) * bucketCount; bucket++) {
+      uint32_t const bucketSize = counts[bucket];
+      counts[bucket] = position;
+      position += bucketSize;
+    }
+  }
+
+  // the first pass reads the input itself, the others alternate between the two buffers and end in entries
+  std::vector<SortEntry> buffer(addresses.size());
+  std::vector<SortEntry> *target = ((passCount % 2U) == 1U) ? &entries : &buffer;
+  std::vector<SortEntry> *source = ((passCount % 2U) == 1U) ? &buffer : &entries;
+  for (size_t i = 0U; i < addresses.size(); i++) {
+    (*target)[counts[static_cast<size_t>(addresses[i] & (bucketCount - 1U))]++] = SortEntry{addresses[i], static_cast<uint32_t>(i)};
+  }
+  for (size_t pass = 1U; pass < passCount; pass++) {
+    std::swap(target, source);
+    uint32_t *const passCounts = counts.data() + (pass * bucketCount);
+    for (SortEntry const &entry : *source) {
+      (*target)[passCounts[static_cast<size_t>((entry.address >> (pass * digitBits)) & (bucketCount - 1U))]++] = entry;
+    }
+  }
+  return entries;
+}
+} // namespace
+
+Symbolizer::Symbolizer(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> debugAbbrevSections, std::string binaryPath)
+    : sections_(sections), debugAbbrevSections_(std::move(debugAbbrevSections)), unitRanges_(UnitRanges::build(sections_, debugAbbrevSections_)),
+      splitDwarf_(std::move(binaryPath), sections_), dieIndex_(sections_) {
+}
+
+Symbolizer::Unit &Symbolizer::unit(uint32_t const unitOffset) {
+  std::unique_ptr<Unit> &cached = units_[unitOffset];
+  if (cached) {
+    return *cached;
+  }
+  // only the unit DIE is read here, the line program follows when it is needed
+  cached = std::make_unique<Unit>();
+  cached->info = DebugInfo::readUnitHeader(sections_, debugAbbrevSections_, unitOffset);
+  SplitDwarf::Skeleton skeleton{&cached->info, std::string_view(), std::string_view(), cached->info.signature, 0U, 0U, 0U};
+  for (std::pair<DebugAbbrev::AttributeName, FormValue> const &attribute : DebugInfo::readUnitDIE(sections_, cached->info, debugAbbrevSections_.at(cached->info.abbrevOffset))) {
+    switch (attribute.first) {
+    case (DebugAbbrev::AttributeName::DW_AT_name): {
+      cached->name = sections_.string(attribute.second);
+      break;
+    }
+    case (DebugAbbrev::AttributeName::DW_AT_comp_dir): {
+      cached->compDir = sections_.string(attribute.second);
+      break;
+    }
+    case (DebugAbbrev::AttributeName::DW_AT_stmt_list): {
+      cached->lineTableOffset = attribute.second.value;
+      break;
+    }
+    case (DebugAbbrev::AttributeName::DW_AT_low_pc): {
+      skeleton.lowPc = attribute.second.value;
+      break;
+    }
+    case (DebugAbbrev::AttributeName::DW_AT_dwo_name):
+    case (DebugAbbrev::AttributeName::DW_AT_GNU_dwo_name): {
+      skeleton.dwoName = sections_.string(attribute.second);
+      break;
+    }
+    case (DebugAbbrev::AttributeName::DW_AT_GNU_dwo_id): {
+      skeleton.dwoId = attribute.second.value;
+      break;
+    }
+    case (DebugAbbrev::AttributeName::DW_AT_GNU_addr_base): {
+      skeleton.addrBase = attribute.second.value;
+      break;
+    }
+    case (DebugAbbrev::AttributeName::DW_AT_GNU_ranges_base): {
+      skeleton.rangesBase = attribute.second.value;
+      break;
+    }
+    default: {
+      break;
+    }
+    }
+  }
+  if (!skeleton.dwoName.empty()) {
+    // the line program stays in the binary, but a DWARF 5 skeleton leaves the name to the split unit
+    skeleton.compDir = cached->compDir;
+    cached->split = splitDwarf_.unit(skeleton);
+    if (cached->split.has_value() && cached->name.empty()) {
+      SplitDwarf::Unit const &split = *cached->split;
+      for (std::pair<DebugAbbrev::AttributeName, FormValue> const &attribute : DebugInfo::readUnitDIE(split.sections, split.info, split.debugAbbrevSections->at(split.info.abbrevOffset))) {
+        if (attribute.first == DebugAbbrev::AttributeName::DW_AT_name) {
+          cached->name = split.sections.string(attribute.second);
+        }
+      }
+    }
+  }
+  return *cached;
+}
+
+LineTable const *Symbolizer::lineTable(Unit &unit) {
+  if (!unit.lineTable.has_value()) {
+    if (!unit.lineTableOffset.has_value() || sections_.debugLine.empty()) {
+      return nullptr;
+    }
+    unit.lineTable = LineTable::decode(sections_, unit.info, *unit.lineTableOffset, unit.compDir);
+  }
+  return &*unit.lineTable;
+}
+
+FunctionIndex const &Symbolizer::functions(Unit &unit) {
+  if (!unit.functions.has_value()) {
+    if (unit.split.has_value()) {
+      unit.splitIndex = DebugInfo::decodeUnits(unit.split->sections, *unit.split->debugAbbrevSections, {unit.split->info});
+      unit.dieIndex = &*unit.splitIndex;
+      unit.functions = FunctionIndex::build(*unit.dieIndex, true);
+    } else {
+      unit.dieIndex = &dieIndex_;
+      unit.functions = FunctionIndex::build(dieIndex_, decode(unit.info), true);
+    }
+  }
+  return *unit.functions;
+}
+
+uint32_t Symbolizer::decode(DIEIndex::UnitInfo const &info) {
+  uint32_t const known = dieIndex_.findUnit(info.offset);
+  if (known != DIEIndex::invalidIndex) {
+    return known;
+  }
+  uint32_t const unitIndex = dieIndex_.appendUnit(info, DebugInfo::decodeUnit(sections_, info, debugAbbrevSections_.at(info.abbrevOffset), dieIndex_.typeSignatures(), dieIndex_.strings()));
+
+  // DW_AT_import names the unit DIE of the imported unit; imports of imported units are followed as well
+  std::vector<uint32_t> pending{unitIndex};
+  while (!pending.empty()) {
+    DIEIndex::UnitInfo const importer = dieIndex_.units()[pending.back()];
+    pending.pop_back();
+    for (uint32_t i = importer.firstDIE; i < importer.endDIE; i++) {
+      if (dieIndex_.at(i).tag != DebugAbbrev::Tag::DW_TAG_imported_unit) {
+        continue;
+      }
+      std::optional<FormValue> const import = dieIndex_.attribute(i, DebugAbbrev::AttributeName::DW_AT_import);
+      if (!import.has_value() || !import->isReference() || (import->value >= sections_.unitsEnd()) ||
+          (dieIndex_.findUnit(static_cast<uint32_t>(import->value)) != DIEIndex::invalidIndex)) {
+        continue;
+      }
+      if (unitOffsets_.empty()) {
+        unitOffsets_ = DebugInfo::readUnitOffsets(sections_);
+      }
+      uint32_t const importedOffset = *(std::upper_bound(unitOffsets_.begin(), unitOffsets_.end(), static_cast<uint32_t>(import->value)) - 1);
+      DIEIndex::UnitInfo const imported = DebugInfo::readUnitHeader(sections_, debugAbbrevSections_, importedOffset);
+      pending.push_back(dieIndex_.appendUnit(imported, DebugInfo::decodeUnit(sections_, imported, debugAbbrevSections_.at(imported.abbrevOffset), dieIndex_.typeSignatures(), dieIndex_.strings())));
+    }
+  }
+  return unitIndex;
+}
+
+std::optional<Symbolizer::Location> Symbolizer::locate(uint64_t const address) {
+  uint32_t const unitOffset = unitRanges_.findUnit(address);
+  if (unitOffset == UnitRanges::noUnit) {
+    return std::nullopt;
+  }
+  Unit &owner = unit(unitOffset);
+  Location location{unitOffset, owner.name, std::string_view(), 0U, 0U, 0U, std::string_view()};
+  LineTable const *const table = lineTable(owner);
+  if (table != nullptr) {
+    LineTable::Row const *const row = table->find(address);
+    if (row != nullptr) {
+      location.file = table->fileName(row->file);
+      location.line = row->line;
+      location.column = row->column;
+      location.discriminator = row->discriminator;
+    }
+  }
+  uint32_t const function = functions(owner).find(address);
+  if (function != FunctionIndex::noFunction) {
+    location.function = owner.dieIndex->qualifiedName(function);
+  }
+  return location;
+}
+
+void Symbolizer::frames(uint64_t const address, std::vector<Frame> &frames) {
+  frames.clear();
+  uint32_t const unitOffset = unitRanges_.findUnit(address);
+  if (unitOffset == UnitRanges::noUnit) {
+    return;
+  }
+  Unit &owner = unit(unitOffset);
+  uint32_t const innermost = functions(owner).find(address);
+  if (innermost == FunctionIndex::noFunction) {
+    return;
+  }
+  LineTable const *const table = lineTable(owner);
+  Frame frame{std::string_view(), std::string_view(), std::string_view(), std::string_view(), 0U, 0U, 0U, 0U};
+  if (table != nullptr) {
+    LineTable::Row const *const row = table->find(address);
+    if (row != nullptr) {
+      frame = Frame{std::string_view(), std::string_view(), std::string_view(), table->fileName(row->file), row->line, row->column, row->discriminator, 0U};
+    }
+  }
+  appendChain(*owner.dieIndex, table, innermost, frame, frames);
+}
+
+void Symbolizer::appendChain(DIEIndex const &dieIndex, LineTable const *const table, uint32_t const innermost, Frame frame, std::vector<Frame> &frames) {
+  // walk up the DIE tree, lexical blocks between the inlined instances are skipped
+  for (uint32_t i = innermost; i != DIEIndex::invalidIndex; i = dieIndex.at(i).parent) {
+    DebugAbbrev::Tag const tag = dieIndex.at(i).tag;
+    if ((tag != DebugAbbrev::Tag::DW_TAG_subprogram) && (tag != DebugAbbrev::Tag::DW_TAG_inlined_subroutine)) {
+      continue;
+    }
+    frame.function = dieIndex.qualifiedName(i);
+    frame.name = name(dieIndex, i);
+    frame.linkageName = linkageName(dieIndex, i);
+    std::optional<FormValue> const lowPc = dieIndex.attribute(i, DebugAbbrev::AttributeName::DW_AT_low_pc);
+    frame.lowPc = lowPc.has_value() ? lowPc->value : 0U;
+    frames.push_back(frame);
+    if (tag == DebugAbbrev::Tag::DW_TAG_subprogram) {
+      break;
+    }
+    // the caller continues at the call site
+    std::optional<FormValue> const callFile = dieIndex.attribute(i, DebugAbbrev::AttributeName::DW_AT_call_file);
+    std::optional<FormValue> const callLine = dieIndex.attribute(i, DebugAbbrev::AttributeName::DW_AT_call_line);
+    std::optional<FormValue> const callColumn = dieIndex.attribute(i, DebugAbbrev::AttributeName::DW_AT_call_column);
+    frame.file = ((table != nullptr) && callFile.has_value()) ? table->fileName(static_cast<uint32_t>(callFile->value)) : std::string_view();
+    frame.line = callLine.has_value() ? static_cast<uint32_t>(callLine->value) : 0U;
+    frame.column = callColumn.has_value() ? static_cast<uint16_t>(callColumn->value) : 0U;
+    frame.discriminator = 0U;
+  }
+}
+
+std::string_view Symbolizer::name(DIEIndex const &dieIndex, uint32_t const index) {
+  std::string_view const name = dieIndex.name(index);
+  return name.empty() ? dieIndex.name(QualifiedNames::declaration(dieIndex, index)) : name;
+}
+
+std::string_view Symbolizer::linkageName(DIEIndex const &dieIndex, uint32_t const index) {
+  std::optional<FormValue> const name = QualifiedNames::linkageName(dieIndex, index);
+  return name.has_value() ? dieIndex.string(*name) : std::string_view();
+}
+
+void Symbolizer::symbolize(std::span<uint64_t const> const addresses, Batch &batch) {
+  std::vector<SortEntry> const order = radixSort(addresses);
+
+  batch.results.resize(addresses.size());
+  batch.locations.clear();
+  batch.chainStarts.assign(1U, 0U);
+  batch.frames.clear();
+
+  std::vector<UnitRanges::Interval> const &intervals = unitRanges_.intervals();
+  size_t interval = 0U;
+  uint32_t currentUnit = UnitRanges::noUnit;
+  Unit *owner = nullptr;
+  LineTable const *table = nullptr;
+  FunctionIndex const *functionIndex = nullptr;
+  LineTable::Cursor rowCursor;
+  size_t segmentCursor = 0U;
+  uint32_t previousInnermost = FunctionIndex::noFunction;
+
+  size_t next = 0U;
+  while (next < order.size()) {
+    uint64_t const address = order[next].address;
+    uint32_t const result = static_cast<uint32_t>(batch.locations.size());
+    Location location{UnitRanges::noUnit, std::string_view(), std::string_view(), 0U, 0U, 0U, std::string_view()};
+
+    while ((interval < intervals.size()) && (intervals[interval].high <= address)) {
+      interval++;
+    }
+    if ((interval < intervals.size()) && (address >= intervals[interval].low)) {
+      if (intervals[interval].unitOffset != currentUnit) {
+        // the ranges of a unit need not be contiguous, the cursors restart whenever the walk enters a unit
+        currentUnit = intervals[interval].unitOffset;
+        owner = &unit(currentUnit);
+        table = lineTable(*owner);
+        functionIndex = &functions(*owner);
+        rowCursor = LineTable::Cursor();
+        segmentCursor = 0U;
+        previousInnermost = FunctionIndex::noFunction;
+      }
+      location.unitOffset = currentUnit;
+      location.unitName = owner->name;
+      Frame frame{std::string_view(), std::string_view(), std::string_view(), std::string_view(), 0U, 0U, 0U, 0U};
+      if (table != nullptr) {
+        LineTable::Row const *const row = table->findNext(address, rowCursor);
+        if (row != nullptr) {
+          frame = Frame{std::string_view(), std::string_view(), std::string_view(), table->fileName(row->file), row->line, row->column, row->discriminator, 0U};
+        }
+      }
+      location.file = frame.file;
+      location.line = frame.line;
+      location.column = frame.column;
+      location.discriminator = frame.discriminator;
+
+      uint32_t const innermost = functionIndex->findNext(address, segmentCursor);
+      if (innermost != FunctionIndex::noFunction) {
+        DIEIndex const &dieIndex = *owner->dieIndex;
+        location.function = dieIndex.qualifiedName(innermost);
+        if (innermost == previousInnermost) {
+          // same inlined instance as the previous address: only the innermost position differs
+          uint32_t const first = batch.chainStarts[result - 1U];
+          uint32_t const end = batch.chainStarts[result];
+          frame.function = location.function;
+          frame.name = batch.frames[first].name;
+          frame.linkageName = batch.frames[first].linkageName;
+          frame.lowPc = batch.frames[first].lowPc;
+          batch.frames.push_back(frame);
+          for (uint32_t i = first + 1U; i < end; i++) {
+            batch.frames.push_back(batch.frames[i]);
+          }
+        } else {
+          appendChain(dieIndex, table, innermost, frame, batch.frames);
+        }
+      }
+      previousInnermost = innermost;
+    } else {
+      previousInnermost = FunctionIndex::noFunction;
+    }
+    batch.locations.push_back(location);
+    batch.chainStarts.push_back(static_cast<uint32_t>(batch.frames.size()));
+
+    // scatter to every input position of this address
+    for (; (next < order.size()) && (order[next].address == address); next++) {
+      batch.results[order[next].input] = result;
+    }
+  }
+}
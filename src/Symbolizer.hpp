@@ -0,0 +1,126 @@
+#ifndef SYMBOLIZER_HPP
+#define SYMBOLIZER_HPP
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "DIEIndex.hpp"
+#include "DebugAbbrev.hpp"
+#include "DwarfSections.hpp"
+#include "FunctionIndex.hpp"
+#include "LineTable.hpp"
+#include "SplitDwarf.hpp"
+#include "UnitRanges.hpp"
+
+// Maps code addresses to source locations and functions. Only the unit ranges are built up front; the line program
+// and the DIEs of a unit are decoded the first time an address inside the unit is looked up, and then kept for later
+// lookups. The DIEs go into one index shared by all units, together with the partial units they import, which dwz
+// creates in the binary and in its supplementary file: a partial unit is decoded for the first unit importing it and
+// found by every later one. The DIEs of a skeleton unit come from its split unit, whose file is mapped at that point.
+// Not thread safe, lookups decode and cache units.
+class Symbolizer {
+public:
+  struct Location {
+    uint32_t unitOffset;
+    std::string_view unitName;
+    std::string_view file; // empty if the unit has no line table row for the address
+    uint32_t line;
+    uint16_t column;
+    uint32_t discriminator;
+    std::string_view function; // qualified name of the innermost function, an inlined one if the code was inlined
+  };
+
+  // One level of an inline chain: the function and the position in it, which for all but the innermost frame is the
+  // call site of the inlined function
+  struct Frame {
+    std::string_view function;    // qualified name
+    std::string_view name;        // DW_AT_name alone
+    std::string_view linkageName; // mangled name, empty if the producer did not record one
+    std::string_view file;
+    uint32_t line;
+    uint16_t column;
+    uint32_t discriminator; // only set for the innermost frame, call sites have none
+    uint64_t lowPc;         // DW_AT_low_pc of the function or inlined instance, 0 if it only has DW_AT_ranges
+  };
+
+  // Results of symbolize(). Every distinct address is resolved once; the inputs refer to the result of their address,
+  // which keeps a batch of repeated samples small.
+  struct Batch {
+    std::vector<uint32_t> results;     // input order, index of the result of the address
+    std::vector<Location> locations;   // per result; unitOffset is UnitRanges::noUnit if no unit contains the address
+    std::vector<uint32_t> chainStarts; // the inline chain of result i is frames[chainStarts[i], chainStarts[i + 1])
+    std::vector<Frame> frames;
+
+    inline Location const &location(size_t const input) const noexcept {
+      return locations[results[input]];
+    }
+
+    inline std::span<Frame const> framesOf(size_t const input) const noexcept {
+      uint32_t const result = results[input];
+      return std::span<Frame const>(frames.data() + chainStarts[result], chainStarts[result + 1U] - chainStarts[result]);
+    }
+  };
+
+  // binaryPath locates the .dwo files and the .dwp package of split units
+  Symbolizer(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> debugAbbrevSections, std::string binaryPath);
+
+  std::optional<Location> locate(uint64_t const address);
+
+  // The inline chain of address, innermost frame first; the last frame is the concrete function. Empty if no function
+  // contains address.
+  void frames(uint64_t const address, std::vector<Frame> &frames);
+
+  // locate() and frames() for many addresses at once. The addresses are sorted and deduplicated, then walked in one
+  // ascending pass over the unit ranges and, per unit, over the function segments and the line table rows; the results
+  // are scattered back into input order. Consecutive addresses in the same inlined instance share the parent walk.
+  void symbolize(std::span<uint64_t const> const addresses, Batch &batch);
+
+  inline UnitRanges const &unitRanges() const noexcept {
+    return unitRanges_;
+  }
+
+  inline size_t decodedUnitCount() const noexcept {
+    return units_.size();
+  }
+
+private:
+  struct Unit {
+    DIEIndex::UnitInfo info;
+    std::string_view name;
+    std::string_view compDir;
+    std::optional<uint64_t> lineTableOffset;
+    std::optional<LineTable> lineTable; // decoded on first use
+    std::optional<SplitDwarf::Unit> split; // where the DIEs of a skeleton unit are, found when the unit is first used
+    std::optional<DIEIndex> splitIndex; // a split unit has sections of its own, so it gets an index of its own
+    DIEIndex const *dieIndex = nullptr; // dieIndex_ or splitIndex, set on first use together with functions
+    std::optional<FunctionIndex> functions;
+  };
+
+  Unit &unit(uint32_t const unitOffset);
+  LineTable const *lineTable(Unit &unit);
+  FunctionIndex const &functions(Unit &unit);
+  // Appends a unit of the binary and the units it imports to dieIndex_, unless they are there already. Returns the
+  // index of the unit in dieIndex_.
+  uint32_t decode(DIEIndex::UnitInfo const &info);
+  // DW_AT_name of the DIE or its declaration
+  static std::string_view name(DIEIndex const &dieIndex, uint32_t const index);
+  // DW_AT_linkage_name of the DIE or of the abstract instance or declaration it refers to
+  static std::string_view linkageName(DIEIndex const &dieIndex, uint32_t const index);
+  // Appends the inline chain starting at the innermost function, frame holds the position inside it
+  static void appendChain(DIEIndex const &dieIndex, LineTable const *const table, uint32_t const innermost, Frame frame, std::vector<Frame> &frames);
+
+  DwarfSections sections_;
+  std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> debugAbbrevSections_;
+  UnitRanges unitRanges_;
+  SplitDwarf splitDwarf_;
+  DIEIndex dieIndex_;
+  std::vector<uint32_t> unitOffsets_; // of all units, read when the first import is followed
+  std::unordered_map<uint32_t, std::unique_ptr<Unit>> units_;
+};
+
+#endif
@@ -0,0 +1,357 @@
+#include "TypeDedup.hpp"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include "DIEIndex.hpp"
+#include "Parallel.hpp"
+#include "QualifiedNames.hpp"
+
+namespace {
+using AttributeName = DebugAbbrev::AttributeName;
+using Form = DebugAbbrev::Form;
+using Tag = DebugAbbrev::Tag;
+
+// Edges to types are node numbers below 2^32; a DW_AT_type which is not a type DIE of the index is described in the key
+uint64_t constexpr foreignEdge = uint64_t{1U} << 32U;
+uint64_t constexpr noTypeEdge = UINT64_MAX;
+uint64_t constexpr separator = UINT64_MAX;
+
+void appendNumber(std::string &key, uint64_t const value) {
+  char bytes[sizeof(value)];
+  memcpy(bytes, &value, sizeof(value));
+  key.append(bytes, sizeof(bytes));
+}
+
+void appendText(std::string &key, std::string_view const text) {
+  appendNumber(key, text.size());
+  key.append(text);
+}
+
+bool isString(Form const form) noexcept {
+  switch (form) {
+  case (Form::DW_FORM_string):
+  case (Form::DW_FORM_strp):
+  case (Form::DW_FORM_line_strp):
+  case (Form::DW_FORM_GNU_strp_alt):
+  case (Form::DW_FORM_strp_sup): {
+    return true;
+  }
+  default: {
+    return false;
+  }
+  }
+}
+
+// Tag and attributes of a DIE which are the same wherever the type is defined: no references, which become edges, no
+// source positions and no offsets into other sections, which differ from unit to unit
+void appendAttributes(DIEIndex const &dieIndex, uint32_t const index, std::string &key) {
+  appendNumber(key, static_cast<uint64_t>(dieIndex.at(index).tag));
+  for (std::pair<AttributeName, FormValue> const &attribute : dieIndex.attributes(index)) {
+    FormValue const &formValue = attribute.second;
+    if ((attribute.first == AttributeName::DW_AT_decl_file) || (attribute.first == AttributeName::DW_AT_decl_line) ||
+        (attribute.first == AttributeName::DW_AT_decl_column) || (attribute.first == AttributeName::DW_AT_sibling) || formValue.isReference() ||
+        (formValue.form == Form::DW_FORM_ref_sig8) || (formValue.form == Form::DW_FORM_sec_offset)) {
+      continue;
+    }
+    appendNumber(key, static_cast<uint64_t>(attribute.first));
+    if (isString(formValue.form)) {
+      appendText(key, dieIndex.string(formValue));
+    } else if (formValue.isBlock() || (formValue.form == Form::DW_FORM_data16)) {
+      appendText(key, std::string_view(reinterpret_cast<char const *>(formValue.data), static_cast<size_t>(formValue.size)));
+    } else {
+      appendNumber(key, formValue.value);
+    }
+  }
+  appendNumber(key, separator);
+}
+
+bool isRecord(Tag const tag) noexcept {
+  switch (tag) {
+  case (Tag::DW_TAG_structure_type):
+  case (Tag::DW_TAG_class_type):
+  case (Tag::DW_TAG_union_type):
+  case (Tag::DW_TAG_enumeration_type): {
+    return true;
+  }
+  default: {
+    return false;
+  }
+  }
+}
+
+// The forward declarations and the definitions of one qualified name and tag
+struct Declared {
+  std::vector<uint32_t> declarations;
+  std::vector<uint32_t> definitions;
+};
+
+struct SignatureHash {
+  size_t operator()(std::span<uint64_t const> const signature) const noexcept {
+    uint64_t hashValue = 0xcbf29ce484222325U;
+    for (uint64_t const value : signature) {
+      hashValue = (hashValue ^ value) * 0x100000001b3U;
+    }
+    return static_cast<size_t>(hashValue ^ (hashValue >> 29U));
+  }
+};
+
+struct SignatureEqual {
+  bool operator()(std::span<uint64_t const> const lhs, std::span<uint64_t const> const rhs) const noexcept {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+  }
+};
+} // namespace
+
+bool TypeDedup::isType(Tag const tag) noexcept {
+  switch (tag) {
+  case (Tag::DW_TAG_base_type):
+  case (Tag::DW_TAG_unspecified_type):
+  case (Tag::DW_TAG_pointer_type):
+  case (Tag::DW_TAG_reference_type):
+  case (Tag::DW_TAG_rvalue_reference_type):
+  case (Tag::DW_TAG_ptr_to_member_type):
+  case (Tag::DW_TAG_const_type):
+  case (Tag::DW_TAG_volatile_type):
+  case (Tag::DW_TAG_restrict_type):
+  case (Tag::DW_TAG_atomic_type):
+  case (Tag::DW_TAG_typedef):
+  case (Tag::DW_TAG_array_type):
+  case (Tag::DW_TAG_string_type):
+  case (Tag::DW_TAG_set_type):
+  case (Tag::DW_TAG_structure_type):
+  case (Tag::DW_TAG_class_type):
+  case (Tag::DW_TAG_union_type):
+  case (Tag::DW_TAG_enumeration_type):
+  case (Tag::DW_TAG_subroutine_type): {
+    return true;
+  }
+  default: {
+    return false;
+  }
+  }
+}
+
+TypeDedup TypeDedup::build(DIEIndex const &dieIndex) {
+  // the type DIEs are the nodes, numbered in index order
+  std::vector<DIEIndex::UnitInfo> const &units = dieIndex.units();
+  std::vector<std::vector<uint32_t>> unitNodes(units.size());
+  Parallel::forEach(units.size(), [&](size_t const unitIndex, size_t) {
+    for (uint32_t i = units[unitIndex].firstDIE; i < units[unitIndex].endDIE; i++) {
+      if (isType(dieIndex.at(i).tag)) {
+        unitNodes[unitIndex].push_back(i);
+      }
+    }
+  });
+  std::vector<uint32_t> firstNode(units.size() + 1U, 0U);
+  for (size_t i = 0U; i < units.size(); i++) {
+    firstNode[i + 1U] = firstNode[i] + static_cast<uint32_t>(unitNodes[i].size());
+  }
+  uint32_t const nodeCount = firstNode.back();
+  std::vector<uint32_t> nodeOf(dieIndex.size(), DIEIndex::invalidIndex);
+  for (size_t i = 0U; i < units.size(); i++) {
+    for (size_t j = 0U; j < unitNodes[i].size(); j++) {
+      nodeOf[unitNodes[i][j]] = firstNode[i] + static_cast<uint32_t>(j);
+    }
+  }
+
+  // what every type says about itself, and the types it references in a fixed order
+  std::vector<std::string> keys(nodeCount);
+  std::vector<uint32_t> edgeCounts(nodeCount, 0U);
+  std::vector<std::vector<uint64_t>> unitEdges(units.size());
+  // tag and qualified name of the named records, and which of them are forward declarations
+  std::vector<std::string> recordKeys(nodeCount);
+  std::vector<uint8_t> declarations(nodeCount, 0U);
+  // the scope is named through DW_AT_specification, a lambda in an out-of-line member function is not just in "a function"
+  std::vector<std::unique_ptr<QualifiedNames>> qualifiedNames;
+  for (size_t worker = Parallel::workerCount(units.size()); worker > 0U; worker--) {
+    qualifiedNames.push_back(std::make_unique<QualifiedNames>());
+  }
+  Parallel::forEach(units.size(), [&](size_t const unitIndex, size_t const worker) {
+    std::vector<uint64_t> &edges = unitEdges[unitIndex];
+    auto const edge = [&](uint32_t const typeOffset, std::string &key) -> uint64_t {
+      if (typeOffset == 0U) {
+        return noTypeEdge;
+      }
+      uint32_t const target = dieIndex.findIndex(typeOffset);
+      if ((target != DIEIndex::invalidIndex) && (nodeOf[target] != DIEIndex::invalidIndex)) {
+        return nodeOf[target];
+      }
+      // the offset differs from unit to unit, what the target names does not
+      if (target == DIEIndex::invalidIndex) {
+        appendNumber(key, separator);
+      } else {
+        appendNumber(key, static_cast<uint64_t>(dieIndex.at(target).tag));
+        appendText(key, qualifiedNames[worker]->name(dieIndex, target));
+      }
+      return foreignEdge;
+    };
+    for (size_t j = 0U; j < unitNodes[unitIndex].size(); j++) {
+      uint32_t const index = unitNodes[unitIndex][j];
+      uint32_t const node = firstNode[unitIndex] + static_cast<uint32_t>(j);
+      size_t const edgesBefore = edges.size();
+      std::string &key = keys[node];
+      uint32_t const parent = dieIndex.at(index).parent;
+      if ((parent != DIEIndex::invalidIndex) && (dieIndex.at(parent).parent != DIEIndex::invalidIndex)) {
+        appendNumber(key, static_cast<uint64_t>(dieIndex.at(parent).tag));
+        appendText(key, qualifiedNames[worker]->name(dieIndex, parent));
+      }
+      appendNumber(key, separator);
+      appendAttributes(dieIndex, index, key);
+      edges.push_back(edge(dieIndex.at(index).typeOffset, key));
+      if (isRecord(dieIndex.at(index).tag) && (dieIndex.at(index).name != StringPool::noString)) {
+        appendNumber(recordKeys[node], static_cast<uint64_t>(dieIndex.at(index).tag));
+        appendText(recordKeys[node], qualifiedNames[worker]->name(dieIndex, index));
+        std::optional<FormValue> const declaration = dieIndex.attribute(index, AttributeName::DW_AT_declaration);
+        declarations[node] = (declaration.has_value() && (declaration->value != 0U)) ? 1U : 0U;
+      }
+      // nested types are nodes of their own, scoped by this one
+      for (uint32_t child = dieIndex.firstChild(index); child != DIEIndex::invalidIndex; child = dieIndex.at(child).sibling) {
+        Tag const tag = dieIndex.at(child).tag;
+        if ((tag == Tag::DW_TAG_subprogram) || isType(tag)) {
+          continue;
+        }
+        appendAttributes(dieIndex, child, key);
+        edges.push_back(edge(dieIndex.at(child).typeOffset, key));
+      }
+      edgeCounts[node] = static_cast<uint32_t>(edges.size() - edgesBefore);
+    }
+  });
+
+  std::vector<size_t> edgeStarts(static_cast<size_t>(nodeCount) + 1U, 0U);
+  for (uint32_t node = 0U; node < nodeCount; node++) {
+    edgeStarts[node + 1U] = edgeStarts[node] + edgeCounts[node];
+  }
+  std::vector<uint64_t> edges;
+  edges.reserve(edgeStarts.back());
+  for (std::vector<uint64_t> &unit : unitEdges) {
+    edges.insert(edges.end(), unit.begin(), unit.end());
+    std::vector<uint64_t>().swap(unit);
+  }
+
+  std::vector<uint32_t> classes(nodeCount);
+  size_t classCount = 0U;
+  {
+    std::unordered_map<std::string_view, uint32_t> initial;
+    for (uint32_t node = 0U; node < nodeCount; node++) {
+      classes[node] = initial.emplace(keys[node], static_cast<uint32_t>(initial.size())).first->second;
+    }
+    classCount = initial.size();
+  }
+  std::vector<std::string>().swap(keys);
+
+  std::vector<Declared> declared;
+  {
+    std::unordered_map<std::string_view, size_t> byName;
+    for (uint32_t node = 0U; node < nodeCount; node++) {
+      if (recordKeys[node].empty()) {
+        continue;
+      }
+      size_t const entry = byName.emplace(recordKeys[node], declared.size()).first->second;
+      if (entry == declared.size()) {
+        declared.emplace_back();
+      }
+      ((declarations[node] != 0U) ? declared[entry].declarations : declared[entry].definitions).push_back(node);
+    }
+  }
+  std::erase_if(declared, [](Declared const &entry) {
+    return entry.declarations.empty() || entry.definitions.empty();
+  });
+  std::vector<std::string>().swap(recordKeys);
+
+  // a node's signature is its class followed by the classes of its edges; it is at [edgeStarts[node] + node, + edges + 1)
+  // An edge to a resolved forward declaration counts as an edge to its definition
+  TypeDedup result;
+  std::vector<uint32_t> resolved(nodeCount);
+  std::iota(resolved.begin(), resolved.end(), 0U);
+  std::vector<uint32_t> const initialClasses = classes;
+  size_t const initialCount = classCount;
+  std::vector<uint64_t> signatures(edges.size() + nodeCount);
+  std::vector<uint32_t> next(nodeCount);
+  size_t constexpr nodesPerTask = 16384U;
+  size_t const tasks = (static_cast<size_t>(nodeCount) + nodesPerTask - 1U) / nodesPerTask;
+  for (;;) {
+    classes = initialClasses;
+    classCount = initialCount;
+    for (;;) {
+      result.rounds_++;
+      Parallel::forEach(tasks, [&](size_t const task, size_t) {
+        size_t const end = std::min<size_t>(nodeCount, (task + 1U) * nodesPerTask);
+        for (size_t node = task * nodesPerTask; node < end; node++) {
+          uint64_t *signature = signatures.data() + edgeStarts[node] + node;
+          *signature++ = classes[node];
+          for (size_t e = edgeStarts[node]; e < edgeStarts[node + 1U]; e++) {
+            *signature++ = (edges[e] < foreignEdge) ? uint64_t{classes[resolved[edges[e]]]} : edges[e];
+          }
+        }
+      });
+      std::unordered_map<std::span<uint64_t const>, uint32_t, SignatureHash, SignatureEqual> refined;
+      refined.reserve(classCount * 2U);
+      for (uint32_t node = 0U; node < nodeCount; node++) {
+        std::span<uint64_t const> const signature(signatures.data() + edgeStarts[node] + node, edgeStarts[node + 1U] - edgeStarts[node] + 1U);
+        next[node] = refined.emplace(signature, static_cast<uint32_t>(refined.size())).first->second;
+      }
+      classes.swap(next);
+      if (refined.size() == classCount) {
+        break;
+      }
+      classCount = refined.size();
+    }
+
+    // like BTF resolves FWD types: a declaration resolves once all definitions of its name are equal. That may make
+    // more definitions equal, which reference it, so the partition is refined again from the start.
+    bool resolvedMore = false;
+    for (Declared const &entry : declared) {
+      uint32_t const definition = entry.definitions.front();
+      if ((resolved[entry.declarations.front()] == definition) || !std::all_of(entry.definitions.begin(), entry.definitions.end(), [&](uint32_t const node) {
+            return classes[node] == classes[definition];
+          })) {
+        continue;
+      }
+      for (uint32_t const declaration : entry.declarations) {
+        resolved[declaration] = definition;
+      }
+      resolvedMore = true;
+    }
+    if (!resolvedMore) {
+      break;
+    }
+  }
+
+  // the first definition of a class is its canonical type, a resolved declaration maps to that of its definition
+  std::vector<uint32_t> canonicalNode(classCount, DIEIndex::invalidIndex);
+  for (size_t i = 0U; i < units.size(); i++) {
+    for (size_t j = 0U; j < unitNodes[i].size(); j++) {
+      uint32_t const node = firstNode[i] + static_cast<uint32_t>(j);
+      uint32_t &canonical = canonicalNode[classes[node]];
+      if ((resolved[node] == node) && (canonical == DIEIndex::invalidIndex)) {
+        canonical = unitNodes[i][j];
+        result.canonicalCount_++;
+      }
+    }
+  }
+  result.remap_.reserve(nodeCount);
+  for (size_t i = 0U; i < units.size(); i++) {
+    for (size_t j = 0U; j < unitNodes[i].size(); j++) {
+      uint32_t const node = firstNode[i] + static_cast<uint32_t>(j);
+      result.remap_.push_back(Remap{dieIndex.at(unitNodes[i][j]).offset, dieIndex.at(canonicalNode[classes[resolved[node]]]).offset});
+    }
+  }
+  std::sort(result.remap_.begin(), result.remap_.end(), [](Remap const &lhs, Remap const &rhs) {
+    return lhs.offset < rhs.offset;
+  });
+  return result;
+}
+
+uint32_t TypeDedup::canonical(uint32_t const offset) const noexcept {
+  std::vector<Remap>::const_iterator const it = std::lower_bound(remap_.begin(), remap_.end(), offset, [](Remap const &remap, uint32_t const value) {
+    return remap.offset < value;
+  });
+  return ((it == remap_.end()) || (it->offset != offset)) ? offset : it->canonical;
+}
@@ -0,0 +1,58 @@
+#ifndef TYPE_DEDUP_HPP
+#define TYPE_DEDUP_HPP
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "DebugAbbrev.hpp"
+
+class DIEIndex;
+
+// Collapses the type DIEs which describe the same type, in whatever unit, into one canonical DIE, like BTF
+// deduplication does for std::string and friends repeated in every unit. Types are first partitioned by what they say
+// about themselves: the qualified scope they are declared in, their tag and attributes, and those of their children
+// which are not types themselves (members, enumerators, parameters, subranges). References and source positions are
+// left out. The partition is then refined by the classes of the referenced types until no class splits any more.
+// Refinement only splits, so the result is the coarsest partition in which equal types reference equal types; recursive
+// types such as a list node pointing to itself come out equal across units without any special casing of cycles.
+// Member functions are ignored, as template classes list only the members instantiated in a unit. A forward
+// declaration of a named record or enum resolves to the definition of the same qualified name and tag once all such
+// definitions are equal, so a class holding a pointer to a type which only some units define is still one type.
+class TypeDedup {
+public:
+  struct Remap {
+    uint32_t offset;    // DIE offset of a type
+    uint32_t canonical; // DIE offset of the first equal type in index order
+  };
+
+  static TypeDedup build(DIEIndex const &dieIndex);
+
+  // Canonical DIE offset of the type at offset, offset itself for DIEs which are not types
+  uint32_t canonical(uint32_t const offset) const noexcept;
+
+  inline bool isCanonical(uint32_t const offset) const noexcept {
+    return canonical(offset) == offset;
+  }
+
+  // Every type DIE, sorted by offset
+  inline std::span<Remap const> remap() const noexcept {
+    return remap_;
+  }
+
+  inline size_t canonicalCount() const noexcept {
+    return canonicalCount_;
+  }
+
+  inline uint32_t rounds() const noexcept {
+    return rounds_;
+  }
+
+  static bool isType(DebugAbbrev::Tag const tag) noexcept;
+
+private:
+  std::vector<Remap> remap_;
+  size_t canonicalCount_ = 0U;
+  uint32_t rounds_ = 0U; // refinement rounds until the partition was stable
+};
+
+#endif
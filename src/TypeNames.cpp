@@ -0,0 +1,315 @@
+#include "TypeNames.hpp"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include "DIEIndex.hpp"
+
+namespace {
+bool endsWithDeclarator(std::string_view const prefix) noexcept {
+  return !prefix.empty() && ((prefix.back() == '*') || (prefix.back() == '&'));
+}
+
+uint64_t constexpr ateSigned = 0x05U;     // DW_ATE_signed
+uint64_t constexpr ateSignedChar = 0x06U; // DW_ATE_signed_char
+
+// Whether the type at typeOffset is a signed integer, behind typedefs, qualifiers and the underlying type of an enum
+bool isSignedType(DIEIndex const &dieIndex, uint32_t typeOffset) {
+  // a broken chain could loop
+  for (uint32_t hops = 0U; (typeOffset != 0U) && (hops < 32U); hops++) {
+    uint32_t const index = dieIndex.findIndex(typeOffset);
+    if (index == DIEIndex::invalidIndex) {
+      return false;
+    }
+    DIEIndex::DIEInfo const &die = dieIndex.at(index);
+    switch (die.tag) {
+    case (DebugAbbrev::Tag::DW_TAG_typedef):
+    case (DebugAbbrev::Tag::DW_TAG_const_type):
+    case (DebugAbbrev::Tag::DW_TAG_volatile_type):
+    case (DebugAbbrev::Tag::DW_TAG_enumeration_type): {
+      typeOffset = die.typeOffset;
+      break;
+    }
+    case (DebugAbbrev::Tag::DW_TAG_base_type): {
+      std::optional<FormValue> const encoding = dieIndex.attribute(index, DebugAbbrev::AttributeName::DW_AT_encoding);
+      return encoding.has_value() && ((encoding->value == ateSigned) || (encoding->value == ateSignedChar));
+    }
+    default: {
+      return false;
+    }
+    }
+  }
+  return false;
+}
+
+// A constant as the source spelled it: the fixed size forms hold the bits of the value, which are sign extended for a
+// signed type; sdata and implicit_const are signed whatever the type
+std::string constantText(FormValue const &constant, bool const signedType) {
+  uint32_t bits = 64U;
+  switch (constant.form) {
+  case (DebugAbbrev::Form::DW_FORM_sdata):
+  case (DebugAbbrev::Form::DW_FORM_implicit_const): {
+    return std::to_string(static_cast<int64_t>(constant.value));
+  }
+  case (DebugAbbrev::Form::DW_FORM_data1): {
+    bits = 8U;
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_data2): {
+    bits = 16U;
+    break;
+  }
+  case (DebugAbbrev::Form::DW_FORM_data4): {
+    bits = 32U;
+    break;
+  }
+  default: {
+    break;
+  }
+  }
+  if (!signedType) {
+    return std::to_string(constant.value);
+  }
+  uint64_t const signBit = uint64_t{1U} << (bits - 1U);
+  return std::to_string(static_cast<int64_t>((constant.value ^ signBit) - signBit));
+}
+} // namespace
+
+std::string_view TypeNames::name(DIEIndex const &dieIndex, uint32_t const offset) {
+  uint32_t const index = dieIndex.findIndex(offset);
+  if (index == DIEIndex::invalidIndex) {
+    return std::string_view();
+  }
+
+  std::lock_guard<std::mutex> const lock(mutex_);
+  std::unordered_map<uint32_t, std::string_view>::const_iterator const it = fullNames_.find(offset);
+  if (it != fullNames_.end()) {
+    return it->second;
+  }
+
+  Rendered rendered;
+  bool const complete = render(dieIndex, index, rendered);
+  std::string_view const full = rendered.suffix.empty() ? rendered.prefix : arena_.concat(rendered.prefix, rendered.suffix);
+  if (complete) {
+    fullNames_.emplace(offset, full);
+  }
+  return full;
+}
+
+bool TypeNames::renderReferenced(DIEIndex const &dieIndex, uint32_t const typeOffset, Rendered &rendered) {
+  if (typeOffset == 0U) {
+    rendered = Rendered{"void", std::string_view()};
+    return true;
+  }
+  uint32_t const index = dieIndex.findIndex(typeOffset);
+  if (index == DIEIndex::invalidIndex) {
+    rendered = Rendered{"?", std::string_view()};
+    return false;
+  }
+  return render(dieIndex, index, rendered);
+}
+
+bool TypeNames::renderFull(DIEIndex const &dieIndex, uint32_t const typeOffset, std::string &full) {
+  Rendered rendered;
+  bool const complete = renderReferenced(dieIndex, typeOffset, rendered);
+  full.append(rendered.prefix);
+  full.append(rendered.suffix);
+  return complete;
+}
+
+void TypeNames::applyPointer(Rendered const &inner, std::string_view const token, Rendered &rendered) {
+  // pointers to arrays and functions need parentheses: int (*)[4], int (*)(char)
+  bool const needsParentheses = !inner.suffix.empty() && ((inner.suffix.front() == '[') || (inner.suffix.front() == '('));
+  if (needsParentheses) {
+    rendered.prefix = arena_.concat(inner.prefix, " (", token);
+    rendered.suffix = arena_.concat(")", inner.suffix);
+  } else {
+    // member pointer tokens start with the class name: int S::*
+    bool const separate = !token.empty() && (token.front() != '*') && (token.front() != '&');
+    rendered.prefix = separate ? arena_.concat(inner.prefix, " ", token) : arena_.concat(inner.prefix, token);
+    rendered.suffix = inner.suffix;
+  }
+}
+
+void TypeNames::applyQualifier(Rendered const &inner, std::string_view const qualifier, Rendered &rendered) {
+  // qualifiers bind to the pointer when there is one (int* const), otherwise they are written in front (const int)
+  if (endsWithDeclarator(inner.prefix)) {
+    rendered.prefix = arena_.concat(inner.prefix, " ", qualifier);
+  } else {
+    rendered.prefix = arena_.concat(qualifier, " ", inner.prefix);
+  }
+  rendered.suffix = inner.suffix;
+}
+
+bool TypeNames::renderArrayBounds(DIEIndex const &dieIndex, uint32_t const index, std::string &bounds) {
+  for (uint32_t child = dieIndex.firstChild(index); child != DIEIndex::invalidIndex; child = dieIndex.at(child).sibling) {
+    if (dieIndex.at(child).tag != DebugAbbrev::Tag::DW_TAG_subrange_type) {
+      continue;
+    }
+    bounds.push_back('[');
+    std::optional<FormValue> const count = dieIndex.attribute(child, DebugAbbrev::AttributeName::DW_AT_count);
+    if (count.has_value() && count->isConstant()) {
+      bounds.append(std::to_string(count->value));
+    } else {
+      std::optional<FormValue> const upperBound = dieIndex.attribute(child, DebugAbbrev::AttributeName::DW_AT_upper_bound);
+      if (upperBound.has_value() && upperBound->isConstant()) {
+        std::optional<FormValue> const lowerBound = dieIndex.attribute(child, DebugAbbrev::AttributeName::DW_AT_lower_bound);
+        uint64_t const lower = (lowerBound.has_value() && lowerBound->isConstant()) ? lowerBound->value : 0U;
+        bounds.append(std::to_string(upperBound->value + 1U - lower));
+      }
+    }
+    bounds.push_back(']');
+  }
+  if (bounds.empty()) {
+    bounds = "[]";
+  }
+  return true;
+}
+
+bool TypeNames::renderParameters(DIEIndex const &dieIndex, uint32_t const index, std::string &parameters) {
+  bool complete = true;
+  parameters.push_back('(');
+  bool first = true;
+  for (uint32_t child = dieIndex.firstChild(index); child != DIEIndex::invalidIndex; child = dieIndex.at(child).sibling) {
+    DIEIndex::DIEInfo const &parameter = dieIndex.at(child);
+    if (parameter.tag == DebugAbbrev::Tag::DW_TAG_formal_parameter) {
+      std::optional<FormValue> const artificial = dieIndex.attribute(child, DebugAbbrev::AttributeName::DW_AT_artificial);
+      if (artificial.has_value() && (artificial->value != 0U)) {
+        continue; // the this pointer of member functions
+      }
+      if (!first) {
+        parameters.append(", ");
+      }
+      complete = renderFull(dieIndex, parameter.typeOffset, parameters) && complete;
+      first = false;
+    } else if (parameter.tag == DebugAbbrev::Tag::DW_TAG_unspecified_parameters) {
+      parameters.append(first ? "..." : ", ...");
+      first = false;
+    }
+  }
+  parameters.push_back(')');
+  return complete;
+}
+
+bool TypeNames::renderTemplateArguments(DIEIndex const &dieIndex, uint32_t const index, std::string &arguments) {
+  bool complete = true;
+  for (uint32_t child = dieIndex.firstChild(index); child != DIEIndex::invalidIndex; child = dieIndex.at(child).sibling) {
+    DIEIndex::DIEInfo const &parameter = dieIndex.at(child);
+    if (parameter.tag == DebugAbbrev::Tag::DW_TAG_GNU_template_parameter_pack) {
+      complete = renderTemplateArguments(dieIndex, child, arguments) && complete;
+      continue;
+    }
+    if ((parameter.tag != DebugAbbrev::Tag::DW_TAG_template_type_parameter) && (parameter.tag != DebugAbbrev::Tag::DW_TAG_template_value_parameter)) {
+      continue;
+    }
+    if (!arguments.empty()) {
+      arguments.append(", ");
+    }
+    if (parameter.tag == DebugAbbrev::Tag::DW_TAG_template_type_parameter) {
+      complete = renderFull(dieIndex, parameter.typeOffset, arguments) && complete;
+    } else {
+      std::optional<FormValue> const constValue = dieIndex.attribute(child, DebugAbbrev::AttributeName::DW_AT_const_value);
+      if (constValue.has_value() && constValue->isConstant()) {
+        arguments.append(constantText(*constValue, isSignedType(dieIndex, parameter.typeOffset)));
+      } else {
+        arguments.append(dieIndex.name(child));
+      }
+    }
+  }
+  return complete;
+}
+
+bool TypeNames::render(DIEIndex const &dieIndex, uint32_t const index, Rendered &rendered) {
+  DIEIndex::DIEInfo const &die = dieIndex.at(index);
+  std::unordered_map<uint32_t, Rendered>::const_iterator const cached = rendered_.find(die.offset);
+  if (cached != rendered_.end()) {
+    rendered = cached->second;
+    return true;
+  }
+  if (!active_.insert(die.offset).second) {
+    rendered = Rendered{"?", std::string_view()};
+    return false;
+  }
+
+  bool complete = true;
+  switch (die.tag) {
+  case (DebugAbbrev::Tag::DW_TAG_pointer_type):
+  case (DebugAbbrev::Tag::DW_TAG_reference_type):
+  case (DebugAbbrev::Tag::DW_TAG_rvalue_reference_type): {
+    Rendered inner;
+    complete = renderReferenced(dieIndex, die.typeOffset, inner);
+    std::string_view const token = (die.tag == DebugAbbrev::Tag::DW_TAG_pointer_type) ? "*" : ((die.tag == DebugAbbrev::Tag::DW_TAG_reference_type) ? "&" : "&&");
+    applyPointer(inner, token, rendered);
+    break;
+  }
+  case (DebugAbbrev::Tag::DW_TAG_ptr_to_member_type): {
+    Rendered inner;
+    complete = renderReferenced(dieIndex, die.typeOffset, inner);
+    std::string token;
+    std::optional<FormValue> const containingType = dieIndex.attribute(index, DebugAbbrev::AttributeName::DW_AT_containing_type);
+    if (containingType.has_value()) {
+      complete = renderFull(dieIndex, static_cast<uint32_t>(containingType->value), token) && complete;
+    }
+    token.append("::*");
+    applyPointer(inner, arena_.store(token), rendered);
+    break;
+  }
+  case (DebugAbbrev::Tag::DW_TAG_const_type):
+  case (DebugAbbrev::Tag::DW_TAG_volatile_type):
+  case (DebugAbbrev::Tag::DW_TAG_restrict_type): {
+    Rendered inner;
+    complete = renderReferenced(dieIndex, die.typeOffset, inner);
+    std::string_view const qualifier = (die.tag == DebugAbbrev::Tag::DW_TAG_const_type) ? "const" : ((die.tag == DebugAbbrev::Tag::DW_TAG_volatile_type) ? "volatile" : "restrict");
+    applyQualifier(inner, qualifier, rendered);
+    break;
+  }
+  case (DebugAbbrev::Tag::DW_TAG_array_type): {
+    Rendered element;
+    complete = renderReferenced(dieIndex, die.typeOffset, element);
+    std::string bounds;
+    complete = renderArrayBounds(dieIndex, index, bounds) && complete;
+    rendered.prefix = element.prefix;
+    rendered.suffix = arena_.concat(bounds, element.suffix);
+    break;
+  }
+  case (DebugAbbrev::Tag::DW_TAG_subroutine_type): {
+    std::string returnType;
+    complete = renderFull(dieIndex, die.typeOffset, returnType);
+    std::string parameters;
+    complete = renderParameters(dieIndex, index, parameters) && complete;
+    rendered.prefix = arena_.store(returnType);
+    rendered.suffix = arena_.store(parameters);
+    break;
+  }
+  case (DebugAbbrev::Tag::DW_TAG_structure_type):
+  case (DebugAbbrev::Tag::DW_TAG_class_type):
+  case (DebugAbbrev::Tag::DW_TAG_union_type): {
+    std::string_view qualifiedName;
+    complete = dieIndex.qualifiedName(index, qualifiedName);
+    if ((die.name != StringPool::noString) && (dieIndex.name(index).find('<') == std::string_view::npos)) {
+      // producers which omit template arguments from DW_AT_name still list them as children
+      std::string arguments;
+      complete = renderTemplateArguments(dieIndex, index, arguments) && complete;
+      rendered.prefix = arguments.empty() ? qualifiedName : arena_.concat(qualifiedName, "<", arguments + ">");
+    } else {
+      rendered.prefix = qualifiedName;
+    }
+    break;
+  }
+  case (DebugAbbrev::Tag::DW_TAG_enumeration_type):
+  case (DebugAbbrev::Tag::DW_TAG_typedef): {
+    complete = dieIndex.qualifiedName(index, rendered.prefix);
+    break;
+  }
+  default: {
+    // base types and everything else which is known by its plain name
+    rendered.prefix = (die.name == StringPool::noString) ? std::string_view("?") : dieIndex.name(index);
+    break;
+  }
+  }
+
+  active_.erase(die.offset);
+  if (complete) {
+    rendered_.emplace(die.offset, rendered);
+  }
+  return complete;
+}
@@ -0,0 +1,44 @@
+#ifndef TYPE_NAMES_HPP
+#define TYPE_NAMES_HPP
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include "StringArena.hpp"
+
+class DIEIndex;
+
+// Renders type DIEs as C++ type names, e.g. "const C<int>*[4]" or "int (*)(char, ...)".
+// Every type is rendered once: the declarator is kept as a prefix and a suffix (the part which goes behind the
+// declared name, array bounds and parameter lists) so that a pointer, qualifier or array wrapped around an already
+// rendered type only concatenates the cached pieces, which live in an arena or view the section data, keyed by DIE offset.
+class TypeNames {
+public:
+  // Empty if offset is not a DIE of dieIndex. Thread safe.
+  std::string_view name(DIEIndex const &dieIndex, uint32_t const offset);
+
+private:
+  struct Rendered {
+    std::string_view prefix;
+    std::string_view suffix;
+  };
+
+  // The render functions return false if some referenced DIE was missing, such results are not memoized
+  bool render(DIEIndex const &dieIndex, uint32_t const index, Rendered &rendered);
+  bool renderReferenced(DIEIndex const &dieIndex, uint32_t const typeOffset, Rendered &rendered);
+  bool renderFull(DIEIndex const &dieIndex, uint32_t const typeOffset, std::string &full);
+  void applyPointer(Rendered const &inner, std::string_view const token, Rendered &rendered);
+  void applyQualifier(Rendered const &inner, std::string_view const qualifier, Rendered &rendered);
+  bool renderArrayBounds(DIEIndex const &dieIndex, uint32_t const index, std::string &bounds);
+  bool renderParameters(DIEIndex const &dieIndex, uint32_t const index, std::string &parameters);
+  bool renderTemplateArguments(DIEIndex const &dieIndex, uint32_t const index, std::string &arguments);
+
+  std::mutex mutex_;
+  StringArena arena_;
+  std::unordered_map<uint32_t, Rendered> rendered_;
+  std::unordered_map<uint32_t, std::string_view> fullNames_;
+  std::unordered_set<uint32_t> active_; // DIEs currently being rendered, breaks cycles in malformed input
+};
+
+#endif
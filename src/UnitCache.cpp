@@ -0,0 +1,116 @@
+#include "UnitCache.hpp"
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "ByteReader.hpp"
+
+namespace {
+std::array<char, 4> constexpr magic = {'D', 'W', 'U', 'C'};
+uint32_t constexpr formatVersion = 1U;
+
+template <typename T>
+void write(std::ofstream &out, T const value) {
+  out.write(reinterpret_cast<char const *>(&value), sizeof(value));
+}
+
+void writeRecord(std::ofstream &out, uint64_t const key, std::span<uint8_t const> const record) {
+  write(out, key);
+  write(out, static_cast<uint64_t>(record.size()));
+  out.write(reinterpret_cast<char const *>(record.data()), static_cast<std::streamsize>(record.size()));
+}
+
+// The records of a cache file behind the magic, none if another version of the format wrote them. Throws if the file
+// is truncated or corrupt.
+std::unordered_map<uint64_t, std::span<uint8_t const>> readRecords(std::span<uint8_t const> const bytes) {
+  size_t constexpr recordHeaderSize = 2U * sizeof(uint64_t); // key and size
+  std::unordered_map<uint64_t, std::span<uint8_t const>> records;
+  ByteReader reader(bytes.data(), bytes.size());
+  if (reader.getNumber<uint32_t>() != formatVersion) {
+    return records;
+  }
+  uint64_t const count = reader.getNumber<uint64_t>();
+  if (count > (static_cast<size_t>(reader.end_ - reader.cursor_) / recordHeaderSize)) {
+    throw std::runtime_error("wrong unit cache record count");
+  }
+  records.reserve(static_cast<size_t>(count));
+  for (uint64_t i = 0U; i < count; i++) {
+    if (static_cast<size_t>(reader.end_ - reader.cursor_) < recordHeaderSize) {
+      throw std::runtime_error("unit cache is truncated");
+    }
+    uint64_t const key = reader.getNumber<uint64_t>();
+    uint64_t const size = reader.getNumber<uint64_t>();
+    if (size > static_cast<uint64_t>(reader.end_ - reader.cursor_)) {
+      throw std::runtime_error("unit cache is truncated");
+    }
+    records.emplace(key, std::span<uint8_t const>(reader.cursor_, static_cast<size_t>(size)));
+    reader.step(static_cast<size_t>(size));
+  }
+  return records;
+}
+} // namespace
+
+UnitCache UnitCache::load(std::string const &path) {
+  UnitCache cache;
+  cache.file_ = MappedFile::open(path);
+  if (!cache.file_.isOpen()) {
+    return cache;
+  }
+  std::span<uint8_t const> const bytes = cache.file_.bytes();
+  if (bytes.size() < magic.size()) {
+    return cache; // cut off before the magic
+  }
+  if (memcmp(bytes.data(), magic.data(), magic.size()) != 0) {
+    // the file is replaced by save, better not if it is something else
+    throw std::runtime_error(path + " is not a unit cache");
+  }
+  try {
+    cache.loaded_ = readRecords(bytes.subspan(magic.size()));
+  } catch (std::runtime_error const &) {
+    // a truncated or corrupt cache is rebuilt by this run, save replaces it
+    cache.loaded_.clear();
+  }
+  return cache;
+}
+
+std::optional<std::span<uint8_t const>> UnitCache::find(uint64_t const key) {
+  std::unordered_map<uint64_t, std::span<uint8_t const>>::const_iterator const it = loaded_.find(key);
+  if (it == loaded_.end()) {
+    return std::nullopt;
+  }
+  found_.emplace(key, it->second);
+  return it->second;
+}
+
+void UnitCache::store(uint64_t const key, std::vector<uint8_t> &&record) {
+  stored_.insert_or_assign(key, std::move(record));
+}
+
+void UnitCache::save(std::string const &path) const {
+  std::string const temporary = path + ".tmp";
+  {
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    out.write(magic.data(), static_cast<std::streamsize>(magic.size()));
+    write(out, formatVersion);
+    uint64_t count = stored_.size();
+    for (std::pair<uint64_t const, std::span<uint8_t const>> const &record : found_) {
+      count += static_cast<uint64_t>(stored_.count(record.first) == 0U);
+    }
+    write(out, count);
+    for (std::pair<uint64_t const, std::span<uint8_t const>> const &record : found_) {
+      if (stored_.count(record.first) == 0U) {
+        writeRecord(out, record.first, record.second);
+      }
+    }
+    for (std::pair<uint64_t const, std::vector<uint8_t>> const &record : stored_) {
+      writeRecord(out, record.first, record.second);
+    }
+    if (!out) {
+      throw std::runtime_error("can not write " + temporary);
+    }
+  }
+  if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+    throw std::runtime_error("can not replace " + path);
+  }
+}
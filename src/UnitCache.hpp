@@ -0,0 +1,35 @@
+#ifndef UNIT_CACHE_HPP
+#define UNIT_CACHE_HPP
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "MappedFile.hpp"
+
+// Records of a per unit analysis from an earlier run, keyed by the fingerprint of the unit, see UnitFingerprints. The
+// file is mapped, not read: a record is only touched if its unit is unchanged. save writes back the records found or
+// stored in this run only, so the cache does not grow with every build, and writes them to a temporary file which then
+// replaces the old one, so that an interrupted run leaves a usable cache.
+class UnitCache {
+public:
+  // An empty cache if the file does not exist, is truncated or corrupt, or was written by another version of the format.
+  // Throws if the file is something else than a unit cache.
+  static UnitCache load(std::string const &path);
+
+  // The record stored under key; it is kept for save
+  std::optional<std::span<uint8_t const>> find(uint64_t const key);
+
+  void store(uint64_t const key, std::vector<uint8_t> &&record);
+
+  void save(std::string const &path) const;
+
+private:
+  MappedFile file_;
+  std::unordered_map<uint64_t, std::span<uint8_t const>> loaded_; // into file_
+  std::unordered_map<uint64_t, std::span<uint8_t const>> found_;
+  std::unordered_map<uint64_t, std::vector<uint8_t>> stored_;
+};
+
+#endif
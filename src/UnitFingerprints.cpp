@@ -0,0 +1,243 @@
+#include "UnitFingerprints.hpp"
+#include <algorithm>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include "ByteReader.hpp"
+#include "FormValue.hpp"
+#include "LineTable.hpp"
+#include "Parallel.hpp"
+
+namespace {
+using Form = DebugAbbrev::Form;
+
+uint8_t constexpr opAddr = 0x03U; // DW_OP_addr
+
+class Hasher {
+public:
+  inline void add(uint64_t const value) noexcept {
+    state_ = (state_ ^ value) * 0x100000001b3U;
+    state_ ^= state_ >> 29U;
+  }
+
+  void add(std::span<uint8_t const> const bytes) noexcept {
+    add(bytes.size());
+    size_t i = 0U;
+    for (; (i + sizeof(uint64_t)) <= bytes.size(); i += sizeof(uint64_t)) {
+      uint64_t word;
+      memcpy(&word, bytes.data() + i, sizeof(word));
+      add(word);
+    }
+    if (i < bytes.size()) {
+      uint64_t tail = 0U;
+      memcpy(&tail, bytes.data() + i, bytes.size() - i);
+      add(tail);
+    }
+  }
+
+  inline void add(std::string_view const text) noexcept {
+    add(std::span<uint8_t const>(reinterpret_cast<uint8_t const *>(text.data()), text.size()));
+  }
+
+  // splitmix64 finalizer, so that fingerprints differing in few bits spread over the whole word
+  inline uint64_t finish() const noexcept {
+    uint64_t value = state_;
+    value = (value ^ (value >> 30U)) * 0xbf58476d1ce4e5b9U;
+    value = (value ^ (value >> 27U)) * 0x94d049bb133111ebU;
+    return value ^ (value >> 31U);
+  }
+
+private:
+  uint64_t state_ = 0xcbf29ce484222325U;
+};
+
+// Index of the unit containing offset, units.size() if there is none
+size_t findUnit(std::vector<UnitInfo> const &units, uint64_t const offset) noexcept {
+  std::vector<UnitInfo>::const_iterator const it = std::upper_bound(units.begin(), units.end(), offset, [](uint64_t const value, UnitInfo const &unit) {
+    return value < unit.offset;
+  });
+  if ((it == units.begin()) || (offset >= (it - 1)->end)) {
+    return units.size();
+  }
+  return static_cast<size_t>((it - 1) - units.begin());
+}
+
+// Up to DWARF3 there is no DW_FORM_sec_offset, offsets into .debug_line, .debug_loc, .debug_ranges and .debug_macinfo
+// are data4 or data8 values of the attributes which take them. GCC emits its location views and macros that way too.
+bool isSectionOffset(UnitInfo const &unit, DebugAbbrev::AttributeName const attributeName, Form const form) noexcept {
+  if (form == Form::DW_FORM_sec_offset) {
+    return true;
+  }
+  if ((unit.version >= 4U) || ((form != Form::DW_FORM_data4) && (form != Form::DW_FORM_data8))) {
+    return false;
+  }
+  switch (attributeName) {
+  case (DebugAbbrev::AttributeName::DW_AT_location):
+  case (DebugAbbrev::AttributeName::DW_AT_stmt_list):
+  case (DebugAbbrev::AttributeName::DW_AT_string_length):
+  case (DebugAbbrev::AttributeName::DW_AT_return_addr):
+  case (DebugAbbrev::AttributeName::DW_AT_data_member_location):
+  case (DebugAbbrev::AttributeName::DW_AT_frame_base):
+  case (DebugAbbrev::AttributeName::DW_AT_macro_info):
+  case (DebugAbbrev::AttributeName::DW_AT_segment):
+  case (DebugAbbrev::AttributeName::DW_AT_static_link):
+  case (DebugAbbrev::AttributeName::DW_AT_use_location):
+  case (DebugAbbrev::AttributeName::DW_AT_vtable_elem_location):
+  case (DebugAbbrev::AttributeName::DW_AT_ranges):
+  case (DebugAbbrev::AttributeName::DW_AT_GNU_macros):
+  case (DebugAbbrev::AttributeName::DW_AT_GNU_locviews): {
+    return true;
+  }
+  default: {
+    return false;
+  }
+  }
+}
+
+// The unit alone, its direct references to other units are appended to references
+uint64_t hashUnit(DwarfSections const &sections, DebugAbbrev::AbbrevTable const &abbrevTable, std::vector<UnitInfo> const &units, size_t const unitIndex,
+                  std::vector<size_t> &references) {
+  UnitInfo const &unit = units[unitIndex];
+  Hasher hasher;
+  hasher.add(unit.version);
+  hasher.add(static_cast<uint64_t>(unit.unitType));
+  hasher.add(unit.addressSize);
+  hasher.add(unit.signature);
+  hasher.add(unit.typeOffset);
+
+  DwarfSections::UnitSection const section = sections.unitSection(unit.offset);
+  ByteReader reader(section.data.data(), section.data.size());
+  reader.step((unit.offset - section.base) + unit.headerSize);
+  while ((section.base + static_cast<uint32_t>(reader.getOffset())) < unit.end) {
+    uint64_t const abbrevIndex = reader.readLEB128(false);
+    hasher.add(abbrevIndex == 0U); // the end of a sibling chain shapes the tree
+    if (abbrevIndex == 0U) {
+      continue;
+    }
+    DebugAbbrev::AbbrevTable::const_iterator const it = abbrevTable.find(abbrevIndex);
+    if (it == abbrevTable.end()) {
+      throw std::runtime_error("abbrevIndex not found in debugAbbrevTable");
+    }
+    hasher.add(static_cast<uint64_t>(it->second.tag));
+    hasher.add(it->second.hasChildren);
+    for (DebugAbbrev::AttributeSpecification const &attributeSpec : it->second.attributeSpecifications) {
+      hasher.add(static_cast<uint64_t>(attributeSpec.attributeName));
+      hasher.add(static_cast<uint64_t>(attributeSpec.form));
+      FormValue const formValue = FormValue::read(reader, attributeSpec, unit);
+      switch (isSectionOffset(unit, attributeSpec.attributeName, formValue.form) ? Form::DW_FORM_sec_offset : formValue.form) {
+      case (Form::DW_FORM_addr): {
+        break; // also addrx, resolved through .debug_addr
+      }
+      case (Form::DW_FORM_sec_offset): {
+        // also rnglistx, loclistx and the offsets of DWARF3; the line program header holds the file table DW_AT_decl_file indexes
+        if (attributeSpec.attributeName == DebugAbbrev::AttributeName::DW_AT_stmt_list) {
+          LineTable const header = LineTable::decode(sections, unit, formValue.value, std::string_view(), true);
+          for (std::string const &fileName : header.fileNames()) {
+            hasher.add(fileName);
+          }
+        }
+        break;
+      }
+      case (Form::DW_FORM_string):
+      case (Form::DW_FORM_strp):
+      case (Form::DW_FORM_line_strp):
+      case (Form::DW_FORM_GNU_strp_alt):
+      case (Form::DW_FORM_strp_sup): {
+        hasher.add(sections.string(formValue));
+        break;
+      }
+      case (Form::DW_FORM_ref1):
+      case (Form::DW_FORM_ref2):
+      case (Form::DW_FORM_ref4):
+      case (Form::DW_FORM_ref8):
+      case (Form::DW_FORM_ref_udata): {
+        hasher.add(formValue.value - unit.offset);
+        break;
+      }
+      case (Form::DW_FORM_ref_addr):
+      case (Form::DW_FORM_GNU_ref_alt):
+      case (Form::DW_FORM_ref_sup4):
+      case (Form::DW_FORM_ref_sup8): {
+        size_t const target = findUnit(units, formValue.value);
+        if (target == units.size()) {
+          hasher.add(formValue.value);
+          break;
+        }
+        hasher.add(formValue.value - units[target].offset);
+        if (target != unitIndex) {
+          references.push_back(target);
+        }
+        break;
+      }
+      case (Form::DW_FORM_block1):
+      case (Form::DW_FORM_block2):
+      case (Form::DW_FORM_block4):
+      case (Form::DW_FORM_block):
+      case (Form::DW_FORM_exprloc): {
+        // the location of a global variable is its relocated address
+        bool const isAddress = (formValue.size == (1U + static_cast<uint64_t>(unit.addressSize))) && (formValue.data[0] == opAddr);
+        hasher.add(std::span<uint8_t const>(formValue.data, isAddress ? 1U : static_cast<size_t>(formValue.size)));
+        break;
+      }
+      case (Form::DW_FORM_data16): {
+        hasher.add(std::span<uint8_t const>(formValue.data, 16U));
+        break;
+      }
+      default: {
+        hasher.add(formValue.value);
+        break;
+      }
+      }
+    }
+  }
+  return hasher.finish();
+}
+} // namespace
+
+UnitFingerprints UnitFingerprints::compute(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections,
+                                           std::vector<UnitInfo> const &units) {
+  UnitFingerprints result;
+  std::vector<uint64_t> own(units.size());
+  result.references_.resize(units.size());
+  Parallel::forEach(units.size(), [&](size_t const unitIndex, size_t) {
+    std::vector<size_t> &references = result.references_[unitIndex];
+    own[unitIndex] = hashUnit(sections, debugAbbrevSections.at(units[unitIndex].abbrevOffset), units, unitIndex, references);
+    std::sort(references.begin(), references.end());
+    references.erase(std::unique(references.begin(), references.end()), references.end());
+  });
+
+  result.fingerprints_ = own;
+  Parallel::forEach(units.size(), [&](size_t const unitIndex, size_t) {
+    if (result.references_[unitIndex].empty()) {
+      return;
+    }
+    Hasher hasher;
+    hasher.add(own[unitIndex]);
+    for (size_t const reached : result.reachable(unitIndex)) {
+      hasher.add(own[reached]);
+    }
+    result.fingerprints_[unitIndex] = hasher.finish();
+  });
+  return result;
+}
+
+std::vector<size_t> UnitFingerprints::reachable(size_t const unitIndex) const {
+  std::vector<bool> visited(references_.size(), false);
+  visited[unitIndex] = true;
+  std::vector<size_t> pending(references_[unitIndex]);
+  std::vector<size_t> result;
+  while (!pending.empty()) {
+    size_t const next = pending.back();
+    pending.pop_back();
+    if (visited[next]) {
+      continue;
+    }
+    visited[next] = true;
+    result.push_back(next);
+    pending.insert(pending.end(), references_[next].begin(), references_[next].end());
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
@@ -0,0 +1,37 @@
+#ifndef UNIT_FINGERPRINTS_HPP
+#define UNIT_FINGERPRINTS_HPP
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "DebugAbbrev.hpp"
+#include "DwarfSections.hpp"
+#include "UnitInfo.hpp"
+
+// A 64-bit hash per unit of what the unit says, which stays the same when an unchanged unit is linked into the next
+// build. Every DIE contributes its tag, the name and form of each attribute from its abbreviation, and the attribute
+// values, so a renumbered abbreviation table does not matter but a changed one does. Values which only locate the unit
+// in this link are left out: addresses, DW_OP_addr of a location expression and offsets into other sections. Strings
+// are hashed by their text rather than their .debug_str offset, references by their offset in the target unit.
+// DW_AT_stmt_list contributes the file names of the line program header instead of its offset.
+// A unit referencing other units with DW_FORM_ref_addr, e.g. after LTO or dwz, describes itself partly through them, so
+// its fingerprint includes those of all units it reaches that way.
+class UnitFingerprints {
+public:
+  // units are sorted by offset, as readUnitHeaders returns them; the units are hashed in parallel
+  static UnitFingerprints compute(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections,
+                                  std::vector<UnitInfo> const &units);
+
+  inline uint64_t fingerprint(size_t const unitIndex) const noexcept {
+    return fingerprints_[unitIndex];
+  }
+
+  // Indices of the units unitIndex references with DW_FORM_ref_addr, directly or through other units, sorted
+  std::vector<size_t> reachable(size_t const unitIndex) const;
+
+private:
+  std::vector<uint64_t> fingerprints_;
+  std::vector<std::vector<size_t>> references_; // direct DW_FORM_ref_addr targets of every unit, sorted
+};
+
+#endif
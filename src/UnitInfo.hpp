@@ -0,0 +1,83 @@
+#ifndef UNIT_INFO_HPP
+#define UNIT_INFO_HPP
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+
+// Header of one unit of .debug_info or .debug_types together with the parts of the DWARF 5 indirection tables that belong to it.
+// The tables are spans into the sections, starting at the DW_AT_str_offsets_base, DW_AT_addr_base, ... of the unit
+// DIE, so that resolving a strx or addrx value is one indexed load.
+struct UnitInfo {
+  enum class UnitType : uint8_t {
+    DW_UT_compile = 0x01, // also every unit before DWARF 5
+    DW_UT_type = 0x02,
+    DW_UT_partial = 0x03,
+    DW_UT_skeleton = 0x04,
+    DW_UT_split_compile = 0x05,
+    DW_UT_split_type = 0x06,
+  };
+
+  uint32_t offset;       // DIE offset of the unit header, see DwarfSections::unitSection
+  uint32_t end;          // DIE offset one past the last byte of the unit
+  uint16_t version;
+  uint8_t addressSize;
+  uint32_t abbrevOffset; // for a unit of the supplementary file offset + DwarfSections::altAbbrevBase
+  uint32_t firstDIE;     // index of the unit DIE in the flat DIE array
+  uint32_t endDIE;       // one past the index of the last DIE of the unit
+  UnitType unitType;
+  uint8_t headerSize;    // the unit DIE starts at offset + headerSize
+  uint64_t signature;    // type signature of a type unit, DWO id of a skeleton or split unit
+  uint32_t typeOffset;   // type units: unit relative offset of the type DIE
+  uint32_t altBase;      // DwarfSections::altBase, DW_FORM_GNU_ref_alt values are rebased onto it
+  bool inAltFile;        // a unit of the supplementary file, its DW_FORM_strp and DW_FORM_ref_addr point into that file
+
+  std::span<uint8_t const> strOffsets;          // 4 byte .debug_str offsets, indexed by DW_FORM_strx
+  std::span<uint8_t const> addresses;           // addresses of addressSize bytes, indexed by DW_FORM_addrx
+  std::span<uint8_t const> rangeListOffsets;    // 4 byte offsets relative to rangeListsBase, indexed by DW_FORM_rnglistx
+  std::span<uint8_t const> locationListOffsets; // the same for DW_FORM_loclistx
+  uint32_t rangeListsBase;    // for a split DWARF 4 unit DW_AT_GNU_ranges_base, added to its .debug_ranges offsets
+  uint32_t locationListsBase;
+  uint64_t baseAddress;       // split units: DW_AT_low_pc of the skeleton, as their own unit DIE has none
+
+  inline bool isTypeUnit() const noexcept {
+    return (unitType == UnitType::DW_UT_type) || (unitType == UnitType::DW_UT_split_type);
+  }
+
+  // .debug_str offset of DW_FORM_strx index
+  inline uint64_t stringOffset(uint64_t const index) const {
+    return entry(strOffsets, index, 4U);
+  }
+
+  // DW_FORM_addrx, DW_OP_addrx and the x entries of range and location lists
+  inline uint64_t address(uint64_t const index) const {
+    return entry(addresses, index, addressSize);
+  }
+
+  // .debug_rnglists offset of DW_FORM_rnglistx index
+  inline uint64_t rangeList(uint64_t const index) const {
+    return rangeListsBase + entry(rangeListOffsets, index, 4U);
+  }
+
+  // .debug_loclists offset of DW_FORM_loclistx index
+  inline uint64_t locationList(uint64_t const index) const {
+    return locationListsBase + entry(locationListOffsets, index, 4U);
+  }
+
+private:
+  static uint64_t entry(std::span<uint8_t const> const table, uint64_t const index, uint32_t const entrySize) {
+    if (((entrySize != 4U) && (entrySize != 8U)) || (index >= (table.size() / entrySize))) {
+      throw std::runtime_error("index out of the indirection table");
+    }
+    if (entrySize == 4U) {
+      uint32_t value;
+      memcpy(&value, table.data() + (index * 4U), sizeof(value));
+      return value;
+    }
+    uint64_t value;
+    memcpy(&value, table.data() + (index * 8U), sizeof(value));
+    return value;
+  }
+};
+
+#endif
@@ -0,0 +1,119 @@
+#include "UnitRanges.hpp"
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include "ByteReader.hpp"
+#include "DebugInfo.hpp"
+#include "RangeList.hpp"
+
+UnitRanges UnitRanges::build(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections) {
+  std::vector<Interval> intervals;
+  std::vector<uint32_t> covered = readAranges(sections.debugAranges, intervals);
+  std::sort(covered.begin(), covered.end());
+
+  for (DIEIndex::UnitInfo const &unit : DebugInfo::readUnitHeaders(sections, debugAbbrevSections)) {
+    if (unit.isTypeUnit() || unit.inAltFile || std::binary_search(covered.begin(), covered.end(), unit.offset)) {
+      continue;
+    }
+    std::optional<FormValue> lowPc;
+    std::optional<FormValue> highPc;
+    std::optional<FormValue> ranges;
+    for (std::pair<DebugAbbrev::AttributeName, FormValue> const &attribute : DebugInfo::readUnitDIE(sections, unit, debugAbbrevSections.at(unit.abbrevOffset))) {
+      if (attribute.first == DebugAbbrev::AttributeName::DW_AT_low_pc) {
+        lowPc = attribute.second;
+      } else if (attribute.first == DebugAbbrev::AttributeName::DW_AT_high_pc) {
+        highPc = attribute.second;
+      } else if (attribute.first == DebugAbbrev::AttributeName::DW_AT_ranges) {
+        ranges = attribute.second;
+      }
+    }
+    if (ranges.has_value()) {
+      uint64_t const baseAddress = lowPc.has_value() ? lowPc->value : 0U;
+      for (RangeList::Range const &range : RangeList::read(sections, unit, ranges->value, baseAddress)) {
+        intervals.push_back(Interval{range.low, range.high, unit.offset});
+      }
+    } else if (lowPc.has_value() && highPc.has_value()) {
+      // since DWARF4 high_pc may be the size of the range
+      uint64_t const high = (highPc->form == DebugAbbrev::Form::DW_FORM_addr) ? highPc->value : (lowPc->value + highPc->value);
+      intervals.push_back(Interval{lowPc->value, high, unit.offset});
+    }
+  }
+
+  UnitRanges unitRanges;
+  unitRanges.normalize(std::move(intervals));
+  return unitRanges;
+}
+
+std::vector<uint32_t> UnitRanges::readAranges(std::span<uint8_t const> const debugAranges, std::vector<Interval> &intervals) {
+  std::vector<uint32_t> covered;
+  size_t setOffset = 0U;
+  while (setOffset < debugAranges.size()) {
+    ByteReader reader(debugAranges.data() + setOffset, debugAranges.size() - setOffset);
+    uint32_t const unitLength = reader.getNumber<uint32_t>();
+    if (unitLength >= 0xFFFF'FFF0U) {
+      throw std::runtime_error("64-bit DWARF is not supported");
+    }
+    if (unitLength > static_cast<size_t>(reader.end_ - reader.cursor_)) {
+      throw std::runtime_error("wrong .debug_aranges unit_length");
+    }
+    reader.end_ = reader.cursor_ + unitLength;
+    static_cast<void>(reader.getNumber<uint16_t>()); // version
+    uint32_t const unitOffset = reader.getNumber<uint32_t>();
+    uint8_t const addressSize = reader.getNumber<uint8_t>();
+    uint8_t const segmentSize = reader.getNumber<uint8_t>();
+    if (((addressSize != 4U) && (addressSize != 8U)) || (segmentSize != 0U)) {
+      throw std::runtime_error("unsupported .debug_aranges address size");
+    }
+    // the tuples are aligned to twice the address size, counted from the start of the set
+    size_t const tupleSize = 2U * addressSize;
+    reader.step((tupleSize - (static_cast<size_t>(reader.getOffset()) % tupleSize)) % tupleSize);
+
+    covered.push_back(unitOffset);
+    while (reader.cursor_ < reader.end_) {
+      uint64_t const address = (addressSize == 4U) ? reader.getNumber<uint32_t>() : reader.getNumber<uint64_t>();
+      uint64_t const length = (addressSize == 4U) ? reader.getNumber<uint32_t>() : reader.getNumber<uint64_t>();
+      if ((address == 0U) && (length == 0U)) {
+        break;
+      }
+      if (length != 0U) {
+        intervals.push_back(Interval{address, address + length, unitOffset});
+      }
+    }
+    setOffset += sizeof(uint32_t) + unitLength;
+  }
+  return covered;
+}
+
+void UnitRanges::normalize(std::vector<Interval> &&intervals) {
+  std::sort(intervals.begin(), intervals.end(), [](Interval const &lhs, Interval const &rhs) {
+    return (lhs.low != rhs.low) ? (lhs.low < rhs.low) : (lhs.high > rhs.high);
+  });
+  // overlapping ranges (e.g. code the linker folded) belong to the unit which claims them first
+  for (Interval interval : intervals) {
+    if (!intervals_.empty()) {
+      Interval &last = intervals_.back();
+      interval.low = std::max(interval.low, last.high);
+      if (interval.low >= interval.high) {
+        continue;
+      }
+      if ((interval.low == last.high) && (interval.unitOffset == last.unitOffset)) {
+        last.high = interval.high;
+        continue;
+      }
+    }
+    intervals_.push_back(interval);
+  }
+  lows_.reserve(intervals_.size());
+  for (Interval const &interval : intervals_) {
+    lows_.push_back(interval.low);
+  }
+}
+
+uint32_t UnitRanges::findUnit(uint64_t const address) const noexcept {
+  std::vector<uint64_t>::const_iterator const it = std::upper_bound(lows_.begin(), lows_.end(), address);
+  if (it == lows_.begin()) {
+    return noUnit;
+  }
+  Interval const &interval = intervals_[static_cast<size_t>(it - lows_.begin()) - 1U];
+  return (address < interval.high) ? interval.unitOffset : noUnit;
+}
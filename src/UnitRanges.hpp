@@ -0,0 +1,43 @@
+#ifndef UNIT_RANGES_HPP
+#define UNIT_RANGES_HPP
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include "DebugAbbrev.hpp"
+#include "DwarfSections.hpp"
+
+// Sorted, non-overlapping address intervals, each owned by one unit, so that the unit of an address is one binary
+// search. The intervals come from .debug_aranges. Units without an address range table, or all units if the section
+// is missing, contribute the DW_AT_low_pc/DW_AT_high_pc or DW_AT_ranges of their unit DIE, which is the only DIE of
+// the unit that gets decoded.
+class UnitRanges {
+public:
+  struct Interval {
+    uint64_t low;
+    uint64_t high; // one past the last address
+    uint32_t unitOffset;
+  };
+
+  static uint32_t constexpr noUnit = UINT32_MAX;
+
+  static UnitRanges build(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections);
+
+  // Section offset of the unit whose code contains address, noUnit if there is none
+  uint32_t findUnit(uint64_t const address) const noexcept;
+
+  inline std::vector<Interval> const &intervals() const noexcept {
+    return intervals_;
+  }
+
+private:
+  // Reads every address range table, returns the offsets of the units they cover
+  static std::vector<uint32_t> readAranges(std::span<uint8_t const> const debugAranges, std::vector<Interval> &intervals);
+  void normalize(std::vector<Interval> &&intervals);
+
+  std::vector<uint64_t> lows_; // kept apart from intervals_ so that the search only touches the keys
+  std::vector<Interval> intervals_;
+};
+
+#endif
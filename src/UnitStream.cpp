@@ -0,0 +1,81 @@
+#include "UnitStream.hpp"
+#include <algorithm>
+#include <initializer_list>
+#include <utility>
+
+UnitStream::UnitStream(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections, size_t const memoryBudget,
+                       MappedFile const *const file, std::vector<std::span<uint8_t const>> otherSections)
+    : sections_(sections), debugAbbrevSections_(debugAbbrevSections), memoryBudget_(memoryBudget), file_(file), otherSections_(std::move(otherSections)),
+      strings_(sections.debugStr), units_(DebugInfo::readUnitHeaders(sections, debugAbbrevSections)), duplicate_(units_.size(), false) {
+  for (std::span<uint8_t const> const section : {sections.debugStrOffsets, sections.debugAddr, sections.debugLine, sections.debugRanges, sections.debugRnglists,
+                                                 sections.debugLoc, sections.debugLoclists, sections.debugAranges}) {
+    if (!section.empty()) {
+      otherSections_.push_back(section);
+    }
+  }
+  // reading the headers touched a page of every unit, and the abbreviation tables have been parsed
+  if (file_ != nullptr) {
+    file_->release(sections.debugInfo);
+    file_->release(sections.debugTypes);
+    releaseOtherSections();
+  }
+  // signatures are registered up front, so that DW_FORM_ref_sig8 resolves to type units of later batches as well
+  for (size_t i = 0U; i < units_.size(); i++) {
+    if (units_[i].isTypeUnit()) {
+      duplicate_[i] = !typeSignatures_.emplace(units_[i].signature, units_[i].offset + units_[i].typeOffset).second;
+    }
+  }
+}
+
+size_t UnitStream::batchEnd(size_t const first, size_t const bytesPerUnitByte) const noexcept {
+  // a decoded unit costs its DIEs and its pages of the mapping, both are freed after the batch
+  size_t bytes = 0U;
+  size_t end = first;
+  while (end < units_.size()) {
+    bytes += static_cast<size_t>(unitBytes(units_[end])) * bytesPerUnitByte;
+    if ((end > first) && (bytes > memoryBudget_)) {
+      break;
+    }
+    end++;
+  }
+  return end;
+}
+
+void UnitStream::learnExpansion(size_t const first, size_t const end, size_t const decodedBytes) noexcept {
+  peakDecodedBytes_ = std::max(peakDecodedBytes_, decodedBytes);
+  size_t batchBytes = 0U;
+  for (size_t i = first; i < end; i++) {
+    batchBytes += unitBytes(units_[i]);
+  }
+  if (batchBytes > 0U) {
+    size_t const observed = std::max<size_t>(1U, (decodedBytes + batchBytes - 1U) / batchBytes);
+    expansion_ = measured_ ? std::max(expansion_, observed) : observed;
+    measured_ = true;
+  }
+}
+
+void UnitStream::releaseBatch(size_t const first, size_t const end) {
+  batches_++;
+  if (file_ == nullptr) {
+    return;
+  }
+  // consecutive units of one section are released as one range, so that pages they share go as well
+  for (size_t i = first; i < end;) {
+    DwarfSections::UnitSection const section = sections_.unitSection(units_[i].offset);
+    size_t last = i;
+    while (((last + 1U) < end) && (sections_.unitSection(units_[last + 1U].offset).base == section.base)) {
+      last++;
+    }
+    size_t const begin = units_[i].offset - section.base;
+    file_->release(section.data.subspan(begin, units_[last].end - section.base - begin));
+    i = last + 1U;
+  }
+  // the next batch loads again what it reads of them
+  releaseOtherSections();
+}
+
+void UnitStream::releaseOtherSections() const noexcept {
+  for (std::span<uint8_t const> const section : otherSections_) {
+    file_->release(section);
+  }
+}
@@ -0,0 +1,120 @@
+#ifndef UNIT_STREAM_HPP
+#define UNIT_STREAM_HPP
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "DIEIndex.hpp"
+#include "DebugAbbrev.hpp"
+#include "DebugInfo.hpp"
+#include "DwarfSections.hpp"
+#include "MappedFile.hpp"
+#include "Parallel.hpp"
+#include "StringPool.hpp"
+
+// Hands the DIEs of one unit after the other to a visitor without ever holding all of them, for analyses which look at
+// a unit at a time. Units are decoded in parallel, in batches whose decoded DIEs fit into the memory budget; after a
+// batch has been visited its DIEs are freed and the pages of its units, and those of the other sections the batch read
+// such as .debug_str and .debug_line, are given back to the kernel. What lives for the whole run is small against the
+// DIEs: the unit headers, the abbreviation tables, the type signatures and one StringPool, so that string handles of
+// different batches compare.
+// The budget is a target, not a hard limit: a unit which alone exceeds it is decoded on its own. DIE references may
+// point into units which are gone already, so analyses which follow them across units, like TypeDedup, need the
+// DIEIndex instead. One pass analyses which need no DIE after it has been seen walk the units instead of decoding them,
+// then only the pages of the mapping count against the budget.
+class UnitStream {
+public:
+  // file is the mapping the sections point into, nullptr if their pages are not to be released. otherSections are
+  // sections of the file which DwarfSections has no size for, like .debug_str and .debug_abbrev, released likewise.
+  UnitStream(DwarfSections const &sections, std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections, size_t const memoryBudget,
+             MappedFile const *const file, std::vector<std::span<uint8_t const>> otherSections = {});
+
+  // Calls visitor(unit, dies, strings) for every unit in section order, type units repeating a signature left out.
+  // dies are the DIEs decodeUnit returns and are only valid during the call; names are handles into strings, which is
+  // the same pool for every unit of the run.
+  template <typename Visitor>
+  void forEach(Visitor &&visitor) {
+    for (size_t first = 0U; first < units_.size();) {
+      size_t const end = batchEnd(first, expansion_ + 1U);
+      std::vector<std::vector<DIEIndex::DIEInfo>> decoded(end - first);
+      Parallel::forEach(end - first, [&](size_t const task, size_t) {
+        UnitInfo const &unit = units_[first + task];
+        if (!duplicate_[first + task]) {
+          decoded[task] = DebugInfo::decodeUnit(sections_, unit, debugAbbrevSections_.at(unit.abbrevOffset), typeSignatures_, strings_);
+        }
+      });
+      size_t decodedBytes = 0U;
+      for (size_t i = first; i < end; i++) {
+        decodedBytes += decoded[i - first].capacity() * sizeof(DIEIndex::DIEInfo);
+        if (!duplicate_[i]) {
+          visitor(std::as_const(units_[i]), std::span<DIEIndex::DIEInfo const>(decoded[i - first]), std::as_const(strings_));
+        }
+      }
+      learnExpansion(first, end, decodedBytes);
+      releaseBatch(first, end);
+      first = end;
+    }
+  }
+
+  // Calls DebugInfo::walkUnit(..., visitor) for every unit in section order, type units repeating a signature left out.
+  // The units are walked one after the other on the calling thread, so the events of a unit never interleave with
+  // those of another.
+  template <typename Visitor>
+  void walk(Visitor &visitor) {
+    for (size_t first = 0U; first < units_.size();) {
+      size_t const end = batchEnd(first, 1U);
+      for (size_t i = first; i < end; i++) {
+        if (!duplicate_[i]) {
+          DebugInfo::walkUnit(sections_, units_[i], debugAbbrevSections_.at(units_[i].abbrevOffset), visitor);
+        }
+      }
+      releaseBatch(first, end);
+      first = end;
+    }
+  }
+
+  inline std::vector<UnitInfo> const &units() const noexcept {
+    return units_;
+  }
+
+  inline size_t batches() const noexcept {
+    return batches_;
+  }
+
+  // Most bytes of DIEs decoded at once
+  inline size_t peakDecodedBytes() const noexcept {
+    return peakDecodedBytes_;
+  }
+
+private:
+  // One past the last unit of the batch starting at first, if a unit costs bytesPerUnitByte for each of its bytes
+  size_t batchEnd(size_t const first, size_t const bytesPerUnitByte) const noexcept;
+  void learnExpansion(size_t const first, size_t const end, size_t const decodedBytes) noexcept;
+  // Counts a finished batch and gives the pages of its units and of the other sections back to the kernel
+  void releaseBatch(size_t const first, size_t const end);
+  void releaseOtherSections() const noexcept;
+
+  inline static uint32_t unitBytes(UnitInfo const &unit) noexcept {
+    return unit.end - unit.offset;
+  }
+
+  DwarfSections const &sections_;
+  std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const &debugAbbrevSections_;
+  size_t memoryBudget_;
+  MappedFile const *file_;
+  std::vector<std::span<uint8_t const>> otherSections_; // the sized sections of sections_ and the ones given
+  StringPool strings_;
+  std::vector<UnitInfo> units_;
+  std::vector<bool> duplicate_; // type units whose signature an earlier one has
+  DIEIndex::TypeSignatures typeSignatures_;
+  // Decoded bytes per byte of unit, the most seen so far. The guess for the first batch is on the safe side, DIEs of a
+  // few bytes each become entries of sizeof(DIEInfo).
+  size_t expansion_ = 8U;
+  bool measured_ = false;
+  size_t batches_ = 0U;
+  size_t peakDecodedBytes_ = 0U;
+};
+
+#endif
@@ -1,52 +1,168 @@
 #include "VariableLocation.hpp"
-#include <iostream>
+#include <ostream>
 #include "ByteReader.hpp"
 
-void VariableLocation::handleVariableLocation(std::span<const uint8_t> const dataRepresentation) {
+void VariableLocation::handleVariableLocation(std::ostream &out, std::span<const uint8_t> const dataRepresentation, UnitInfo const &unit) {
   ByteReader dataRepresentationReader(dataRepresentation.data(), dataRepresentation.size());
   while (!dataRepresentationReader.reachedEnd()) {
-    handleVariableLocation(dataRepresentationReader);
+    handleVariableLocation(out, dataRepresentationReader, unit);
   }
 }
 
-void VariableLocation::handleBasicOpCode(DwarfExpressionOpcode const opCode, ByteReader &byteCodeReader) {
+void VariableLocation::handleBasicOpCode(std::ostream &out, DwarfExpressionOpcode const opCode, ByteReader &byteCodeReader, UnitInfo const &unit) {
+  uint32_t const code = static_cast<uint32_t>(opCode);
   if (opCode == DwarfExpressionOpcode::DW_OP_fbreg) {
     int64_t const opNum = static_cast<int64_t>(byteCodeReader.readLEB128(true));
-    std::cout << "(" << dwarfExpressionOpcodeToString(opCode) << " " << opNum << ")";
-  } else if (static_cast<uint32_t>(opCode) >= static_cast<uint32_t>(DwarfExpressionOpcode::DW_OP_reg0) && static_cast<uint32_t>(opCode) <= static_cast<uint32_t>(DwarfExpressionOpcode::DW_OP_reg31)) {
-    uint64_t const regIndex = static_cast<uint32_t>(opCode) - static_cast<uint32_t>(DwarfExpressionOpcode::DW_OP_reg0);
+    out << "(" << dwarfExpressionOpcodeToString(opCode) << " " << opNum << ")";
+  } else if (code >= static_cast<uint32_t>(DwarfExpressionOpcode::DW_OP_reg0) && code <= static_cast<uint32_t>(DwarfExpressionOpcode::DW_OP_reg31)) {
+    uint64_t const regIndex = code - static_cast<uint32_t>(DwarfExpressionOpcode::DW_OP_reg0);
 
-    std::cout << "reg " << regIndex << std::endl;
+    out << "reg " << regIndex << "\n";
   } else if (opCode == DwarfExpressionOpcode::DW_OP_regx) {
     // DW_OP_regx has one operand: register number (unsigned LEB128)
     uint64_t const regIndex = byteCodeReader.readLEB128(false);
-    std::cout << "(" << dwarfExpressionOpcodeToString(opCode) << " " << regIndex << ") ";
-  } else if (opCode == DwarfExpressionOpcode::DW_OP_GNU_entry_value) {
-    std::cout << "(" << dwarfExpressionOpcodeToString(opCode) << ") ";
+    out << "(" << dwarfExpressionOpcodeToString(opCode) << " " << regIndex << ") ";
+  } else if ((opCode == DwarfExpressionOpcode::DW_OP_entry_value) || (opCode == DwarfExpressionOpcode::DW_OP_GNU_entry_value)) {
+    out << "(" << dwarfExpressionOpcodeToString(opCode) << ") ";
     uint64_t const size = byteCodeReader.readLEB128(false);
-    handleVariableLocation(std::span<const uint8_t>(byteCodeReader.cursor_, size));
-    byteCodeReader.step(size);
-  }
-
-  else {
-    throw std::runtime_error("not implemented yet");
+    if (size > static_cast<uint64_t>(byteCodeReader.end_ - byteCodeReader.cursor_)) {
+      throw std::runtime_error("over flow");
+    }
+    handleVariableLocation(out, std::span<const uint8_t>(byteCodeReader.cursor_, static_cast<size_t>(size)), unit);
+    byteCodeReader.step(static_cast<size_t>(size));
+  } else if (code >= static_cast<uint32_t>(DwarfExpressionOpcode::DW_OP_lit0) && code <= static_cast<uint32_t>(DwarfExpressionOpcode::DW_OP_lit31)) {
+    out << "(DW_OP_lit" << (code - static_cast<uint32_t>(DwarfExpressionOpcode::DW_OP_lit0)) << ") ";
+  } else if (code >= static_cast<uint32_t>(DwarfExpressionOpcode::DW_OP_breg0) && code <= static_cast<uint32_t>(DwarfExpressionOpcode::DW_OP_breg31)) {
+    int64_t const offset = static_cast<int64_t>(byteCodeReader.readLEB128(true));
+    out << "(DW_OP_breg" << (code - static_cast<uint32_t>(DwarfExpressionOpcode::DW_OP_breg0)) << " " << offset << ") ";
+  } else {
+    // the name throws for an unknown opcode, whose operands could not be skipped anyway
+    out << "(" << dwarfExpressionOpcodeToString(opCode);
+    switch (opCode) {
+    case (DwarfExpressionOpcode::DW_OP_addr): {
+      uint64_t const address = (unit.addressSize == 4U) ? byteCodeReader.getNumber<uint32_t>() : byteCodeReader.getNumber<uint64_t>();
+      out << " 0x" << std::hex << address << std::dec;
+      break;
+    }
+    case (DwarfExpressionOpcode::DW_OP_addrx):
+    case (DwarfExpressionOpcode::DW_OP_constx): {
+      // both index the address table of the unit, constx for values like TLS offsets which are not relocated
+      uint64_t const index = byteCodeReader.readLEB128(false);
+      out << " " << index;
+      if (!unit.addresses.empty()) {
+        out << " (0x" << std::hex << unit.address(index) << std::dec << ")";
+      }
+      break;
+    }
+    case (DwarfExpressionOpcode::DW_OP_const1u):
+    case (DwarfExpressionOpcode::DW_OP_pick):
+    case (DwarfExpressionOpcode::DW_OP_deref_size):
+    case (DwarfExpressionOpcode::DW_OP_xderef_size): {
+      out << " " << static_cast<uint32_t>(byteCodeReader.getNumber<uint8_t>());
+      break;
+    }
+    case (DwarfExpressionOpcode::DW_OP_const1s): {
+      out << " " << static_cast<int32_t>(byteCodeReader.getNumber<int8_t>());
+      break;
+    }
+    case (DwarfExpressionOpcode::DW_OP_const2u):
+    case (DwarfExpressionOpcode::DW_OP_call2): {
+      out << " " << byteCodeReader.getNumber<uint16_t>();
+      break;
+    }
+    case (DwarfExpressionOpcode::DW_OP_const2s):
+    case (DwarfExpressionOpcode::DW_OP_skip):
+    case (DwarfExpressionOpcode::DW_OP_bra): {
+      out << " " << byteCodeReader.getNumber<int16_t>();
+      break;
+    }
+    case (DwarfExpressionOpcode::DW_OP_const4u):
+    case (DwarfExpressionOpcode::DW_OP_call4):
+    case (DwarfExpressionOpcode::DW_OP_call_ref):
+    case (DwarfExpressionOpcode::DW_OP_GNU_parameter_ref): {
+      out << " " << byteCodeReader.getNumber<uint32_t>();
+      break;
+    }
+    case (DwarfExpressionOpcode::DW_OP_const4s): {
+      out << " " << byteCodeReader.getNumber<int32_t>();
+      break;
+    }
+    case (DwarfExpressionOpcode::DW_OP_const8u): {
+      out << " " << byteCodeReader.getNumber<uint64_t>();
+      break;
+    }
+    case (DwarfExpressionOpcode::DW_OP_const8s): {
+      out << " " << byteCodeReader.getNumber<int64_t>();
+      break;
+    }
+    case (DwarfExpressionOpcode::DW_OP_constu):
+    case (DwarfExpressionOpcode::DW_OP_plus_uconst):
+    case (DwarfExpressionOpcode::DW_OP_piece):
+    case (DwarfExpressionOpcode::DW_OP_convert):
+    case (DwarfExpressionOpcode::DW_OP_reinterpret):
+    case (DwarfExpressionOpcode::DW_OP_GNU_convert):
+    case (DwarfExpressionOpcode::DW_OP_GNU_reinterpret): {
+      out << " " << byteCodeReader.readLEB128(false);
+      break;
+    }
+    case (DwarfExpressionOpcode::DW_OP_consts): {
+      out << " " << static_cast<int64_t>(byteCodeReader.readLEB128(true));
+      break;
+    }
+    case (DwarfExpressionOpcode::DW_OP_bregx): {
+      uint64_t const regIndex = byteCodeReader.readLEB128(false);
+      out << " " << regIndex << " " << static_cast<int64_t>(byteCodeReader.readLEB128(true));
+      break;
+    }
+    case (DwarfExpressionOpcode::DW_OP_bit_piece):
+    case (DwarfExpressionOpcode::DW_OP_regval_type):
+    case (DwarfExpressionOpcode::DW_OP_GNU_regval_type): {
+      uint64_t const first = byteCodeReader.readLEB128(false);
+      out << " " << first << " " << byteCodeReader.readLEB128(false);
+      break;
+    }
+    case (DwarfExpressionOpcode::DW_OP_deref_type):
+    case (DwarfExpressionOpcode::DW_OP_xderef_type):
+    case (DwarfExpressionOpcode::DW_OP_GNU_deref_type): {
+      uint32_t const size = byteCodeReader.getNumber<uint8_t>();
+      out << " " << size << " " << byteCodeReader.readLEB128(false);
+      break;
+    }
+    case (DwarfExpressionOpcode::DW_OP_implicit_pointer):
+    case (DwarfExpressionOpcode::DW_OP_GNU_implicit_pointer): {
+      uint32_t const dieOffset = byteCodeReader.getNumber<uint32_t>();
+      out << " 0x" << std::hex << dieOffset << std::dec << " " << static_cast<int64_t>(byteCodeReader.readLEB128(true));
+      break;
+    }
+    case (DwarfExpressionOpcode::DW_OP_implicit_value):
+    case (DwarfExpressionOpcode::DW_OP_const_type):
+    case (DwarfExpressionOpcode::DW_OP_GNU_const_type): {
+      if (opCode != DwarfExpressionOpcode::DW_OP_implicit_value) {
+        out << " " << byteCodeReader.readLEB128(false); // base type DIE
+      }
+      uint64_t const size = (opCode == DwarfExpressionOpcode::DW_OP_implicit_value) ? byteCodeReader.readLEB128(false) : byteCodeReader.getNumber<uint8_t>();
+      if (size > static_cast<uint64_t>(byteCodeReader.end_ - byteCodeReader.cursor_)) {
+        throw std::runtime_error("over flow");
+      }
+      out << " " << size << std::hex;
+      for (uint64_t i = 0U; i < size; i++) {
+        out << " 0x" << static_cast<uint32_t>(byteCodeReader.getNumber<uint8_t>());
+      }
+      out << std::dec;
+      break;
+    }
+    default: {
+      // the remaining opcodes have no operands
+      break;
+    }
+    }
+    out << ") ";
   }
 }
 
-void VariableLocation::handleVariableLocation(ByteReader &byteCodeReader) {
+void VariableLocation::handleVariableLocation(std::ostream &out, ByteReader &byteCodeReader, UnitInfo const &unit) {
   DwarfExpressionOpcode const opCode = static_cast<DwarfExpressionOpcode>(byteCodeReader.getNumber<uint8_t>());
-
-  if (opCode == DwarfExpressionOpcode::DW_OP_GNU_entry_value) {
-    std::cout << "(" << dwarfExpressionOpcodeToString(opCode) << ") ";
-
-    uint64_t const size = byteCodeReader.readLEB128(false);
-    DwarfExpressionOpcode const subOpcode = static_cast<DwarfExpressionOpcode>(byteCodeReader.getNumber<uint8_t>());
-    handleBasicOpCode(subOpcode, byteCodeReader);
-    byteCodeReader.step(size);
-
-  } else {
-    handleBasicOpCode(opCode, byteCodeReader);
-  }
+  handleBasicOpCode(out, opCode, byteCodeReader, unit);
 }
 
 std::string const VariableLocation::dwarfExpressionOpcodeToString(DwarfExpressionOpcode const opCode) {
@@ -214,9 +330,105 @@ std::string const VariableLocation::dwarfExpressionOpcodeToString(DwarfExpressio
   case (DwarfExpressionOpcode::DW_OP_bregx): {
     return "DW_OP_bregx";
   }
+  case (DwarfExpressionOpcode::DW_OP_piece): {
+    return "DW_OP_piece";
+  }
+  case (DwarfExpressionOpcode::DW_OP_deref_size): {
+    return "DW_OP_deref_size";
+  }
+  case (DwarfExpressionOpcode::DW_OP_xderef_size): {
+    return "DW_OP_xderef_size";
+  }
+  case (DwarfExpressionOpcode::DW_OP_nop): {
+    return "DW_OP_nop";
+  }
+  case (DwarfExpressionOpcode::DW_OP_push_object_address): {
+    return "DW_OP_push_object_address";
+  }
+  case (DwarfExpressionOpcode::DW_OP_call2): {
+    return "DW_OP_call2";
+  }
+  case (DwarfExpressionOpcode::DW_OP_call4): {
+    return "DW_OP_call4";
+  }
+  case (DwarfExpressionOpcode::DW_OP_call_ref): {
+    return "DW_OP_call_ref";
+  }
+  case (DwarfExpressionOpcode::DW_OP_form_tls_address): {
+    return "DW_OP_form_tls_address";
+  }
+  case (DwarfExpressionOpcode::DW_OP_call_frame_cfa): {
+    return "DW_OP_call_frame_cfa";
+  }
+  case (DwarfExpressionOpcode::DW_OP_bit_piece): {
+    return "DW_OP_bit_piece";
+  }
+  case (DwarfExpressionOpcode::DW_OP_implicit_value): {
+    return "DW_OP_implicit_value";
+  }
+  case (DwarfExpressionOpcode::DW_OP_stack_value): {
+    return "DW_OP_stack_value";
+  }
+  case (DwarfExpressionOpcode::DW_OP_implicit_pointer): {
+    return "DW_OP_implicit_pointer";
+  }
+  case (DwarfExpressionOpcode::DW_OP_addrx): {
+    return "DW_OP_addrx";
+  }
+  case (DwarfExpressionOpcode::DW_OP_constx): {
+    return "DW_OP_constx";
+  }
+  case (DwarfExpressionOpcode::DW_OP_entry_value): {
+    return "DW_OP_entry_value";
+  }
+  case (DwarfExpressionOpcode::DW_OP_const_type): {
+    return "DW_OP_const_type";
+  }
+  case (DwarfExpressionOpcode::DW_OP_regval_type): {
+    return "DW_OP_regval_type";
+  }
+  case (DwarfExpressionOpcode::DW_OP_deref_type): {
+    return "DW_OP_deref_type";
+  }
+  case (DwarfExpressionOpcode::DW_OP_xderef_type): {
+    return "DW_OP_xderef_type";
+  }
+  case (DwarfExpressionOpcode::DW_OP_convert): {
+    return "DW_OP_convert";
+  }
+  case (DwarfExpressionOpcode::DW_OP_reinterpret): {
+    return "DW_OP_reinterpret";
+  }
+  case (DwarfExpressionOpcode::DW_OP_GNU_push_tls_address): {
+    return "DW_OP_GNU_push_tls_address";
+  }
+  case (DwarfExpressionOpcode::DW_OP_GNU_uninit): {
+    return "DW_OP_GNU_uninit";
+  }
+  case (DwarfExpressionOpcode::DW_OP_GNU_implicit_pointer): {
+    return "DW_OP_GNU_implicit_pointer";
+  }
   case (DwarfExpressionOpcode::DW_OP_GNU_entry_value): {
     return "DW_OP_GNU_entry_value";
   }
+  case (DwarfExpressionOpcode::DW_OP_GNU_const_type): {
+    return "DW_OP_GNU_const_type";
+  }
+  case (DwarfExpressionOpcode::DW_OP_GNU_regval_type): {
+    return "DW_OP_GNU_regval_type";
+  }
+  case (DwarfExpressionOpcode::DW_OP_GNU_deref_type): {
+    return "DW_OP_GNU_deref_type";
+  }
+  case (DwarfExpressionOpcode::DW_OP_GNU_convert): {
+    return "DW_OP_GNU_convert";
+  }
+  case (DwarfExpressionOpcode::DW_OP_GNU_reinterpret): {
+    return "DW_OP_GNU_reinterpret";
+  }
+  case (DwarfExpressionOpcode::DW_OP_GNU_parameter_ref): {
+    return "DW_OP_GNU_parameter_ref";
+  }
 
   default: {
     throw std::runtime_error("No implemented yet");
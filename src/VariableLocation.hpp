@@ -2,13 +2,17 @@
 #define VARIABLE_LOCATION_HPP
 
 #include <cstdint>
+#include <ostream>
 #include <span>
 #include <string>
 #include "ByteReader.hpp"
+#include "UnitInfo.hpp"
 class VariableLocation {
 public:
-  static void handleVariableLocation(std::span<const uint8_t> const dataRepresentation);
-  static void handleVariableLocation(ByteReader &byteCodeReader);
+  // Prints the expression to out; unit gives the operand size of DW_OP_addr and the address table of DW_OP_addrx and
+  // DW_OP_constx
+  static void handleVariableLocation(std::ostream &out, std::span<const uint8_t> const dataRepresentation, UnitInfo const &unit);
+  static void handleVariableLocation(std::ostream &out, ByteReader &byteCodeReader, UnitInfo const &unit);
 
 private:
   enum class DwarfExpressionOpcode : uint8_t {
@@ -66,10 +70,42 @@ private:
     DW_OP_regx = 0x90,
     DW_OP_fbreg = 0x91,
     DW_OP_bregx = 0x92,
-    DW_OP_GNU_entry_value = 0xf3
+    DW_OP_piece = 0x93,
+    DW_OP_deref_size = 0x94,
+    DW_OP_xderef_size = 0x95,
+    DW_OP_nop = 0x96,
+    DW_OP_push_object_address = 0x97,
+    DW_OP_call2 = 0x98,
+    DW_OP_call4 = 0x99,
+    DW_OP_call_ref = 0x9a,
+    DW_OP_form_tls_address = 0x9b,
+    DW_OP_call_frame_cfa = 0x9c,
+    DW_OP_bit_piece = 0x9d,
+    DW_OP_implicit_value = 0x9e,
+    DW_OP_stack_value = 0x9f,
+    DW_OP_implicit_pointer = 0xa0,
+    DW_OP_addrx = 0xa1,
+    DW_OP_constx = 0xa2,
+    DW_OP_entry_value = 0xa3,
+    DW_OP_const_type = 0xa4,
+    DW_OP_regval_type = 0xa5,
+    DW_OP_deref_type = 0xa6,
+    DW_OP_xderef_type = 0xa7,
+    DW_OP_convert = 0xa8,
+    DW_OP_reinterpret = 0xa9,
+    DW_OP_GNU_push_tls_address = 0xe0,
+    DW_OP_GNU_uninit = 0xf0,
+    DW_OP_GNU_implicit_pointer = 0xf2,
+    DW_OP_GNU_entry_value = 0xf3,
+    DW_OP_GNU_const_type = 0xf4,
+    DW_OP_GNU_regval_type = 0xf5,
+    DW_OP_GNU_deref_type = 0xf6,
+    DW_OP_GNU_convert = 0xf7,
+    DW_OP_GNU_reinterpret = 0xf9,
+    DW_OP_GNU_parameter_ref = 0xfa
   };
 
   static std::string const dwarfExpressionOpcodeToString(DwarfExpressionOpcode const opCode);
-  static void handleBasicOpCode(DwarfExpressionOpcode const opCode, ByteReader &byteCodeReader);
+  static void handleBasicOpCode(std::ostream &out, DwarfExpressionOpcode const opCode, ByteReader &byteCodeReader, UnitInfo const &unit);
 };
 #endif
\ No newline at end of file
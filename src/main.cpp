@@ -1,49 +1,59 @@
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <iomanip>
 #include <ios>
 #include <iostream>
-#include <iterator>
 #include <map>
+#include <optional>
+#include <span>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/resource.h>
 #include <sys/types.h>
 #include <type_traits>
+#include <utility>
+#include <unistd.h>
 #include <unordered_map>
 #include <vector>
+#include "AcceleratorTables.hpp"
+#include "Addr2Line.hpp"
+#include "BufferedWriter.hpp"
 #include "ByteReader.hpp"
+#include "DIEFilter.hpp"
+#include "DIEStatistics.hpp"
 #include "DebugAbbrev.hpp"
 #include "DebugInfo.hpp"
 #include "DebugLine.hpp"
 #include "DebugLoc.hpp"
+#include "ElfWriter.hpp"
+#include "IndexWriter.hpp"
+#include "MappedFile.hpp"
+#include "NameIndex.hpp"
+#include "StructLayout.hpp"
+#include "SubstringIndex.hpp"
+#include "SymbolTable.hpp"
+#include "SupplementaryFile.hpp"
+#include "Symbolizer.hpp"
+#include "TypeDedup.hpp"
+#include "UnitCache.hpp"
+#include "UnitStream.hpp"
 #include "elf.h"
 
 std::unordered_map<uint32_t, uint32_t> debugLineTextMap; // key is section index of debug line, value is section index of text
 
-std::vector<uint8_t> readFile(const char *const filename) {
-  // open the file:
-  std::ifstream file(filename, std::ios::binary);
-
-  // Stop eating new lines in binary mode!!!
-  file.unsetf(std::ios::skipws);
-
-  // get its size:
-  std::streampos fileSize;
-
-  file.seekg(0, std::ios::end);
-  fileSize = file.tellg();
-  file.seekg(0, std::ios::beg);
-
-  // reserve capacity
-  std::vector<uint8_t> vec;
-  vec.reserve(static_cast<size_t>(fileSize));
-
-  // read the data:
-  vec.insert(vec.begin(), std::istream_iterator<uint8_t>(file), std::istream_iterator<uint8_t>());
-
-  return vec;
+void writeFile(std::string const &filename, std::span<uint8_t const> const data) {
+  std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<char const *>(data.data()), static_cast<std::streamsize>(data.size()));
+  if (!file) {
+    throw std::runtime_error("can not write " + filename);
+  }
 }
 
 std::array<char, 12> constexpr debugLineName = {".debug_line"};
@@ -51,18 +61,193 @@ std::array<char, 12> constexpr debugInfoName = {".debug_info"};
 std::array<char, 14> constexpr debugAbbrevName = {".debug_abbrev"};
 std::array<char, 11> constexpr debugStrName = {".debug_str"};
 std::array<char, 11> constexpr debugLocName = {".debug_loc"};
+std::array<char, 13> constexpr debugNamesName = {".debug_names"};
+std::array<char, 11> constexpr gdbIndexName = {".gdb_index"};
+std::array<char, 16> constexpr debugPubnamesName = {".debug_pubnames"};
+std::array<char, 16> constexpr debugPubtypesName = {".debug_pubtypes"};
+std::array<char, 15> constexpr debugArangesName = {".debug_aranges"};
+std::array<char, 14> constexpr debugRangesName = {".debug_ranges"};
+std::array<char, 16> constexpr debugLineStrName = {".debug_line_str"};
+std::array<char, 19> constexpr debugStrOffsetsName = {".debug_str_offsets"};
+std::array<char, 12> constexpr debugAddrName = {".debug_addr"};
+std::array<char, 16> constexpr debugRnglistsName = {".debug_rnglists"};
+std::array<char, 16> constexpr debugLoclistsName = {".debug_loclists"};
+std::array<char, 13> constexpr debugTypesName = {".debug_types"};
+std::array<char, 18> constexpr gnuDebugAltLinkName = {".gnu_debugaltlink"};
+std::array<char, 11> constexpr debugSupName = {".debug_sup"};
+
+struct Options {
+  char const *lookupName = nullptr;    // --lookup <name>: print the definitions of name instead of dumping
+  char const *searchText = nullptr;    // --search <text>: print every DIE whose name contains text
+  bool searchPrefix = false;           // --prefix: with --search, names starting with text only
+  char const *functionText = nullptr;  // --find-functions <text>: functions whose name contains text, without building an index
+  bool layout = false;                 // --layout: pahole like layout of every struct, class and union
+  char const *layoutJsonPath = nullptr; // --layout-json <file>: the same layouts as JSON
+  bool dedupTypes = false;             // --dedup-types: count the types repeated across units
+  char const *cachePath = nullptr;     // --cache <file>: with --layout or --search, reuse what the last run found for the unchanged units
+  bool stats = false;                  // --stats: counts over all DIEs, streamed unit by unit
+  size_t memoryBudget = size_t{512U} << 20U; // --memory-budget <MiB>: with --stats, for the units mapped at once
+  char const *writeIndexPath = nullptr; // --write-index <file>: copy of the input with accelerator tables added
+  char const *writeSectionsPrefix = nullptr; // --write-sections <prefix>: the new sections as raw files <prefix>.debug_names ...
+  bool gdbIndex = false;                // --gdb-index: also build .gdb_index
+  std::vector<uint64_t> addresses;      // --address <hex>: print the source location of a code address
+  bool addr2line = false;               // --addr2line [addr2line options]: behave like binutils addr2line
+  Addr2Line::Options addr2lineOptions;
+  std::string debugDirectory = "/usr/lib/debug"; // --debug-dir <dir>: where .build-id/ locates the dwz supplementary file
+};
+
+// Options in the syntax of binutils addr2line, flags may be combined as in -fiCe <file>. Returns false for unknown ones.
+bool parseAddr2LineOptions(int const argc, char *argv[], char const *&path, Options &options) {
+  for (int i = 2; i < argc; i++) {
+    std::string_view const argument(argv[i]);
+    if (argument == "--addresses") {
+      options.addr2lineOptions.addresses = true;
+    } else if (argument == "--functions") {
+      options.addr2lineOptions.functions = true;
+    } else if (argument == "--inlines") {
+      options.addr2lineOptions.inlines = true;
+    } else if (argument == "--demangle") {
+      options.addr2lineOptions.demangle = true;
+    } else if (argument == "--basenames") {
+      options.addr2lineOptions.basenames = true;
+    } else if (argument == "--pretty-print") {
+      options.addr2lineOptions.pretty = true;
+    } else if (argument.starts_with("--exe=")) {
+      path = argv[i] + 6;
+    } else if (argument.starts_with("--debug-dir=")) {
+      options.debugDirectory = argv[i] + 12;
+    } else if ((argument.size() > 1U) && (argument[0] == '-')) {
+      for (size_t j = 1U; j < argument.size(); j++) {
+        switch (argument[j]) {
+        case ('a'): {
+          options.addr2lineOptions.addresses = true;
+          break;
+        }
+        case ('f'): {
+          options.addr2lineOptions.functions = true;
+          break;
+        }
+        case ('i'): {
+          options.addr2lineOptions.inlines = true;
+          break;
+        }
+        case ('C'): {
+          options.addr2lineOptions.demangle = true;
+          break;
+        }
+        case ('s'): {
+          options.addr2lineOptions.basenames = true;
+          break;
+        }
+        case ('p'): {
+          options.addr2lineOptions.pretty = true;
+          break;
+        }
+        case ('e'): {
+          // the file name is the rest of the argument or the next one
+          if ((j + 1U) < argument.size()) {
+            path = argv[i] + j + 1U;
+          } else if ((i + 1) < argc) {
+            path = argv[++i];
+          } else {
+            return false;
+          }
+          j = argument.size();
+          break;
+        }
+        default: {
+          return false;
+        }
+        }
+      }
+    } else {
+      options.addresses.push_back(Addr2Line::parseAddress(argument));
+    }
+  }
+  return true;
+}
 
 // Template function declarations for ELF32/64 handling
 template <typename EhdrType, typename ShdrType>
-int processElfFile(const std::vector<uint8_t> &fileBytes);
+int processElfFile(char const *const path, MappedFile const &file, Options const &options);
+
+void printUsage() {
+  printf("usage: ELFLearn <elf file> [--lookup <name>] [--debug-dir <dir>]\n");
+  printf("       ELFLearn <elf file> --search <text> [--prefix] [--cache <file>]\n");
+  printf("       ELFLearn <elf file> --find-functions <text>\n");
+  printf("       ELFLearn <elf file> [--layout] [--layout-json <file>] [--cache <file>]\n");
+  printf("       ELFLearn <elf file> --dedup-types\n");
+  printf("       ELFLearn <elf file> --stats [--memory-budget <MiB>]\n");
+  printf("           --memory-budget bounds the units read at once, a unit larger than it is read alone. The pages of\n");
+  printf("           .debug_str and the other sections a batch reads are released after it but come on top, as do the\n");
+  printf("           program itself, the abbreviation tables and the unit headers\n");
+  printf("       ELFLearn <elf file> [--write-index <output elf>] [--write-sections <prefix>] [--gdb-index]\n");
+  printf("       ELFLearn <elf file> --address <hex address> [--address <hex address> ...]\n");
+  printf("       ELFLearn --addr2line [-e <elf file>] [-afiCsp] [--debug-dir=<dir>] [hex address ...]\n");
+}
 
 int main(int argc, char *argv[]) {
 
   if (argc < 2) {
+    printUsage();
     return 1;
   }
 
-  std::vector<uint8_t> const fileBytes = readFile(argv[1]);
+  if (strcmp(argv[1], "--help") == 0) {
+    printUsage();
+    return 0;
+  }
+
+  Options options;
+  char const *path = argv[1];
+  if (strcmp(argv[1], "--addr2line") == 0) {
+    options.addr2line = true;
+    path = "a.out";
+    if (!parseAddr2LineOptions(argc, argv, path, options)) {
+      printUsage();
+      return 1;
+    }
+  }
+  for (int i = 2; (i < argc) && !options.addr2line; i++) {
+    if ((strcmp(argv[i], "--lookup") == 0) && (i + 1 < argc)) {
+      options.lookupName = argv[++i];
+    } else if ((strcmp(argv[i], "--search") == 0) && (i + 1 < argc)) {
+      options.searchText = argv[++i];
+    } else if ((strcmp(argv[i], "--find-functions") == 0) && (i + 1 < argc)) {
+      options.functionText = argv[++i];
+    } else if (strcmp(argv[i], "--layout") == 0) {
+      options.layout = true;
+    } else if ((strcmp(argv[i], "--layout-json") == 0) && (i + 1 < argc)) {
+      options.layoutJsonPath = argv[++i];
+    } else if ((strcmp(argv[i], "--cache") == 0) && (i + 1 < argc)) {
+      options.cachePath = argv[++i];
+    } else if (strcmp(argv[i], "--dedup-types") == 0) {
+      options.dedupTypes = true;
+    } else if (strcmp(argv[i], "--stats") == 0) {
+      options.stats = true;
+    } else if ((strcmp(argv[i], "--memory-budget") == 0) && (i + 1 < argc)) {
+      options.memoryBudget = static_cast<size_t>(strtoull(argv[++i], nullptr, 10)) << 20U;
+    } else if (strcmp(argv[i], "--prefix") == 0) {
+      options.searchPrefix = true;
+    } else if ((strcmp(argv[i], "--write-index") == 0) && (i + 1 < argc)) {
+      options.writeIndexPath = argv[++i];
+    } else if ((strcmp(argv[i], "--write-sections") == 0) && (i + 1 < argc)) {
+      options.writeSectionsPrefix = argv[++i];
+    } else if (strcmp(argv[i], "--gdb-index") == 0) {
+      options.gdbIndex = true;
+    } else if ((strcmp(argv[i], "--address") == 0) && (i + 1 < argc)) {
+      options.addresses.push_back(strtoull(argv[++i], nullptr, 16));
+    } else if ((strcmp(argv[i], "--debug-dir") == 0) && (i + 1 < argc)) {
+      options.debugDirectory = argv[++i];
+    } else {
+      printUsage();
+      return 1;
+    }
+  }
+
+  // mapped rather than read, only the sections which are decoded are ever loaded
+  MappedFile const file = MappedFile::open(path);
+  std::span<uint8_t const> const fileBytes = file.bytes();
 
   // Check basic ELF magic
   if (fileBytes.size() < EI_NIDENT || fileBytes[EI_MAG0] != ELFMAG0 || fileBytes[EI_MAG1] != ELFMAG1 || fileBytes[EI_MAG2] != ELFMAG2 || fileBytes[EI_MAG3] != ELFMAG3) {
@@ -74,11 +259,15 @@ int main(int argc, char *argv[]) {
   unsigned char elfClass = fileBytes[EI_CLASS];
 
   if (elfClass == ELFCLASS32) {
-    printf("Processing ELF32 file\n");
-    return processElfFile<Elf32_Ehdr, Elf32_Shdr>(fileBytes);
+    if (!options.addr2line) {
+      printf("Processing ELF32 file\n");
+    }
+    return processElfFile<Elf32_Ehdr, Elf32_Shdr>(path, file, options);
   } else if (elfClass == ELFCLASS64) {
-    printf("Processing ELF64 file\n");
-    return processElfFile<Elf64_Ehdr, Elf64_Shdr>(fileBytes);
+    if (!options.addr2line) {
+      printf("Processing ELF64 file\n");
+    }
+    return processElfFile<Elf64_Ehdr, Elf64_Shdr>(path, file, options);
   } else {
     printf("Unsupported ELF class: %d\n", elfClass);
     exit(1);
@@ -86,7 +275,8 @@ int main(int argc, char *argv[]) {
 }
 
 template <typename EhdrType, typename ShdrType>
-int processElfFile(const std::vector<uint8_t> &fileBytes) {
+int processElfFile(char const *const path, MappedFile const &file, Options const &options) {
+  std::span<uint8_t const> const fileBytes = file.bytes();
   const EhdrType *const elfHeader = reinterpret_cast<const EhdrType *>(fileBytes.data());
 
   const auto sectionHeaderOffset = elfHeader->e_shoff;
@@ -155,6 +345,21 @@ int processElfFile(const std::vector<uint8_t> &fileBytes) {
   const ShdrType *debugAbbrevSection = nullptr;
   const ShdrType *debugLocSection = nullptr;
   const char *debugStrSection = nullptr;
+  const ShdrType *debugStrHeader = nullptr;
+  const ShdrType *debugNamesSection = nullptr;
+  const ShdrType *gdbIndexSection = nullptr;
+  const ShdrType *debugPubnamesSection = nullptr;
+  const ShdrType *debugPubtypesSection = nullptr;
+  const ShdrType *debugArangesSection = nullptr;
+  const ShdrType *debugRangesSection = nullptr;
+  const ShdrType *debugLineStrSection = nullptr;
+  const ShdrType *debugStrOffsetsSection = nullptr;
+  const ShdrType *debugAddrSection = nullptr;
+  const ShdrType *debugRnglistsSection = nullptr;
+  const ShdrType *debugLoclistsSection = nullptr;
+  const ShdrType *debugTypesSection = nullptr;
+  const ShdrType *gnuDebugAltLinkSection = nullptr;
+  const ShdrType *debugSupSection = nullptr;
 
   for (uint32_t i = 0; i < numberOfSectionHeaders; i++) {
     const ShdrType *const currentHeader = sectionHeaderStart + i;
@@ -168,23 +373,326 @@ int processElfFile(const std::vector<uint8_t> &fileBytes) {
       debugAbbrevSection = currentHeader;
     } else if (strncmp(sectionName, debugStrName.data(), debugStrName.size()) == 0) {
       debugStrSection = reinterpret_cast<const char *>(fileBytes.data() + currentHeader->sh_offset);
+      debugStrHeader = currentHeader;
     } else if (strncmp(sectionName, debugLocName.data(), debugLocName.size()) == 0) {
       debugLocSection = currentHeader;
+    } else if (strncmp(sectionName, debugNamesName.data(), debugNamesName.size()) == 0) {
+      debugNamesSection = currentHeader;
+    } else if (strncmp(sectionName, gdbIndexName.data(), gdbIndexName.size()) == 0) {
+      gdbIndexSection = currentHeader;
+    } else if (strncmp(sectionName, debugPubnamesName.data(), debugPubnamesName.size()) == 0) {
+      debugPubnamesSection = currentHeader;
+    } else if (strncmp(sectionName, debugPubtypesName.data(), debugPubtypesName.size()) == 0) {
+      debugPubtypesSection = currentHeader;
+    } else if (strncmp(sectionName, debugArangesName.data(), debugArangesName.size()) == 0) {
+      debugArangesSection = currentHeader;
+    } else if (strncmp(sectionName, debugRangesName.data(), debugRangesName.size()) == 0) {
+      debugRangesSection = currentHeader;
+    } else if (strncmp(sectionName, debugLineStrName.data(), debugLineStrName.size()) == 0) {
+      debugLineStrSection = currentHeader;
+    } else if (strncmp(sectionName, debugStrOffsetsName.data(), debugStrOffsetsName.size()) == 0) {
+      debugStrOffsetsSection = currentHeader;
+    } else if (strncmp(sectionName, debugAddrName.data(), debugAddrName.size()) == 0) {
+      debugAddrSection = currentHeader;
+    } else if (strncmp(sectionName, debugRnglistsName.data(), debugRnglistsName.size()) == 0) {
+      debugRnglistsSection = currentHeader;
+    } else if (strncmp(sectionName, debugLoclistsName.data(), debugLoclistsName.size()) == 0) {
+      debugLoclistsSection = currentHeader;
+    } else if (strncmp(sectionName, debugTypesName.data(), debugTypesName.size()) == 0) {
+      debugTypesSection = currentHeader;
+    } else if (strncmp(sectionName, gnuDebugAltLinkName.data(), gnuDebugAltLinkName.size()) == 0) {
+      gnuDebugAltLinkSection = currentHeader;
+    } else if (strncmp(sectionName, debugSupName.data(), debugSupName.size()) == 0) {
+      debugSupSection = currentHeader;
+    }
+  }
+
+  auto const sectionSpan = [&fileBytes](const ShdrType *const section) {
+    return (section == nullptr) ? std::span<uint8_t const>() : std::span<uint8_t const>(fileBytes.data() + section->sh_offset, static_cast<size_t>(section->sh_size));
+  };
+  DwarfSections dwarfSections;
+  dwarfSections.debugInfo = sectionSpan(debugInfoSection);
+  dwarfSections.debugTypes = sectionSpan(debugTypesSection);
+  dwarfSections.debugStr = debugStrSection;
+  dwarfSections.debugLineStr = (debugLineStrSection == nullptr) ? nullptr : reinterpret_cast<const char *>(fileBytes.data() + debugLineStrSection->sh_offset);
+  dwarfSections.debugStrOffsets = sectionSpan(debugStrOffsetsSection);
+  dwarfSections.debugAddr = sectionSpan(debugAddrSection);
+  dwarfSections.debugLine = sectionSpan(debugLines.empty() ? nullptr : &debugLines.begin()->second);
+  dwarfSections.debugRanges = sectionSpan(debugRangesSection);
+  dwarfSections.debugRnglists = sectionSpan(debugRnglistsSection);
+  dwarfSections.debugLoc = sectionSpan(debugLocSection);
+  dwarfSections.debugLoclists = sectionSpan(debugLoclistsSection);
+  dwarfSections.debugAranges = sectionSpan(debugArangesSection);
+
+  // dwz output refers to a supplementary file, which stays mapped until the end
+  std::optional<SupplementaryFile> supplementary;
+  std::optional<SupplementaryFile::Link> const altLink = SupplementaryFile::link(sectionSpan(gnuDebugAltLinkSection), sectionSpan(debugSupSection));
+  if (altLink.has_value()) {
+    supplementary = SupplementaryFile::open(*altLink, path, options.debugDirectory);
+    if (supplementary.has_value()) {
+      supplementary->addSections(dwarfSections, sectionSpan(debugAbbrevSection).size());
+    } else if (!options.addr2line) {
+      std::cout << "supplementary file " << altLink->name << " not found\n";
+    }
+  }
+  // the abbreviation tables of the binary and behind them those of the supplementary file
+  auto const parseAbbreviations = [&fileBytes, &debugAbbrevSection, &supplementary, &dwarfSections]() {
+    std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> debugAbbrev = DebugAbbrev::parseDebugAbbrev<ShdrType>(fileBytes, debugAbbrevSection);
+    if (supplementary.has_value()) {
+      supplementary->addAbbreviations(dwarfSections, debugAbbrev);
+    }
+    return debugAbbrev;
+  };
+
+  AcceleratorTables accelerators;
+  accelerators.setDebugNames(sectionSpan(debugNamesSection), debugStrSection);
+  accelerators.setGdbIndex(sectionSpan(gdbIndexSection));
+  accelerators.setPubnames(sectionSpan(debugPubnamesSection));
+  accelerators.setPubtypes(sectionSpan(debugPubtypesSection));
+
+  if ((options.writeIndexPath != nullptr) || (options.writeSectionsPrefix != nullptr)) {
+    if ((debugInfoSection == nullptr) || (debugAbbrevSection == nullptr) || (debugStrSection == nullptr)) {
+      printf("no debug info\n");
+      return 1;
+    }
+    std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const debugAbbrev = parseAbbreviations();
+    DIEIndex const dieIndex = DebugInfo::buildDIEIndex(dwarfSections, debugAbbrev);
+    IndexWriter::Sections const indexSections = IndexWriter::write(dieIndex, sectionSpan(debugStrHeader), options.gdbIndex);
+
+    std::vector<ElfWriter::Section> sections;
+    sections.push_back(ElfWriter::Section{".debug_names", indexSections.debugNames});
+    if (options.gdbIndex) {
+      sections.push_back(ElfWriter::Section{".gdb_index", indexSections.gdbIndex});
+    }
+    if (!indexSections.debugStr.empty()) {
+      // names only stored inline had to be added to .debug_str
+      sections.push_back(ElfWriter::Section{".debug_str", indexSections.debugStr});
+    }
+    for (ElfWriter::Section const &section : sections) {
+      std::cout << section.name << ": " << section.data.size() << " bytes\n";
+      if (options.writeSectionsPrefix != nullptr) {
+        writeFile(options.writeSectionsPrefix + section.name, section.data);
+      }
+    }
+    if (options.writeIndexPath != nullptr) {
+      writeFile(options.writeIndexPath, ElfWriter::withSections<EhdrType, ShdrType>(fileBytes, sections));
     }
+    return 0;
+  }
+
+  if (!options.addresses.empty() || options.addr2line) {
+    if ((debugInfoSection == nullptr) || (debugAbbrevSection == nullptr)) {
+      printf("no debug info\n");
+      return 1;
+    }
+    Symbolizer symbolizer(dwarfSections, parseAbbreviations(), path);
+    if (options.addr2line) {
+      BufferedWriter out(STDOUT_FILENO);
+      SymbolTable const symbols = (sizeof(EhdrType) == sizeof(Elf64_Ehdr)) ? SymbolTable::build<EhdrType, ShdrType, Elf64_Sym>(fileBytes)
+                                                                          : SymbolTable::build<EhdrType, ShdrType, Elf32_Sym>(fileBytes);
+      Addr2Line addr2line(symbolizer, symbols, options.addr2lineOptions, (sizeof(EhdrType) == sizeof(Elf64_Ehdr)) ? 16U : 8U, out);
+      if (options.addresses.empty()) {
+        addr2line.run(STDIN_FILENO);
+      } else {
+        addr2line.resolve(options.addresses);
+      }
+      return 0;
+    }
+    Symbolizer::Batch batch;
+    symbolizer.symbolize(options.addresses, batch);
+    for (size_t i = 0U; i < options.addresses.size(); i++) {
+      Symbolizer::Location const &location = batch.location(i);
+      std::cout << DebugInfo::numToHexString(options.addresses[i]) << ": ";
+      if (location.unitOffset == UnitRanges::noUnit) {
+        std::cout << "??\n";
+        continue;
+      }
+      std::cout << (location.function.empty() ? std::string_view("??") : location.function) << " at " << (location.file.empty() ? std::string_view("??") : location.file) << ":"
+                << location.line << " in unit " << DebugInfo::numToHexString(location.unitOffset)
+                << " (" << location.unitName << ")\n";
+      std::span<Symbolizer::Frame const> const frames = batch.framesOf(i);
+      for (size_t j = 1U; j < frames.size(); j++) {
+        std::cout << "  inlined by " << frames[j].function << " at " << (frames[j].file.empty() ? std::string_view("??") : frames[j].file) << ":" << frames[j].line << "\n";
+      }
+    }
+    return 0;
+  }
+
+  if (options.lookupName != nullptr) {
+    if ((debugInfoSection == nullptr) || (debugAbbrevSection == nullptr) || (debugStrSection == nullptr)) {
+      printf("no debug info\n");
+      return 1;
+    }
+    std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const debugAbbrev = parseAbbreviations();
+    auto const printDefinition = [](DIEIndex const &dieIndex, uint32_t const index) {
+      DIEIndex::DIEInfo const &die = dieIndex.at(index);
+      std::cout << DebugAbbrev::tagToString(die.tag) << " " << dieIndex.qualifiedName(index) << " at DIE " << DebugInfo::numToHexString(die.offset) << " in unit "
+                << DebugInfo::numToHexString(dieIndex.units()[die.unit].offset) << "\n";
+    };
+
+    if (!accelerators.empty()) {
+      // only the units the table points at are parsed
+      std::cout << "using " << accelerators.source() << "\n";
+      std::vector<AcceleratorTables::Match> const matches = accelerators.lookup(options.lookupName);
+      std::vector<uint32_t> unitOffsets;
+      for (AcceleratorTables::Match const &match : matches) {
+        unitOffsets.push_back(match.unitOffset);
+      }
+      DIEIndex const dieIndex = DebugInfo::buildDIEIndex(dwarfSections, debugAbbrev, std::move(unitOffsets));
+      for (uint32_t const index : AcceleratorTables::definitions(dieIndex, matches, options.lookupName)) {
+        printDefinition(dieIndex, index);
+      }
+      return 0;
+    }
+
+    DIEIndex const dieIndex = DebugInfo::buildDIEIndex(dwarfSections, debugAbbrev);
+    NameIndex const nameIndex = NameIndex::build(dieIndex);
+    for (NameIndex::Entry const &entry : nameIndex.lookup(options.lookupName)) {
+      printDefinition(dieIndex, dieIndex.findIndex(entry.dieOffset));
+    }
+    return 0;
+  }
+
+  if (options.searchText != nullptr) {
+    if ((debugInfoSection == nullptr) || (debugAbbrevSection == nullptr)) {
+      printf("no debug info\n");
+      return 1;
+    }
+    std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const debugAbbrev = parseAbbreviations();
+    SubstringIndex::Match const match = options.searchPrefix ? SubstringIndex::Match::prefix : SubstringIndex::Match::substring;
+    if (options.cachePath != nullptr) {
+      // the trigram tables of the unchanged units are read from the cache, no index of all units is built
+      UnitCache cache = UnitCache::load(options.cachePath);
+      SubstringIndex::Search const search = SubstringIndex::search(dwarfSections, debugAbbrev, cache, options.searchText, match);
+      cache.save(options.cachePath);
+      for (SubstringIndex::Found const &found : search.found) {
+        std::cout << DebugAbbrev::tagToString(found.tag) << " " << found.qualifiedName << " at DIE " << DebugInfo::numToHexString(found.dieOffset) << " in unit "
+                  << DebugInfo::numToHexString(found.unitOffset) << "\n";
+      }
+      std::cout << search.found.size() << " DIEs, trigram tables of " << search.reusedUnits << " of " << search.unitCount << " units reused from " << options.cachePath
+                << "\n";
+      return 0;
+    }
+    DIEIndex const dieIndex = DebugInfo::buildDIEIndex(dwarfSections, debugAbbrev);
+    SubstringIndex const substringIndex = SubstringIndex::build(dieIndex);
+    std::vector<uint32_t> const found = substringIndex.find(options.searchText, match);
+    for (uint32_t const index : found) {
+      DIEIndex::DIEInfo const &die = dieIndex.at(index);
+      std::cout << DebugAbbrev::tagToString(die.tag) << " " << dieIndex.qualifiedName(index) << " at DIE " << DebugInfo::numToHexString(die.offset) << " in unit "
+                << DebugInfo::numToHexString(dieIndex.units()[die.unit].offset) << "\n";
+    }
+    std::cout << found.size() << " DIEs, " << substringIndex.stringCount() << " distinct names\n";
+    return 0;
+  }
+
+  if (options.functionText != nullptr) {
+    if ((debugInfoSection == nullptr) || (debugAbbrevSection == nullptr)) {
+      printf("no debug info\n");
+      return 1;
+    }
+    std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const debugAbbrev = parseAbbreviations();
+    // functions are found at namespace and class scope, function bodies and everything else are jumped over
+    DIEFilter filter;
+    filter.tags = {DebugAbbrev::Tag::DW_TAG_subprogram};
+    filter.scopes = {DebugAbbrev::Tag::DW_TAG_namespace, DebugAbbrev::Tag::DW_TAG_class_type, DebugAbbrev::Tag::DW_TAG_structure_type, DebugAbbrev::Tag::DW_TAG_union_type};
+    std::string_view const text = options.functionText;
+    filter.name = [text](std::string_view const name) {
+      return name.find(text) != std::string_view::npos;
+    };
+    std::vector<DIEFilter::Match> const matches = filter.apply(dwarfSections, debugAbbrev, DebugInfo::readUnitHeaders(dwarfSections, debugAbbrev));
+    for (DIEFilter::Match const &match : matches) {
+      std::cout << DebugAbbrev::tagToString(match.tag) << " " << match.name << " at DIE " << DebugInfo::numToHexString(match.offset) << " in unit "
+                << DebugInfo::numToHexString(match.unitOffset) << "\n";
+    }
+    std::cout << matches.size() << " DIEs\n";
+    return 0;
+  }
+
+  if (options.stats) {
+    if ((debugInfoSection == nullptr) || (debugAbbrevSection == nullptr)) {
+      printf("no debug info\n");
+      return 1;
+    }
+    std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const debugAbbrev = parseAbbreviations();
+    // one pass over the events of the decoder, no DIE is kept; the budget bounds the pages of the mapping
+    UnitStream stream(dwarfSections, debugAbbrev, options.memoryBudget, &file, {sectionSpan(debugStrHeader), sectionSpan(debugLineStrSection), sectionSpan(debugAbbrevSection)});
+    DIEStatistics statistics(dwarfSections);
+    stream.walk(statistics);
+    statistics.print(std::cout, 20U);
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::cout << stream.batches() << " batches, peak resident set " << usage.ru_maxrss << " KiB\n";
+    return 0;
+  }
+
+  if (options.dedupTypes) {
+    if ((debugInfoSection == nullptr) || (debugAbbrevSection == nullptr)) {
+      printf("no debug info\n");
+      return 1;
+    }
+    std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const debugAbbrev = parseAbbreviations();
+    DIEIndex const dieIndex = DebugInfo::buildDIEIndex(dwarfSections, debugAbbrev);
+    TypeDedup const typeDedup = TypeDedup::build(dieIndex);
+    std::unordered_map<uint32_t, uint32_t> copies; // canonical DIE offset to the number of type DIEs equal to it
+    for (TypeDedup::Remap const &remap : typeDedup.remap()) {
+      copies[remap.canonical]++;
+    }
+    std::vector<std::pair<uint32_t, uint32_t>> mostCopied(copies.begin(), copies.end());
+    size_t const shown = std::min<size_t>(mostCopied.size(), 20U);
+    std::partial_sort(mostCopied.begin(), mostCopied.begin() + static_cast<ptrdiff_t>(shown), mostCopied.end(), [](auto const &lhs, auto const &rhs) {
+      return (lhs.second != rhs.second) ? (lhs.second > rhs.second) : (lhs.first < rhs.first);
+    });
+    std::cout << typeDedup.remap().size() << " type DIEs, " << typeDedup.canonicalCount() << " distinct types after " << typeDedup.rounds() << " rounds\n";
+    for (size_t i = 0U; i < shown; i++) {
+      DIEIndex::DIEInfo const *const die = dieIndex.find(mostCopied[i].first);
+      std::cout << std::setw(8) << mostCopied[i].second << " " << DebugAbbrev::tagToString(die->tag) << " " << dieIndex.typeName(mostCopied[i].first) << " at DIE "
+                << DebugInfo::numToHexString(mostCopied[i].first) << "\n";
+    }
+    return 0;
+  }
+
+  if (options.layout || (options.layoutJsonPath != nullptr)) {
+    if ((debugInfoSection == nullptr) || (debugAbbrevSection == nullptr)) {
+      printf("no debug info\n");
+      return 1;
+    }
+    std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const debugAbbrev = parseAbbreviations();
+    std::optional<DIEIndex> dieIndex; // type names of the layouts view into it
+    std::optional<StructLayout> analyzed;
+    if (options.cachePath != nullptr) {
+      UnitCache cache = UnitCache::load(options.cachePath);
+      analyzed.emplace(StructLayout::analyze(dwarfSections, debugAbbrev, cache));
+      cache.save(options.cachePath);
+    } else {
+      dieIndex.emplace(DebugInfo::buildDIEIndex(dwarfSections, debugAbbrev));
+      analyzed.emplace(StructLayout::analyze(*dieIndex, TypeDedup::build(*dieIndex)));
+    }
+    StructLayout const &layouts = *analyzed;
+    if (options.layout) {
+      layouts.print(std::cout);
+    }
+    if (options.layoutJsonPath != nullptr) {
+      std::ofstream json(options.layoutJsonPath);
+      layouts.writeJson(json);
+      if (!json) {
+        throw std::runtime_error(std::string("can not write ") + options.layoutJsonPath);
+      }
+    }
+    if (options.cachePath != nullptr) {
+      std::cout << "layouts of " << layouts.reusedUnits() << " of " << layouts.unitCount() << " units reused from " << options.cachePath << "\n";
+    }
+    return 0;
   }
 
   // Use the template function directly with the native types
-  DebugLine::parseDebugLine<ShdrType>(fileBytes, debugLines);
+  DebugLine::parseDebugLine<ShdrType>(fileBytes, debugLines, dwarfSections);
   if (debugAbbrevSection != nullptr) {
-    std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const debugAbbrev = DebugAbbrev::parseDebugAbbrev<ShdrType>(fileBytes, debugAbbrevSection);
-    DebugLoc debugLoc;
-    if (debugLocSection) {
-      debugLoc = DebugLoc(fileBytes, debugLocSection);
-    }
+    std::unordered_map<ptrdiff_t, DebugAbbrev::AbbrevTable> const debugAbbrev = parseAbbreviations();
+    DebugLoc const debugLoc(dwarfSections);
 
     // Now DebugInfo also supports templates for both ELF32 and ELF64
     if (debugInfoSection && debugAbbrevSection && debugStrSection) {
-      DebugInfo::parseDebugInfo<ShdrType>(fileBytes, debugInfoSection, debugAbbrev, debugStrSection, debugLoc);
+      DebugInfo::parseDebugInfo(dwarfSections, debugAbbrev, debugLoc);
     }
   }
 